@@ -0,0 +1,55 @@
+// Generador de programas sintéticos para medir el compilador.
+// Escribe en la salida estándar un programa con muchas funciones
+// independientes entre sí salvo por llamadas a funciones anteriores: cada
+// una tiene parámetros, locales, un lazo con aritmética y condiciones, y
+// llama a dos funciones previas elegidas de forma determinista, así que el
+// grafo de llamadas tiene profundidad logarítmica y mucho trabajo paralelo.
+//
+// Uso: gen_program [num_funciones] > programa.src
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void write_function(int i) {
+    printf("func f%d(int a, int b) -> int {\n", i);
+    printf("    int i;\n");
+    printf("    int s;\n");
+    printf("    int t;\n");
+    printf("    s = a * %d + b;\n", i % 13 + 1);
+    printf("    t = 0;\n");
+    printf("    for (i = 0; i < b; i = i + 1) {\n");
+    printf("        t = t + i * %d + a / %d;\n", i % 7 + 2, i % 5 + 1);
+    printf("        if (t > %d) {\n", 1000 + i % 100);
+    printf("            t = t - s %% %d;\n", i % 11 + 3);
+    printf("        }\n");
+    printf("    }\n");
+    if (i > 0) {
+        // Una llamada a la mitad del índice y otra pseudoaleatoria anterior
+        int half = i / 2;
+        int other = (int)(((long long)i * 7919) % i);
+        printf("    s = s + f%d(t, %d);\n", half, i % 4);
+        printf("    if (s > t) {\n");
+        printf("        s = s - f%d(s, %d);\n", other, i % 3);
+        printf("    }\n");
+    }
+    printf("    return s + t;\n");
+    printf("}\n");
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 50000;
+    if (count < 1) {
+        fprintf(stderr, "Uso: %s [num_funciones]\n", argv[0]);
+        return 1;
+    }
+
+    printf("int g;\n");
+    for (int i = 0; i < count; i++) write_function(i);
+
+    printf("func main() -> int {\n");
+    printf("    g = f%d(3, 4);\n", count - 1);
+    printf("    print(g);\n");
+    printf("    return 0;\n");
+    printf("}\n");
+    return 0;
+}
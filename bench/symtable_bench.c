@@ -0,0 +1,216 @@
+// Microbenchmark de la tabla de símbolos.
+// Compara la tabla plana con marcas de ámbito (src/symtable.c) con la tabla
+// anterior de 1000 cubetas por ámbito, sobre un programa sintético con
+// muchos globales y funciones: declarar globales, analizar cada función
+// (entrar al ámbito, parámetros, locales, búsquedas, salir) y recorrer los
+// globales como lo hace generate_code.
+//
+// Uso: symtable_bench [num_funciones] [num_globales]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "intern.h"
+#include "symtable.h"
+
+#define PARAMS_PER_FUNC 3
+#define LOCALS_PER_FUNC 5
+#define LOOKUPS_PER_FUNC 32
+
+// --- Tabla anterior: un arreglo fijo de cubetas por ámbito ---
+
+#define LEGACY_BUCKETS 1000
+
+typedef struct LegacySymbol {
+    char *name;
+    DataType type;
+    struct LegacySymbol *next;
+} LegacySymbol;
+
+typedef struct LegacyTable {
+    LegacySymbol *symbols[LEGACY_BUCKETS];
+    struct LegacyTable *parent;
+} LegacyTable;
+
+static unsigned int legacy_hash(const char *str) {
+    unsigned int hash = 5381;
+    int c;
+    while ((c = *str++))
+        hash = ((hash << 5) + hash) + c;
+    return hash % LEGACY_BUCKETS;
+}
+
+static LegacyTable* legacy_create(LegacyTable *parent) {
+    LegacyTable *table = (LegacyTable*)malloc(sizeof(LegacyTable));
+    for (int i = 0; i < LEGACY_BUCKETS; i++) {
+        table->symbols[i] = NULL;
+    }
+    table->parent = parent;
+    return table;
+}
+
+static LegacySymbol* legacy_lookup_current(LegacyTable *table, const char *name) {
+    LegacySymbol *symbol = table->symbols[legacy_hash(name)];
+    while (symbol) {
+        if (strcmp(symbol->name, name) == 0) return symbol;
+        symbol = symbol->next;
+    }
+    return NULL;
+}
+
+static LegacySymbol* legacy_lookup(LegacyTable *table, const char *name) {
+    for (; table; table = table->parent) {
+        LegacySymbol *symbol = legacy_lookup_current(table, name);
+        if (symbol) return symbol;
+    }
+    return NULL;
+}
+
+static void legacy_add(LegacyTable *table, const char *name, DataType type) {
+    if (legacy_lookup_current(table, name)) {
+        fprintf(stderr, "símbolo duplicado %s\n", name);
+        exit(1);
+    }
+    unsigned int index = legacy_hash(name);
+    LegacySymbol *symbol = (LegacySymbol*)malloc(sizeof(LegacySymbol));
+    symbol->name = strdup(name);
+    symbol->type = type;
+    symbol->next = table->symbols[index];
+    table->symbols[index] = symbol;
+}
+
+static void legacy_free(LegacyTable *table) {
+    for (int i = 0; i < LEGACY_BUCKETS; i++) {
+        LegacySymbol *symbol = table->symbols[i];
+        while (symbol) {
+            LegacySymbol *next = symbol->next;
+            free(symbol->name);
+            free(symbol);
+            symbol = next;
+        }
+    }
+    free(table);
+}
+
+// --- Programa sintético ---
+
+typedef struct Workload {
+    int num_funcs;
+    int num_globals;
+    const char **globals;
+    const char **funcs;
+    const char *locals[PARAMS_PER_FUNC + LOCALS_PER_FUNC];
+} Workload;
+
+static const char* make_name(const char *prefix, int n) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s%d", prefix, n);
+    return intern(buffer);
+}
+
+static void build_workload(Workload *w, int num_funcs, int num_globals) {
+    w->num_funcs = num_funcs;
+    w->num_globals = num_globals;
+    w->globals = (const char**)malloc(sizeof(char*) * num_globals);
+    w->funcs = (const char**)malloc(sizeof(char*) * num_funcs);
+    for (int i = 0; i < num_globals; i++) w->globals[i] = make_name("g", i);
+    for (int i = 0; i < num_funcs; i++) w->funcs[i] = make_name("f", i);
+    for (int i = 0; i < PARAMS_PER_FUNC + LOCALS_PER_FUNC; i++) w->locals[i] = make_name("v", i);
+}
+
+// Nombre buscado en la j-ésima referencia de la función f: mezcla de locales y globales
+static const char* reference(Workload *w, int f, int j) {
+    if (j % 2 == 0) return w->locals[j % (PARAMS_PER_FUNC + LOCALS_PER_FUNC)];
+    return w->globals[(unsigned)(f * 7919 + j * 104729) % (unsigned)w->num_globals];
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double run_legacy(Workload *w, long *checksum) {
+    double start = now();
+    LegacyTable *global = legacy_create(NULL);
+
+    for (int i = 0; i < w->num_globals; i++) legacy_add(global, w->globals[i], TYPE_INT);
+    for (int f = 0; f < w->num_funcs; f++) {
+        legacy_add(global, w->funcs[f], TYPE_INT);
+        LegacyTable *scope = legacy_create(global);
+        for (int i = 0; i < PARAMS_PER_FUNC + LOCALS_PER_FUNC; i++) {
+            legacy_add(scope, w->locals[i], TYPE_INT);
+        }
+        for (int j = 0; j < LOOKUPS_PER_FUNC; j++) {
+            *checksum += legacy_lookup(scope, reference(w, f, j)) != NULL;
+        }
+        // La tabla anterior mantenía los ámbitos vivos hasta el final; aquí se liberan
+        legacy_free(scope);
+    }
+    for (int i = 0; i < LEGACY_BUCKETS; i++) {
+        for (LegacySymbol *symbol = global->symbols[i]; symbol; symbol = symbol->next) {
+            *checksum += symbol->type;
+        }
+    }
+
+    legacy_free(global);
+    return now() - start;
+}
+
+static double run_flat(Workload *w, long *checksum) {
+    double start = now();
+    SymbolTable *table = create_symbol_table();
+
+    for (int i = 0; i < w->num_globals; i++) add_symbol(table, w->globals[i], TYPE_INT);
+    for (int f = 0; f < w->num_funcs; f++) {
+        add_function_symbol(table, w->funcs[f], TYPE_INT);
+        enter_scope(table);
+        for (int i = 0; i < PARAMS_PER_FUNC + LOCALS_PER_FUNC; i++) {
+            add_symbol(table, w->locals[i], TYPE_INT);
+        }
+        for (int j = 0; j < LOOKUPS_PER_FUNC; j++) {
+            *checksum += lookup_symbol(table, reference(w, f, j)) != NULL;
+        }
+        exit_scope(table);
+    }
+    for (size_t i = 0; i < table->entry_count; i++) {
+        *checksum += table->entries[i]->type;
+    }
+
+    free_symbol_table(table);
+    return now() - start;
+}
+
+int main(int argc, char **argv) {
+    int num_funcs = argc > 1 ? atoi(argv[1]) : 10000;
+    int num_globals = argc > 2 ? atoi(argv[2]) : 100000;
+    if (num_funcs < 1 || num_globals < 1) {
+        fprintf(stderr, "Uso: %s [num_funciones] [num_globales]\n", argv[0]);
+        return 1;
+    }
+
+    Workload w;
+    build_workload(&w, num_funcs, num_globals);
+
+    long legacy_sum = 0;
+    long flat_sum = 0;
+    double legacy_time = run_legacy(&w, &legacy_sum);
+    double flat_time = run_flat(&w, &flat_sum);
+
+    if (legacy_sum != flat_sum) {
+        fprintf(stderr, "Error: las tablas no coinciden (%ld vs %ld)\n", legacy_sum, flat_sum);
+        return 1;
+    }
+
+    printf("Tabla de símbolos: %d funciones, %d globales, %d búsquedas por función\n",
+           num_funcs, num_globals, LOOKUPS_PER_FUNC);
+    printf("  cubetas fijas por ámbito: %8.2f ms\n", legacy_time * 1e3);
+    printf("  tabla plana con ámbitos:  %8.2f ms\n", flat_time * 1e3);
+    printf("  aceleración:              %8.2fx\n", legacy_time / flat_time);
+
+    free(w.globals);
+    free(w.funcs);
+    intern_release();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN sizeof(void*)
+
+void arena_init(Arena *arena) {
+    arena->head = NULL;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+}
+
+static ArenaBlock* arena_new_block(Arena *arena, size_t min_size) {
+    size_t size = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    ArenaBlock *block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+    if (!block) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el arena\n");
+        exit(1);
+    }
+    block->size = size;
+    block->used = 0;
+
+    // Los bloques grandes se enlazan detrás del actual para no desperdiciar su espacio libre
+    if (min_size > ARENA_BLOCK_SIZE && arena->head) {
+        block->next = arena->head->next;
+        arena->head->next = block;
+    } else {
+        block->next = arena->head;
+        arena->head = block;
+    }
+    arena->bytes_reserved += sizeof(ArenaBlock) + size;
+    return block;
+}
+
+void* arena_alloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    ArenaBlock *block = arena->head;
+    if (!block || block->size - block->used < size) {
+        block = arena_new_block(arena, size);
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->bytes_used += size;
+    return ptr;
+}
+
+char* arena_strdup(Arena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = (char*)arena_alloc(arena, len);
+    memcpy(copy, str, len);
+    return copy;
+}
+
+void arena_release(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
@@ -0,0 +1,26 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bloque contiguo de memoria del arena
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+} ArenaBlock;
+
+// Arena de asignación lineal: se libera completa de una sola vez
+typedef struct Arena {
+    ArenaBlock *head;
+    size_t bytes_used;      // Bytes entregados a los usuarios
+    size_t bytes_reserved;  // Bytes pedidos al sistema (incluye cabeceras)
+} Arena;
+
+void arena_init(Arena *arena);
+void* arena_alloc(Arena *arena, size_t size);
+char* arena_strdup(Arena *arena, const char *str);
+void arena_release(Arena *arena);
+
+#endif
@@ -2,54 +2,64 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "arena.h"
 
-static ASTNode* create_node(NodeType type) {
-    ASTNode *node = (ASTNode*)malloc(sizeof(ASTNode));
-    if (!node) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para el nodo AST\n");
-        exit(1);
-    }
+// Tamaño de un nodo cuya carga útil es el miembro 'member' de la unión
+#define NODE_SIZE(member) (offsetof(ASTNode, data) + sizeof(((ASTNode*)0)->data.member))
+
+// Un AST por hilo: el modo por lotes compila varios programas a la vez
+static _Thread_local Arena ast_arena;
+static _Thread_local size_t node_count = 0;
+
+static ASTNode* create_node(NodeType type, size_t size) {
+    ASTNode *node = (ASTNode*)arena_alloc(&ast_arena, size);
+    memset(node, 0, size);
     node->type = type;
     node->data_type = TYPE_VOID;
+    node_count++;
     return node;
 }
 
+char* ast_strdup(const char *str) {
+    return arena_strdup(&ast_arena, str);
+}
+
 ASTNode* create_int_literal_node(int value) {
-    ASTNode *node = create_node(NODE_INT_LITERAL);
+    ASTNode *node = create_node(NODE_INT_LITERAL, NODE_SIZE(int_value));
     node->data_type = TYPE_INT;
     node->data.int_value = value;
     return node;
 }
 
 ASTNode* create_float_literal_node(float value) {
-    ASTNode *node = create_node(NODE_FLOAT_LITERAL);
+    ASTNode *node = create_node(NODE_FLOAT_LITERAL, NODE_SIZE(float_value));
     node->data_type = TYPE_FLOAT;
     node->data.float_value = value;
     return node;
 }
 
-ASTNode* create_string_literal_node(char *value) {
-    ASTNode *node = create_node(NODE_STRING_LITERAL);
+ASTNode* create_string_literal_node(const char *value) {
+    ASTNode *node = create_node(NODE_STRING_LITERAL, NODE_SIZE(string_value));
     node->data_type = TYPE_STRING;
-    node->data.string_value = strdup(value);
+    node->data.string_value = value;
     return node;
 }
 
 ASTNode* create_bool_literal_node(int value) {
-    ASTNode *node = create_node(NODE_BOOL_LITERAL);
+    ASTNode *node = create_node(NODE_BOOL_LITERAL, NODE_SIZE(bool_value));
     node->data_type = TYPE_BOOL;
     node->data.bool_value = value;
     return node;
 }
 
-ASTNode* create_identifier_node(char *name) {
-    ASTNode *node = create_node(NODE_IDENTIFIER);
-    node->data.identifier = strdup(name);
+ASTNode* create_identifier_node(const char *name) {
+    ASTNode *node = create_node(NODE_IDENTIFIER, NODE_SIZE(identifier));
+    node->data.identifier.name = name;
     return node;
 }
 
 ASTNode* create_binop_node(BinaryOperator op, ASTNode *left, ASTNode *right) {
-    ASTNode *node = create_node(NODE_BINOP);
+    ASTNode *node = create_node(NODE_BINOP, NODE_SIZE(binop));
     node->data.binop.op = op;
     node->data.binop.left = left;
     node->data.binop.right = right;
@@ -57,52 +67,52 @@ ASTNode* create_binop_node(BinaryOperator op, ASTNode *left, ASTNode *right) {
 }
 
 ASTNode* create_unop_node(UnaryOperator op, ASTNode *operand) {
-    ASTNode *node = create_node(NODE_UNOP);
+    ASTNode *node = create_node(NODE_UNOP, NODE_SIZE(unop));
     node->data.unop.op = op;
     node->data.unop.operand = operand;
     return node;
 }
 
-ASTNode* create_declaration_node(DataType type, char *name, ASTNode *init_value) {
-    ASTNode *node = create_node(NODE_DECLARATION);
+ASTNode* create_declaration_node(DataType type, const char *name, ASTNode *init_value) {
+    ASTNode *node = create_node(NODE_DECLARATION, NODE_SIZE(declaration));
     node->data.declaration.var_type = type;
-    node->data.declaration.var_name = strdup(name);
+    node->data.declaration.var_name = name;
     node->data.declaration.init_value = init_value;
     return node;
 }
 
-ASTNode* create_assignment_node(char *name, ASTNode *value) {
-    ASTNode *node = create_node(NODE_ASSIGNMENT);
-    node->data.assignment.var_name = strdup(name);
+ASTNode* create_assignment_node(const char *name, ASTNode *value) {
+    ASTNode *node = create_node(NODE_ASSIGNMENT, NODE_SIZE(assignment));
+    node->data.assignment.var_name = name;
     node->data.assignment.value = value;
     return node;
 }
 
-ASTNode* create_array_declaration_node(DataType type, char *name, ASTNode *elements) {
-    ASTNode *node = create_node(NODE_ARRAY_DECLARATION);
+ASTNode* create_array_declaration_node(DataType type, const char *name, ASTNode *elements) {
+    ASTNode *node = create_node(NODE_ARRAY_DECLARATION, NODE_SIZE(array_decl));
     node->data_type = TYPE_ARRAY;
     node->data.array_decl.element_type = type;
-    node->data.array_decl.array_name = strdup(name);
+    node->data.array_decl.array_name = name;
     node->data.array_decl.elements = elements;
     return node;
 }
 
-ASTNode* create_array_access_node(char *name, ASTNode *index) {
-    ASTNode *node = create_node(NODE_ARRAY_ACCESS);
-    node->data.array_access.array_name = strdup(name);
+ASTNode* create_array_access_node(const char *name, ASTNode *index) {
+    ASTNode *node = create_node(NODE_ARRAY_ACCESS, NODE_SIZE(array_access));
+    node->data.array_access.array_name = name;
     node->data.array_access.index = index;
     return node;
 }
 
 ASTNode* create_array_assignment_node(ASTNode *array_access, ASTNode *value) {
-    ASTNode *node = create_node(NODE_ARRAY_ASSIGNMENT);
+    ASTNode *node = create_node(NODE_ARRAY_ASSIGNMENT, NODE_SIZE(array_assign));
     node->data.array_assign.array_access = array_access;
     node->data.array_assign.value = value;
     return node;
 }
 
 ASTNode* create_if_node(ASTNode *condition, ASTNode *then_branch, ASTNode *else_branch) {
-    ASTNode *node = create_node(NODE_IF);
+    ASTNode *node = create_node(NODE_IF, NODE_SIZE(if_stmt));
     node->data.if_stmt.condition = condition;
     node->data.if_stmt.then_branch = then_branch;
     node->data.if_stmt.else_branch = else_branch;
@@ -110,14 +120,14 @@ ASTNode* create_if_node(ASTNode *condition, ASTNode *then_branch, ASTNode *else_
 }
 
 ASTNode* create_while_node(ASTNode *condition, ASTNode *body) {
-    ASTNode *node = create_node(NODE_WHILE);
+    ASTNode *node = create_node(NODE_WHILE, NODE_SIZE(while_stmt));
     node->data.while_stmt.condition = condition;
     node->data.while_stmt.body = body;
     return node;
 }
 
 ASTNode* create_for_node(ASTNode *init, ASTNode *condition, ASTNode *increment, ASTNode *body) {
-    ASTNode *node = create_node(NODE_FOR);
+    ASTNode *node = create_node(NODE_FOR, NODE_SIZE(for_stmt));
     node->data.for_stmt.init = init;
     node->data.for_stmt.condition = condition;
     node->data.for_stmt.increment = increment;
@@ -125,111 +135,97 @@ ASTNode* create_for_node(ASTNode *init, ASTNode *condition, ASTNode *increment,
     return node;
 }
 
-ASTNode* create_function_node(char *name, ASTNode *parameters, DataType return_type, ASTNode *body) {
-    ASTNode *node = create_node(NODE_FUNCTION_DEF);
-    node->data.function_def.func_name = strdup(name);
+ASTNode* create_function_node(const char *name, ASTNode *parameters, DataType return_type, ASTNode *body) {
+    ASTNode *node = create_node(NODE_FUNCTION_DEF, NODE_SIZE(function_def));
+    node->data.function_def.func_name = name;
     node->data.function_def.parameters = parameters;
     node->data.function_def.return_type = return_type;
     node->data.function_def.body = body;
     return node;
 }
 
-ASTNode* create_function_call_node(char *name, ASTNode *arguments) {
-    ASTNode *node = create_node(NODE_FUNCTION_CALL);
-    node->data.function_call.func_name = strdup(name);
+ASTNode* create_function_call_node(const char *name, ASTNode *arguments) {
+    ASTNode *node = create_node(NODE_FUNCTION_CALL, NODE_SIZE(function_call));
+    node->data.function_call.func_name = name;
     node->data.function_call.arguments = arguments;
     return node;
 }
 
-ASTNode* create_parameter_node(DataType type, char *name, ASTNode *next) {
-    ASTNode *node = create_node(NODE_PARAMETER);
+ASTNode* create_parameter_node(DataType type, const char *name, ASTNode *next) {
+    ASTNode *node = create_node(NODE_PARAMETER, NODE_SIZE(parameter));
     node->data.parameter.param_type = type;
-    node->data.parameter.param_name = strdup(name);
+    node->data.parameter.param_name = name;
     node->data.parameter.next = next;
     return node;
 }
 
 ASTNode* create_argument_node(ASTNode *expression, ASTNode *next) {
-    ASTNode *node = create_node(NODE_ARGUMENT);
+    ASTNode *node = create_node(NODE_ARGUMENT, NODE_SIZE(argument));
     node->data.argument.expression = expression;
     node->data.argument.next = next;
     return node;
 }
 
 ASTNode* create_return_node(ASTNode *value) {
-    ASTNode *node = create_node(NODE_RETURN);
+    ASTNode *node = create_node(NODE_RETURN, NODE_SIZE(return_stmt));
     node->data.return_stmt.return_value = value;
     return node;
 }
 
 ASTNode* create_pixel_node(ASTNode *x, ASTNode *y, ASTNode *color) {
-    ASTNode *node = create_node(NODE_PIXEL);
+    ASTNode *node = create_node(NODE_PIXEL, NODE_SIZE(pixel));
     node->data.pixel.x = x;
     node->data.pixel.y = y;
     node->data.pixel.color = color;
     return node;
 }
 
-ASTNode* create_key_node(ASTNode *key_code, char *dest_var) {
-    ASTNode *node = create_node(NODE_KEY);
+ASTNode* create_key_node(ASTNode *key_code, const char *dest_var) {
+    ASTNode *node = create_node(NODE_KEY, NODE_SIZE(key));
     node->data.key.key_code = key_code;
-    node->data.key.dest_var = strdup(dest_var);
+    node->data.key.dest_var = dest_var;
     return node;
 }
 
-ASTNode* create_input_node(char *var_name) {
-    ASTNode *node = create_node(NODE_INPUT);
-    node->data.input.input_var = strdup(var_name);
+ASTNode* create_input_node(const char *var_name) {
+    ASTNode *node = create_node(NODE_INPUT, NODE_SIZE(input));
+    node->data.input.input_var = var_name;
     return node;
 }
 
 ASTNode* create_print_node(ASTNode *expression) {
-    ASTNode *node = create_node(NODE_PRINT);
+    ASTNode *node = create_node(NODE_PRINT, NODE_SIZE(print));
     node->data.print.expression = expression;
     return node;
 }
 
 ASTNode* create_length_node(ASTNode *array) {
-    ASTNode *node = create_node(NODE_LENGTH);
+    ASTNode *node = create_node(NODE_LENGTH, NODE_SIZE(length));
     node->data_type = TYPE_INT;
     node->data.length.array = array;
     return node;
 }
 
 ASTNode* create_statement_list(ASTNode *stmt1, ASTNode *stmt2) {
-    ASTNode *node = create_node(NODE_STATEMENT_LIST);
+    ASTNode *node = create_node(NODE_STATEMENT_LIST, NODE_SIZE(stmt_list));
     node->data.stmt_list.statement = stmt1;
     node->data.stmt_list.next = stmt2;
     return node;
 }
 
-void free_ast(ASTNode *node) {
-    if (!node) return;
-    
-    switch (node->type) {
-        case NODE_BINOP:
-            free_ast(node->data.binop.left);
-            free_ast(node->data.binop.right);
-            break;
-        case NODE_UNOP:
-            free_ast(node->data.unop.operand);
-            break;
-        case NODE_DECLARATION:
-            free(node->data.declaration.var_name);
-            free_ast(node->data.declaration.init_value);
-            break;
-        case NODE_ASSIGNMENT:
-            free(node->data.assignment.var_name);
-            free_ast(node->data.assignment.value);
-            break;
-        case NODE_STATEMENT_LIST:
-            free_ast(node->data.stmt_list.statement);
-            free_ast(node->data.stmt_list.next);
-            break;
-        // ... otros casos según sea necesario
-        default:
-            break;
-    }
-    
-    free(node);
+void free_ast(void) {
+    arena_release(&ast_arena);
+    node_count = 0;
+}
+
+size_t ast_node_count(void) {
+    return node_count;
+}
+
+size_t ast_bytes_used(void) {
+    return ast_arena.bytes_used;
+}
+
+size_t ast_bytes_reserved(void) {
+    return ast_arena.bytes_reserved;
 }
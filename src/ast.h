@@ -1,6 +1,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stddef.h>
+
 // Tipos de datos
 typedef enum {
     TYPE_INT,
@@ -65,20 +67,31 @@ typedef enum {
     OP_NOT
 } UnaryOperator;
 
+struct Symbol;
+
 // Estructura del nodo AST
+// Los nombres (identificadores, variables, funciones) son átomos de intern.h.
+// Cada nodo se reserva en el arena del AST con el tamaño exacto de su variante:
+// solo el miembro de 'data' que corresponde a 'type' es válido.
+// El análisis semántico llena 'data_type' en las expresiones y los campos
+// 'symbol' con el símbolo resuelto, para que las fases siguientes no vuelvan
+// a buscar nombres.
 typedef struct ASTNode {
-    NodeType type;
-    DataType data_type;
+    NodeType type : 8;
+    DataType data_type : 8;
     
     union {
         // Literales
         int int_value;
         float float_value;
         int bool_value;
-        char *string_value;
+        const char *string_value;
         
         // Identificador
-        char *identifier;
+        struct {
+            const char *name;
+            struct Symbol *symbol;
+        } identifier;
         
         // Operadores
         struct {
@@ -95,26 +108,30 @@ typedef struct ASTNode {
         // Declaración
         struct {
             DataType var_type;
-            char *var_name;
+            const char *var_name;
             struct ASTNode *init_value;
+            struct Symbol *symbol;
         } declaration;
         
         // Asignación
         struct {
-            char *var_name;
+            const char *var_name;
             struct ASTNode *value;
+            struct Symbol *symbol;
         } assignment;
         
         // Array
         struct {
             DataType element_type;
-            char *array_name;
+            const char *array_name;
             struct ASTNode *elements;
+            struct Symbol *symbol;
         } array_decl;
         
         struct {
-            char *array_name;
+            const char *array_name;
             struct ASTNode *index;
+            struct Symbol *symbol;
         } array_access;
         
         struct {
@@ -143,21 +160,24 @@ typedef struct ASTNode {
         
         // Funciones
         struct {
-            char *func_name;
+            const char *func_name;
             struct ASTNode *parameters;
             DataType return_type;
             struct ASTNode *body;
+            struct Symbol *symbol;
         } function_def;
         
         struct {
-            char *func_name;
+            const char *func_name;
             struct ASTNode *arguments;
+            struct Symbol *symbol;
         } function_call;
         
         struct {
             DataType param_type;
-            char *param_name;
+            const char *param_name;
             struct ASTNode *next;
+            struct Symbol *symbol;
         } parameter;
         
         struct {
@@ -179,11 +199,13 @@ typedef struct ASTNode {
         
         struct {
             struct ASTNode *key_code;
-            char *dest_var;
+            const char *dest_var;
+            struct Symbol *dest_symbol;
         } key;
         
         struct {
-            char *input_var;
+            const char *input_var;
+            struct Symbol *symbol;
         } input;
         
         struct {
@@ -205,39 +227,48 @@ typedef struct ASTNode {
 // Funciones para crear nodos
 ASTNode* create_int_literal_node(int value);
 ASTNode* create_float_literal_node(float value);
-ASTNode* create_string_literal_node(char *value);
+ASTNode* create_string_literal_node(const char *value);
 ASTNode* create_bool_literal_node(int value);
-ASTNode* create_identifier_node(char *name);
+ASTNode* create_identifier_node(const char *name);
 
 ASTNode* create_binop_node(BinaryOperator op, ASTNode *left, ASTNode *right);
 ASTNode* create_unop_node(UnaryOperator op, ASTNode *operand);
 
-ASTNode* create_declaration_node(DataType type, char *name, ASTNode *init_value);
-ASTNode* create_assignment_node(char *name, ASTNode *value);
+ASTNode* create_declaration_node(DataType type, const char *name, ASTNode *init_value);
+ASTNode* create_assignment_node(const char *name, ASTNode *value);
 
-ASTNode* create_array_declaration_node(DataType type, char *name, ASTNode *elements);
-ASTNode* create_array_access_node(char *name, ASTNode *index);
+ASTNode* create_array_declaration_node(DataType type, const char *name, ASTNode *elements);
+ASTNode* create_array_access_node(const char *name, ASTNode *index);
 ASTNode* create_array_assignment_node(ASTNode *array_access, ASTNode *value);
 
 ASTNode* create_if_node(ASTNode *condition, ASTNode *then_branch, ASTNode *else_branch);
 ASTNode* create_while_node(ASTNode *condition, ASTNode *body);
 ASTNode* create_for_node(ASTNode *init, ASTNode *condition, ASTNode *increment, ASTNode *body);
 
-ASTNode* create_function_node(char *name, ASTNode *parameters, DataType return_type, ASTNode *body);
-ASTNode* create_function_call_node(char *name, ASTNode *arguments);
-ASTNode* create_parameter_node(DataType type, char *name, ASTNode *next);
+ASTNode* create_function_node(const char *name, ASTNode *parameters, DataType return_type, ASTNode *body);
+ASTNode* create_function_call_node(const char *name, ASTNode *arguments);
+ASTNode* create_parameter_node(DataType type, const char *name, ASTNode *next);
 ASTNode* create_argument_node(ASTNode *expression, ASTNode *next);
 
 ASTNode* create_return_node(ASTNode *value);
 
 ASTNode* create_pixel_node(ASTNode *x, ASTNode *y, ASTNode *color);
-ASTNode* create_key_node(ASTNode *key_code, char *dest_var);
-ASTNode* create_input_node(char *var_name);
+ASTNode* create_key_node(ASTNode *key_code, const char *dest_var);
+ASTNode* create_input_node(const char *var_name);
 ASTNode* create_print_node(ASTNode *expression);
 ASTNode* create_length_node(ASTNode *array);
 
 ASTNode* create_statement_list(ASTNode *stmt1, ASTNode *stmt2);
 
-void free_ast(ASTNode *node);
+// Cadenas de tokens (propiedad del arena del AST)
+char* ast_strdup(const char *str);
+
+// Libera en bloque todos los nodos y cadenas del AST
+void free_ast(void);
+
+// Estadísticas de memoria del AST
+size_t ast_node_count(void);
+size_t ast_bytes_used(void);
+size_t ast_bytes_reserved(void);
 
 #endif
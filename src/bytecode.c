@@ -0,0 +1,444 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "bytecode.h"
+#include "outbuf.h"
+#include "diag.h"
+
+// Ensamblador del texto FIS-25 a bytecode.h. Lee el texto que acaba de
+// escribir ir_print_program, así que la salida binaria tiene exactamente
+// las mismas instrucciones, variables y etiquetas (numeradas en el orden en
+// que aparecen, como las numera la máquina virtual al cargar el texto).
+
+#define BC_MAX_TOKENS 5
+#define NAME_MAP_INITIAL_CAPACITY 1024
+
+// Nombre -> número, para variables, constantes y etiquetas. Las claves se
+// copian a 'keys' porque las líneas del texto no terminan en '\0'.
+typedef struct NameMap {
+    uint32_t *offsets;      // Desplazamiento de la clave en 'keys' + 1; 0 si vacío
+    int *values;
+    int capacity;
+    int count;
+    OutBuffer keys;
+} NameMap;
+
+typedef struct Token {
+    const char *text;
+    size_t length;
+} Token;
+
+// Tipo provisorio de cada operando: las celdas de las constantes y los
+// destinos de los saltos se conocen al terminar
+enum {
+    OPERAND_NONE,
+    OPERAND_VAR,
+    OPERAND_CONSTANT,
+    OPERAND_LABEL,      // Número de etiqueta (LABEL)
+    OPERAND_TARGET      // Número de etiqueta que se cambia por su instrucción
+};
+
+typedef struct Constant {
+    uint32_t kind;
+    uint64_t value;
+} Constant;
+
+typedef struct Assembler {
+    NameMap vars;               // Las claves son los nombres en orden
+    NameMap constants;
+    NameMap labels;
+    Constant *constant_values;
+    int *label_targets;
+    int constant_capacity;
+    int label_capacity;
+    uint32_t *operands;         // Tres por instrucción
+    unsigned char *kinds;       // Tipo provisorio de cada operando
+    unsigned char *opcodes;
+    int count;
+    int capacity;
+    OutBuffer strings;          // Constantes de texto sin comillas
+} Assembler;
+
+static const char *opcode_names[BC_OPCODE_COUNT] = { BC_OPCODE_NAMES };
+
+static void out_of_memory(void) {
+    fprintf(stderr, "Error: sin memoria para la salida binaria\n");
+    exit(1);
+}
+
+static void* xrealloc(void *ptr, size_t size) {
+    void *result = realloc(ptr, size);
+    if (!result) out_of_memory();
+    return result;
+}
+
+static void assembler_error(const Token *line) {
+    fprintf(stderr, "Error interno: línea FIS-25 inválida: %.*s\n", (int)line->length, line->text);
+    exit(1);
+}
+
+static uint32_t hash_token(const Token *token) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < token->length; i++) {
+        hash = (hash ^ (unsigned char)token->text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void map_init(NameMap *map) {
+    map->capacity = NAME_MAP_INITIAL_CAPACITY;
+    map->count = 0;
+    map->offsets = (uint32_t*)calloc(map->capacity, sizeof(uint32_t));
+    map->values = (int*)malloc(map->capacity * sizeof(int));
+    out_init(&map->keys);
+    if (!map->offsets || !map->values) out_of_memory();
+}
+
+static void map_free(NameMap *map) {
+    free(map->offsets);
+    free(map->values);
+    out_free(&map->keys);
+}
+
+static int map_slot(const NameMap *map, const Token *token, uint32_t hash) {
+    int mask = map->capacity - 1;
+    int slot = (int)(hash & (uint32_t)mask);
+    while (map->offsets[slot]) {
+        const char *key = map->keys.data + map->offsets[slot] - 1;
+        if (strncmp(key, token->text, token->length) == 0 && key[token->length] == '\0') break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void map_grow(NameMap *map) {
+    int old_capacity = map->capacity;
+    uint32_t *old_offsets = map->offsets;
+    int *old_values = map->values;
+    map->capacity *= 2;
+    map->offsets = (uint32_t*)calloc(map->capacity, sizeof(uint32_t));
+    map->values = (int*)malloc(map->capacity * sizeof(int));
+    if (!map->offsets || !map->values) out_of_memory();
+    for (int i = 0; i < old_capacity; i++) {
+        if (!old_offsets[i]) continue;
+        Token key;
+        key.text = map->keys.data + old_offsets[i] - 1;
+        key.length = strlen(key.text);
+        int slot = map_slot(map, &key, hash_token(&key));
+        map->offsets[slot] = old_offsets[i];
+        map->values[slot] = old_values[i];
+    }
+    free(old_offsets);
+    free(old_values);
+}
+
+// Número del nombre; si es nuevo le da el siguiente y pone *added en 1
+static int map_find_or_add(NameMap *map, const Token *token, int *added) {
+    if ((map->count + 1) * 2 > map->capacity) map_grow(map);
+    uint32_t hash = hash_token(token);
+    int slot = map_slot(map, token, hash);
+    *added = !map->offsets[slot];
+    if (*added) {
+        map->offsets[slot] = (uint32_t)map->keys.length + 1;
+        out_bytes(&map->keys, token->text, token->length);
+        out_char(&map->keys, '\0');
+        map->values[slot] = map->count++;
+    }
+    return map->values[slot];
+}
+
+static uint32_t string_add(Assembler *as, const char *text, size_t length) {
+    uint32_t offset = (uint32_t)as->strings.length;
+    out_bytes(&as->strings, text, length);
+    out_char(&as->strings, '\0');
+    return offset;
+}
+
+static int add_label(Assembler *as, const Token *token) {
+    int added;
+    int label = map_find_or_add(&as->labels, token, &added);
+    if (added) {
+        if (label == as->label_capacity) {
+            as->label_capacity = as->label_capacity ? as->label_capacity * 2 : 256;
+            as->label_targets = (int*)xrealloc(as->label_targets, as->label_capacity * sizeof(int));
+        }
+        as->label_targets[label] = -1;
+    }
+    return label;
+}
+
+// Mismas reglas que la máquina virtual: '-' opcional, un dígito y luego dígitos o '.'
+static int is_number(const Token *token) {
+    size_t i = 0;
+    if (i < token->length && token->text[i] == '-') i++;
+    if (i >= token->length || !isdigit((unsigned char)token->text[i])) return 0;
+    for (; i < token->length; i++) {
+        if (!isdigit((unsigned char)token->text[i]) && token->text[i] != '.') return 0;
+    }
+    return 1;
+}
+
+// Operando que se lee o escribe: variable o constante
+static void add_value(Assembler *as, int operand, const Token *token) {
+    int added;
+    if (token->text[0] == '"' || is_number(token)) {
+        int k = map_find_or_add(&as->constants, token, &added);
+        if (added) {
+            if (k == as->constant_capacity) {
+                as->constant_capacity = as->constant_capacity ? as->constant_capacity * 2 : 256;
+                as->constant_values = (Constant*)xrealloc(as->constant_values,
+                                                          as->constant_capacity * sizeof(Constant));
+            }
+            Constant *constant = &as->constant_values[k];
+            char number[64];
+            if (token->text[0] == '"') {
+                // Sin comillas, como la guarda la máquina virtual
+                size_t length = token->length >= 2 ? token->length - 2 : 0;
+                constant->kind = BC_CONST_STRING;
+                constant->value = string_add(as, token->text + 1, length);
+            } else if (token->length < sizeof(number)) {
+                memcpy(number, token->text, token->length);
+                number[token->length] = '\0';
+                if (memchr(token->text, '.', token->length)) {
+                    double value = atof(number);
+                    constant->kind = BC_CONST_FLOAT;
+                    memcpy(&constant->value, &value, sizeof(value));
+                } else {
+                    constant->kind = BC_CONST_INT;
+                    constant->value = (uint64_t)(int64_t)atoi(number);
+                }
+            } else {
+                assembler_error(token);
+            }
+        }
+        as->operands[as->count * 3 + operand] = (uint32_t)k;
+        as->kinds[as->count * 3 + operand] = OPERAND_CONSTANT;
+    } else {
+        int var = map_find_or_add(&as->vars, token, &added);
+        as->operands[as->count * 3 + operand] = (uint32_t)var;
+        as->kinds[as->count * 3 + operand] = OPERAND_VAR;
+    }
+}
+
+static void set_label(Assembler *as, int operand, int label, int kind) {
+    as->operands[as->count * 3 + operand] = (uint32_t)label;
+    as->kinds[as->count * 3 + operand] = (unsigned char)kind;
+}
+
+// Separa la línea en palabras; las cadenas entre comillas son una sola
+static int tokenize(const Token *line, Token *tokens) {
+    const char *p = line->text;
+    const char *end = line->text + line->length;
+    int count = 0;
+    while (p < end) {
+        while (p < end && isspace((unsigned char)*p)) p++;
+        if (p == end || *p == ';') break;
+        if (count == BC_MAX_TOKENS) return -1;
+        const char *start = p;
+        if (*p == '"') {
+            p++;
+            while (p < end && *p != '"') {
+                if (*p == '\\' && p + 1 < end) p++;
+                p++;
+            }
+            if (p < end) p++;
+        } else {
+            while (p < end && !isspace((unsigned char)*p)) p++;
+        }
+        tokens[count].text = start;
+        tokens[count].length = (size_t)(p - start);
+        count++;
+    }
+    return count;
+}
+
+static int find_opcode(const Token *token) {
+    for (int op = 0; op < BC_OPCODE_COUNT; op++) {
+        if (strncmp(opcode_names[op], token->text, token->length) == 0 &&
+            opcode_names[op][token->length] == '\0') {
+            return op;
+        }
+    }
+    return -1;
+}
+
+static void assemble_line(Assembler *as, const Token *line) {
+    Token tokens[BC_MAX_TOKENS];
+    int count = tokenize(line, tokens);
+    if (count == 0) return;
+    if (count < 0) assembler_error(line);
+    int op = find_opcode(&tokens[0]);
+    if (op < 0) assembler_error(line);
+
+    if (as->count == as->capacity) {
+        as->capacity = as->capacity ? as->capacity * 2 : 1024;
+        as->operands = (uint32_t*)xrealloc(as->operands, as->capacity * 3 * sizeof(uint32_t));
+        as->kinds = (unsigned char*)xrealloc(as->kinds, as->capacity * 3);
+        as->opcodes = (unsigned char*)xrealloc(as->opcodes, as->capacity);
+    }
+    memset(&as->operands[as->count * 3], 0, 3 * sizeof(uint32_t));
+    memset(&as->kinds[as->count * 3], OPERAND_NONE, 3);
+    as->opcodes[as->count] = (unsigned char)op;
+
+    int expected;
+    switch (op) {
+        case BC_LABEL: {
+            expected = 1;
+            if (count != 2) break;
+            int label = add_label(as, &tokens[1]);
+            if (as->label_targets[label] >= 0) assembler_error(line);
+            as->label_targets[label] = as->count;
+            set_label(as, 0, label, OPERAND_LABEL);
+            break;
+        }
+        case BC_GOTO:
+        case BC_GOSUB:
+            expected = 1;
+            if (count == 2) set_label(as, 0, add_label(as, &tokens[1]), OPERAND_TARGET);
+            break;
+        case BC_IFFALSE:
+            expected = 3;
+            if (count != 4) break;
+            if (tokens[2].length != 4 || strncmp(tokens[2].text, "GOTO", 4) != 0) assembler_error(line);
+            add_value(as, 0, &tokens[1]);
+            set_label(as, 1, add_label(as, &tokens[3]), OPERAND_TARGET);
+            break;
+        case BC_RETURN:
+        case BC_HALT:
+            expected = 0;
+            break;
+        case BC_VAR: case BC_PARAM_GET: case BC_INPUT: case BC_PARAM: case BC_PRINT:
+            expected = 1;
+            break;
+        case BC_ASSIGN: case BC_KEY:
+            expected = 2;
+            break;
+        default:
+            expected = 3;
+            break;
+    }
+    if (count - 1 != expected) assembler_error(line);
+    if (op != BC_LABEL && op != BC_GOTO && op != BC_GOSUB && op != BC_IFFALSE) {
+        for (int i = 0; i < expected; i++) add_value(as, i, &tokens[i + 1]);
+    }
+    as->count++;
+}
+
+static void out_uint(OutBuffer *out, uint64_t value, int width) {
+    unsigned char bytes[8];
+    for (int i = 0; i < width; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    out_bytes(out, bytes, (size_t)width);
+}
+
+// Bytes necesarios para los números 0 .. count - 1
+static int index_width(uint32_t count) {
+    int width = 1;
+    while (width < 4 && count > (1u << (8 * width))) width++;
+    return width;
+}
+
+static void write_binary(Assembler *as, OutBuffer *binary) {
+    uint32_t var_count = (uint32_t)as->vars.count;
+    uint32_t names_length = (uint32_t)(as->vars.keys.length + as->labels.keys.length);
+    if ((uint32_t)as->count > BC_MAX_INDEX ||
+        (uint64_t)var_count + (uint64_t)as->constants.count > BC_MAX_INDEX ||
+        (uint64_t)names_length + as->strings.length > UINT32_MAX) {
+        compile_error("Error: El programa es demasiado grande para --emit=bin\n");
+    }
+
+    // Cada clase de operando ocupa lo justo para este programa
+    int widths[5] = { 0 };
+    widths[OPERAND_VAR] = widths[OPERAND_CONSTANT] = index_width(var_count + (uint32_t)as->constants.count);
+    widths[OPERAND_TARGET] = index_width((uint32_t)as->count);
+    widths[OPERAND_LABEL] = index_width((uint32_t)as->labels.count);
+
+    size_t code_length = 0;
+    for (int i = 0; i < as->count * 3; i++) code_length += (size_t)widths[as->kinds[i]];
+    code_length += (size_t)as->count;
+    if (code_length > UINT32_MAX) {
+        compile_error("Error: El programa es demasiado grande para --emit=bin\n");
+    }
+
+    out_bytes(binary, BC_MAGIC, 4);
+    out_uint(binary, BC_VERSION, 4);
+    out_uint(binary, (uint32_t)as->count, 4);
+    out_uint(binary, var_count, 4);
+    out_uint(binary, (uint32_t)as->constants.count, 4);
+    out_uint(binary, (uint32_t)as->labels.count, 4);
+    out_uint(binary, code_length, 4);
+    out_uint(binary, names_length + as->strings.length, 4);
+    out_uint(binary, (uint64_t)widths[OPERAND_VAR], 1);
+    out_uint(binary, (uint64_t)widths[OPERAND_TARGET], 1);
+    out_uint(binary, (uint64_t)widths[OPERAND_LABEL], 1);
+    out_uint(binary, 0, 1);
+
+    for (int k = 0; k < as->constants.count; k++) {
+        const Constant *constant = &as->constant_values[k];
+        uint64_t value = constant->value;
+        if (constant->kind == BC_CONST_STRING) value += names_length;
+        out_uint(binary, constant->kind, 1);
+        out_uint(binary, value, 8);
+    }
+
+    for (int l = 0; l < as->labels.count; l++) {
+        if (as->label_targets[l] < 0) {
+            fprintf(stderr, "Error interno: etiqueta no definida en la salida binaria\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < as->count; i++) {
+        out_char(binary, (char)as->opcodes[i]);
+        for (int a = 0; a < 3; a++) {
+            int kind = as->kinds[i * 3 + a];
+            uint32_t value = as->operands[i * 3 + a];
+            switch (kind) {
+                case OPERAND_NONE: continue;
+                case OPERAND_CONSTANT: value += var_count; break;
+                case OPERAND_TARGET: value = (uint32_t)as->label_targets[value]; break;
+                default: break;
+            }
+            out_uint(binary, value, widths[kind]);
+        }
+    }
+
+    out_append(binary, &as->vars.keys);
+    out_append(binary, &as->labels.keys);
+    out_append(binary, &as->strings);
+}
+
+int bytecode_assemble(const OutBuffer *text, OutBuffer *binary) {
+    Assembler as;
+    memset(&as, 0, sizeof(as));
+    map_init(&as.vars);
+    map_init(&as.constants);
+    map_init(&as.labels);
+    out_init(&as.strings);
+
+    const char *p = text->data;
+    const char *end = text->data + text->length;
+    while (p < end) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) eol = end;
+        Token line;
+        line.text = p;
+        line.length = (size_t)(eol - p);
+        assemble_line(&as, &line);
+        p = eol + 1;
+    }
+
+    write_binary(&as, binary);
+    int count = as.count;
+
+    map_free(&as.vars);
+    map_free(&as.constants);
+    map_free(&as.labels);
+    free(as.constant_values);
+    free(as.label_targets);
+    free(as.operands);
+    free(as.kinds);
+    free(as.opcodes);
+    out_free(&as.strings);
+    return count;
+}
@@ -0,0 +1,73 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+// Formato binario de FIS-25 (--emit=bin). Lo escribe el compilador
+// (bytecode.c) y lo lee la máquina virtual sin tokenizar texto ni buscar
+// nombres: las variables y las constantes están numeradas y los saltos ya
+// apuntan al índice de la instrucción destino.
+//
+// Todos los enteros son little-endian. El archivo es, en orden:
+//
+//   cabecera        BC_HEADER_SIZE bytes: BC_MAGIC, siete u32 (versión,
+//                   instrucciones, variables, constantes, etiquetas, bytes
+//                   de código y bytes de nombres) y cuatro bytes: el ancho
+//                   en bytes (1 a 4) de las celdas, de los destinos de salto
+//                   y de las etiquetas, y uno reservado en 0
+//   constantes      BC_CONSTANT_SIZE bytes cada una: un byte de tipo
+//                   (BC_CONST_*) y u64 valor (entero con signo, bits de un
+//                   double o desplazamiento de la cadena en los nombres)
+//   código          cada instrucción es un byte de opcode seguido de sus
+//                   operandos (BC_OPCODE_OPERANDS), cada uno con el ancho de
+//                   su clase: el tamaño de una instrucción depende solo de
+//                   su opcode y de la cabecera
+//   nombres         los de las variables en orden, luego los de las
+//                   etiquetas y luego las cadenas sin comillas, todos
+//                   terminados en '\0'
+//
+// Un operando que se lee o escribe es una celda: las variables son las
+// celdas 0 .. variables - 1 y la constante k es la celda variables + k.
+// Los saltos (GOTO, GOSUB, el segundo operando de IFFALSE) llevan el índice
+// de la instrucción destino y LABEL lleva el número de su etiqueta; los
+// nombres de las etiquetas se guardan para las estadísticas y para volver
+// al texto (fis25vm --disasm).
+
+#define BC_MAGIC "F25B"
+#define BC_VERSION 1
+#define BC_HEADER_SIZE 36
+#define BC_CONSTANT_SIZE 9
+#define BC_MAX_INDEX 0x7fffffffu
+
+// Tipos de constante
+#define BC_CONST_INT 0
+#define BC_CONST_FLOAT 1
+#define BC_CONST_STRING 2
+
+// Códigos de operación, en el orden de los opcodes del texto
+enum {
+    BC_VAR, BC_ASSIGN, BC_ADD, BC_SUB, BC_MUL, BC_DIV, BC_MOD,
+    BC_EQ, BC_NEQ, BC_LT, BC_GT, BC_LTE, BC_GTE, BC_AND, BC_OR,
+    BC_LABEL, BC_GOTO, BC_IFFALSE, BC_GOSUB, BC_RETURN, BC_PARAM, BC_PARAM_GET,
+    BC_PIXEL, BC_KEY, BC_INPUT, BC_PRINT, BC_HALT,
+    BC_OPCODE_COUNT
+};
+
+#define BC_OPCODE_NAMES \
+    "VAR", "ASSIGN", "ADD", "SUB", "MUL", "DIV", "MOD", \
+    "EQ", "NEQ", "LT", "GT", "LTE", "GTE", "AND", "OR", \
+    "LABEL", "GOTO", "IFFALSE", "GOSUB", "RETURN", "PARAM", "PARAM_GET", \
+    "PIXEL", "KEY", "INPUT", "PRINT", "HALT"
+
+// Operandos de cada opcode: 'v' variable, 'x' variable o constante (celda),
+// 't' destino de un salto, 'l' etiqueta que se define
+#define BC_OPCODE_OPERANDS \
+    "v", "xv", "xxv", "xxv", "xxv", "xxv", "xxv", \
+    "xxv", "xxv", "xxv", "xxv", "xxv", "xxv", "xxv", "xxv", \
+    "l", "t", "xt", "t", "", "x", "v", \
+    "xxx", "xv", "v", "x", ""
+
+// Ensambla el texto FIS-25 que escribió ir_print_program y agrega el
+// binario a 'binary'. Devuelve el número de instrucciones.
+struct OutBuffer;
+int bytecode_assemble(const struct OutBuffer *text, struct OutBuffer *binary);
+
+#endif
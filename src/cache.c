@@ -0,0 +1,794 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "diag.h"
+#include "callgraph.h"
+#include "intern.h"
+
+// Cada función se guarda en <dir>/<clave>.ir como texto:
+//
+//   FIS25-IR 1
+//   function <nombre> <optimizada> <costo> <temporales> <entrada>
+//   vars <n>             y por variable: <tipo de var> <tipo> <temporal> <origen> <nombre|->
+//   blocks <n>           y por bloque:   <terminador> <succ0> <succ1> <cond> <instrucciones>
+//                        y por instrucción: <op> <dst> <src0> <src1> <src2> <llamado|-> <n> <args...>
+//   layout <n> <bloques...>
+//
+// Los operandos son '-', v<variable>, i<entero>, f<flotante en hexadecimal>
+// o s<longitud>:<bytes>. Los globales, los ret_ y los llamados se guardan
+// por nombre y se vuelven a buscar al cargar; las ranuras y los nombres
+// calificados no se guardan porque dependen del resto del programa.
+
+#define CACHE_FORMAT "FIS25-IR 2"
+#define CACHE_PATH_MAX 4096
+
+// Tabla de dispersión de punteros (nodos, símbolos, átomos) a índices
+typedef struct PointerMap {
+    const void **keys;
+    int *values;
+    int capacity;
+} PointerMap;
+
+// Función definida en el programa
+typedef struct CacheEntry {
+    ASTNode *node;
+    uint64_t own;           // Su subárbol y las firmas de lo que usa
+    uint64_t key;           // 'own' y las claves de todo lo que puede llamar
+    int tabulated;          // Pedida con --table: no se carga ni se guarda
+} CacheEntry;
+
+// Función que no estaba en la caché: se guarda después de optimizarla
+typedef struct PendingStore {
+    int function;           // Índice en program->functions
+    uint64_t key;
+} PendingStore;
+
+struct CompileCache {
+    const char *dir;
+    CacheEntry *entries;
+    int entry_count;
+    PointerMap by_node;     // NODE_FUNCTION_DEF -> entrada
+
+    Symbol **symbols;       // Globales, funciones y elementos de arrays
+    int symbol_count;
+    PointerMap by_name;     // Átomo -> símbolo; se llena en la primera carga
+
+    PendingStore *pending;
+    int pending_count;
+    int pending_capacity;
+
+    int hits;
+    int misses;
+};
+
+static void cache_error(const char *message, const char *path) {
+    compile_error("Error: %s %s: %s\n", message, path, strerror(errno));
+}
+
+static void map_init(PointerMap *map, int count) {
+    map->capacity = 16;
+    while (map->capacity < count * 2) map->capacity *= 2;
+    map->keys = (const void**)calloc(map->capacity, sizeof(void*));
+    map->values = (int*)malloc(map->capacity * sizeof(int));
+}
+
+static int map_slot(const PointerMap *map, const void *key) {
+    uint64_t h = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull;
+    int i = (int)(h >> 40) & (map->capacity - 1);
+    while (map->keys[i] && map->keys[i] != key) i = (i + 1) & (map->capacity - 1);
+    return i;
+}
+
+static void map_put(PointerMap *map, const void *key, int value) {
+    int i = map_slot(map, key);
+    map->keys[i] = key;
+    map->values[i] = value;
+}
+
+static int map_get(const PointerMap *map, const void *key) {
+    if (!map->keys) return -1;
+    int i = map_slot(map, key);
+    return map->keys[i] ? map->values[i] : -1;
+}
+
+static void map_free(PointerMap *map) {
+    free(map->keys);
+    free(map->values);
+}
+
+/* ---------- Claves ---------- */
+
+// FNV-1a de 64 bits; los llamados directos se anotan al recorrer el árbol
+typedef struct Hasher {
+    uint64_t hash;
+    Symbol **callees;
+    int callee_count;
+    int callee_capacity;
+} Hasher;
+
+static void hash_bytes(Hasher *h, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        h->hash ^= bytes[i];
+        h->hash *= 0x100000001B3ull;
+    }
+}
+
+static void hash_int(Hasher *h, long long value) {
+    hash_bytes(h, &value, sizeof(value));
+}
+
+static void hash_string(Hasher *h, const char *text) {
+    if (!text) {
+        hash_int(h, -1);
+        return;
+    }
+    size_t length = strlen(text);
+    hash_int(h, (long long)length);
+    hash_bytes(h, text, length);
+}
+
+// Firma de un símbolo: cambia si cambia el tipo de un global o de una función
+static void hash_symbol(Hasher *h, const Symbol *symbol) {
+    if (!symbol) {
+        hash_int(h, -1);
+        return;
+    }
+    hash_string(h, symbol->name);
+    hash_int(h, symbol->type);
+    hash_int(h, symbol->is_array);
+    hash_int(h, symbol->array_size);
+    hash_int(h, symbol->is_function);
+    hash_int(h, symbol->return_type);
+    hash_int(h, symbol->scope_level == 0);
+}
+
+static void hash_node(Hasher *h, ASTNode *node) {
+    if (!node) {
+        hash_int(h, -1);
+        return;
+    }
+    hash_int(h, node->type);
+    hash_int(h, node->data_type);
+
+    switch (node->type) {
+        case NODE_STATEMENT_LIST:
+            hash_node(h, node->data.stmt_list.statement);
+            hash_node(h, node->data.stmt_list.next);
+            break;
+        case NODE_DECLARATION:
+            hash_int(h, node->data.declaration.var_type);
+            hash_string(h, node->data.declaration.var_name);
+            hash_symbol(h, node->data.declaration.symbol);
+            hash_node(h, node->data.declaration.init_value);
+            break;
+        case NODE_ASSIGNMENT:
+            hash_symbol(h, node->data.assignment.symbol);
+            hash_node(h, node->data.assignment.value);
+            break;
+        case NODE_ARRAY_DECLARATION:
+            hash_int(h, node->data.array_decl.element_type);
+            hash_symbol(h, node->data.array_decl.symbol);
+            hash_node(h, node->data.array_decl.elements);
+            break;
+        case NODE_ARRAY_ACCESS:
+            hash_symbol(h, node->data.array_access.symbol);
+            hash_node(h, node->data.array_access.index);
+            break;
+        case NODE_ARRAY_ASSIGNMENT:
+            hash_node(h, node->data.array_assign.array_access);
+            hash_node(h, node->data.array_assign.value);
+            break;
+        case NODE_IF:
+            hash_node(h, node->data.if_stmt.condition);
+            hash_node(h, node->data.if_stmt.then_branch);
+            hash_node(h, node->data.if_stmt.else_branch);
+            break;
+        case NODE_WHILE:
+            hash_node(h, node->data.while_stmt.condition);
+            hash_node(h, node->data.while_stmt.body);
+            break;
+        case NODE_FOR:
+            hash_node(h, node->data.for_stmt.init);
+            hash_node(h, node->data.for_stmt.condition);
+            hash_node(h, node->data.for_stmt.increment);
+            hash_node(h, node->data.for_stmt.body);
+            break;
+        case NODE_FUNCTION_DEF:
+            hash_symbol(h, node->data.function_def.symbol);
+            hash_int(h, node->data.function_def.return_type);
+            hash_node(h, node->data.function_def.parameters);
+            hash_node(h, node->data.function_def.body);
+            break;
+        case NODE_FUNCTION_CALL:
+            hash_symbol(h, node->data.function_call.symbol);
+            hash_node(h, node->data.function_call.arguments);
+            if (h->callee_count == h->callee_capacity) {
+                h->callee_capacity = h->callee_capacity ? h->callee_capacity * 2 : 8;
+                h->callees = (Symbol**)realloc(h->callees, h->callee_capacity * sizeof(Symbol*));
+            }
+            h->callees[h->callee_count++] = node->data.function_call.symbol;
+            break;
+        case NODE_PARAMETER:
+            hash_int(h, node->data.parameter.param_type);
+            hash_string(h, node->data.parameter.param_name);
+            hash_node(h, node->data.parameter.next);
+            break;
+        case NODE_ARGUMENT:
+            hash_node(h, node->data.argument.expression);
+            hash_node(h, node->data.argument.next);
+            break;
+        case NODE_RETURN:
+            hash_node(h, node->data.return_stmt.return_value);
+            break;
+        case NODE_BINOP:
+            hash_int(h, node->data.binop.op);
+            hash_node(h, node->data.binop.left);
+            hash_node(h, node->data.binop.right);
+            break;
+        case NODE_UNOP:
+            hash_int(h, node->data.unop.op);
+            hash_node(h, node->data.unop.operand);
+            break;
+        case NODE_INT_LITERAL:
+            hash_int(h, node->data.int_value);
+            break;
+        case NODE_FLOAT_LITERAL:
+            hash_bytes(h, &node->data.float_value, sizeof(float));
+            break;
+        case NODE_STRING_LITERAL:
+            hash_string(h, node->data.string_value);
+            break;
+        case NODE_BOOL_LITERAL:
+            hash_int(h, node->data.bool_value);
+            break;
+        case NODE_IDENTIFIER:
+            hash_string(h, node->data.identifier.name);
+            hash_symbol(h, node->data.identifier.symbol);
+            break;
+        case NODE_PIXEL:
+            hash_node(h, node->data.pixel.x);
+            hash_node(h, node->data.pixel.y);
+            hash_node(h, node->data.pixel.color);
+            break;
+        case NODE_KEY:
+            hash_symbol(h, node->data.key.dest_symbol);
+            hash_node(h, node->data.key.key_code);
+            break;
+        case NODE_INPUT:
+            hash_symbol(h, node->data.input.symbol);
+            break;
+        case NODE_PRINT:
+            hash_node(h, node->data.print.expression);
+            break;
+        case NODE_LENGTH:
+            hash_node(h, node->data.length.array);
+            break;
+        default:
+            break;
+    }
+}
+
+// Funciones y arrays globales del programa, en orden
+static void collect_definitions(ASTNode *node, CompileCache *cache, ASTNode ***arrays, int *array_count) {
+    if (!node) return;
+    if (node->type == NODE_STATEMENT_LIST) {
+        collect_definitions(node->data.stmt_list.statement, cache, arrays, array_count);
+        collect_definitions(node->data.stmt_list.next, cache, arrays, array_count);
+        return;
+    }
+    if (node->type == NODE_ARRAY_DECLARATION) {
+        *arrays = (ASTNode**)realloc(*arrays, (*array_count + 1) * sizeof(ASTNode*));
+        (*arrays)[(*array_count)++] = node;
+    } else if (node->type == NODE_FUNCTION_DEF) {
+        cache->entries = (CacheEntry*)realloc(cache->entries, (cache->entry_count + 1) * sizeof(CacheEntry));
+        CacheEntry *entry = &cache->entries[cache->entry_count++];
+        memset(entry, 0, sizeof(CacheEntry));
+        entry->node = node;
+    }
+}
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Opciones que cambian la IR optimizada de cualquier función
+static void hash_options(Hasher *h, const CodeGenOptions *options) {
+    hash_string(h, CACHE_FORMAT);
+    hash_int(h, options->optimize);
+    hash_int(h, options->inline_limit);
+    for (int t = 0; t < options->table_count; t++) {
+        const TableSpec *spec = &options->tables[t];
+        hash_string(h, spec->name);
+        for (int p = 0; p < spec->param_count; p++) {
+            hash_int(h, spec->low[p]);
+            hash_int(h, spec->high[p]);
+        }
+    }
+}
+
+// Clave de cada función: su hash propio y el de su componente del grafo de
+// llamadas, que a su vez incluye los de las componentes a las que llama
+static void compute_keys(CompileCache *cache, ASTNode **arrays, int array_count,
+                         const CodeGenOptions *options) {
+    int n = cache->entry_count;
+    PointerMap by_symbol;
+    map_init(&by_symbol, n);
+    for (int f = 0; f < n; f++) map_put(&by_symbol, cache->entries[f].node->data.function_def.symbol, f);
+
+    Hasher h;
+    memset(&h, 0, sizeof(h));
+    CallGraph graph;
+    memset(&graph, 0, sizeof(graph));
+    graph.function_count = n;
+    graph.callee_start = (int*)malloc((n + 1) * sizeof(int));
+    graph.scc = (int*)malloc((n + 1) * sizeof(int));
+    graph.recursive = (int*)calloc(n + 1, sizeof(int));
+    graph.callee_start[0] = 0;
+    int edge_capacity = 0;
+
+    for (int f = 0; f < n; f++) {
+        CacheEntry *entry = &cache->entries[f];
+        ASTNode *node = entry->node;
+        h.hash = 0xCBF29CE484222325ull;
+        h.callee_count = 0;
+        hash_node(&h, node);
+        // main inicializa los arrays globales
+        if (strcmp(node->data.function_def.func_name, "main") == 0) {
+            for (int i = 0; i < array_count; i++) hash_node(&h, arrays[i]);
+        }
+        entry->own = h.hash;
+        for (int t = 0; t < options->table_count; t++) {
+            if (strcmp(options->tables[t].name, node->data.function_def.func_name) == 0) entry->tabulated = 1;
+        }
+
+        int edges = graph.callee_start[f];
+        if (edges + h.callee_count > edge_capacity) {
+            while (edge_capacity < edges + h.callee_count) edge_capacity = edge_capacity ? edge_capacity * 2 : 64;
+            graph.callees = (int*)realloc(graph.callees, edge_capacity * sizeof(int));
+        }
+        for (int i = 0; i < h.callee_count; i++) {
+            int g = map_get(&by_symbol, h.callees[i]);
+            if (g >= 0) graph.callees[edges++] = g;
+        }
+        graph.callee_start[f + 1] = edges;
+    }
+    call_graph_sccs(&graph);
+
+    // Tarjan numera primero las componentes llamadas
+    int *members = (int*)malloc((n + 1) * sizeof(int));
+    int *start = (int*)calloc(n + 2, sizeof(int));
+    for (int f = 0; f < n; f++) start[graph.scc[f] + 1]++;
+    for (int c = 0; c < n; c++) start[c + 1] += start[c];
+    for (int f = 0; f < n; f++) members[start[graph.scc[f]]++] = f;
+    for (int c = n; c > 0; c--) start[c] = start[c - 1];
+    start[0] = 0;
+
+    uint64_t *component_key = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    uint64_t *parts = NULL;
+    int part_capacity = 0;
+    Hasher options_hash;
+    memset(&options_hash, 0, sizeof(options_hash));
+    options_hash.hash = 0xCBF29CE484222325ull;
+    hash_options(&options_hash, options);
+
+    for (int c = 0; c < n && start[c] < n; c++) {
+        int part_count = 0;
+        for (int k = start[c]; k < start[c + 1]; k++) {
+            int f = members[k];
+            int needed = part_count + 1 + graph.callee_start[f + 1] - graph.callee_start[f];
+            if (needed > part_capacity) {
+                while (part_capacity < needed) part_capacity = part_capacity ? part_capacity * 2 : 64;
+                parts = (uint64_t*)realloc(parts, part_capacity * sizeof(uint64_t));
+            }
+            parts[part_count++] = cache->entries[f].own;
+            for (int e = graph.callee_start[f]; e < graph.callee_start[f + 1]; e++) {
+                int g = graph.callees[e];
+                if (graph.scc[g] != c) parts[part_count++] = component_key[graph.scc[g]];
+            }
+        }
+        qsort(parts, part_count, sizeof(uint64_t), compare_keys);
+        h.hash = options_hash.hash;
+        hash_bytes(&h, parts, part_count * sizeof(uint64_t));
+        component_key[c] = h.hash;
+    }
+
+    for (int f = 0; f < n; f++) {
+        h.hash = options_hash.hash;
+        hash_int(&h, (long long)cache->entries[f].own);
+        hash_int(&h, (long long)component_key[graph.scc[f]]);
+        cache->entries[f].key = h.hash;
+    }
+
+    free(parts);
+    free(component_key);
+    free(members);
+    free(start);
+    free(h.callees);
+    free(graph.callee_start);
+    free(graph.callees);
+    free(graph.scc);
+    free(graph.recursive);
+    map_free(&by_symbol);
+}
+
+CompileCache* cache_open(const char *dir, ASTNode *root, const CodeGenOptions *options) {
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) cache_error("No se puede crear el directorio de caché", dir);
+
+    CompileCache *cache = (CompileCache*)calloc(1, sizeof(CompileCache));
+    cache->dir = dir;
+
+    ASTNode **arrays = NULL;
+    int array_count = 0;
+    collect_definitions(root, cache, &arrays, &array_count);
+    map_init(&cache->by_node, cache->entry_count);
+    for (int f = 0; f < cache->entry_count; f++) map_put(&cache->by_node, cache->entries[f].node, f);
+    compute_keys(cache, arrays, array_count, options);
+    free(arrays);
+    return cache;
+}
+
+static void cache_path(const CompileCache *cache, uint64_t key, char *path) {
+    snprintf(path, CACHE_PATH_MAX, "%s/%016llx.ir", cache->dir, (unsigned long long)key);
+}
+
+/* ---------- Carga ---------- */
+
+typedef struct Reader {
+    const char *p;
+    const char *end;
+    int ok;
+} Reader;
+
+static void skip_spaces(Reader *r) {
+    while (r->p < r->end && (*r->p == ' ' || *r->p == '\n' || *r->p == '\t' || *r->p == '\r')) r->p++;
+}
+
+// Siguiente palabra; deja r->ok en 0 si no hay
+static const char* read_token(Reader *r, int *length) {
+    skip_spaces(r);
+    const char *start = r->p;
+    while (r->p < r->end && *r->p != ' ' && *r->p != '\n' && *r->p != '\t' && *r->p != '\r') r->p++;
+    *length = (int)(r->p - start);
+    if (*length == 0) r->ok = 0;
+    return start;
+}
+
+static void expect(Reader *r, const char *word) {
+    int length;
+    const char *token = read_token(r, &length);
+    if (length != (int)strlen(word) || strncmp(token, word, length) != 0) r->ok = 0;
+}
+
+static long read_int(Reader *r, long low, long high) {
+    int length;
+    const char *token = read_token(r, &length);
+    char buffer[32];
+    if (!r->ok || length >= (int)sizeof(buffer)) {
+        r->ok = 0;
+        return low;
+    }
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+    char *end;
+    long value = strtol(buffer, &end, 10);
+    if (*end != '\0' || value < low || value > high) {
+        r->ok = 0;
+        return low;
+    }
+    return value;
+}
+
+// Nombre como átomo; NULL para '-'
+static const char* read_name(Reader *r) {
+    int length;
+    const char *token = read_token(r, &length);
+    char buffer[IR_NAME_MAX];
+    if (!r->ok || length >= (int)sizeof(buffer)) {
+        r->ok = 0;
+        return NULL;
+    }
+    if (length == 1 && token[0] == '-') return NULL;
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+    return intern(buffer);
+}
+
+static Operand read_operand(Reader *r, int var_count) {
+    skip_spaces(r);
+    if (r->p >= r->end) {
+        r->ok = 0;
+        return ir_none();
+    }
+    char kind = *r->p;
+    if (kind == 's') {
+        // La cadena puede tener espacios: va con su longitud
+        char *end;
+        long length = strtol(r->p + 1, &end, 10);
+        if (end == r->p + 1 || *end != ':' || length < 0 || length > r->end - end - 1) {
+            r->ok = 0;
+            return ir_none();
+        }
+        char *text = (char*)malloc(length + 1);
+        memcpy(text, end + 1, length);
+        text[length] = '\0';
+        r->p = end + 1 + length;
+        Operand op = ir_string(intern(text));
+        free(text);
+        return op;
+    }
+
+    int length;
+    const char *token = read_token(r, &length);
+    char buffer[64];
+    if (!r->ok || length >= (int)sizeof(buffer)) {
+        r->ok = 0;
+        return ir_none();
+    }
+    if (length == 1 && kind == '-') return ir_none();
+    memcpy(buffer, token + 1, length - 1);
+    buffer[length - 1] = '\0';
+    char *end;
+    Operand op = ir_none();
+    if (kind == 'v') {
+        long var = strtol(buffer, &end, 10);
+        if (var < 0 || var >= var_count) r->ok = 0;
+        op = ir_var((int)var);
+    } else if (kind == 'i') {
+        long value = strtol(buffer, &end, 10);
+        op = ir_int((int)value);
+    } else if (kind == 'f') {
+        op = ir_float(strtof(buffer, &end));
+    } else {
+        r->ok = 0;
+        return op;
+    }
+    if (end == buffer || *end != '\0') r->ok = 0;
+    return op;
+}
+
+static void index_symbols(CompileCache *cache, IRProgram *program) {
+    int count = program->global_count;
+    for (int i = 0; i < program->global_count; i++) {
+        if (program->globals[i]->is_array) count += program->globals[i]->array_size;
+    }
+    cache->symbols = (Symbol**)malloc((count + 1) * sizeof(Symbol*));
+    map_init(&cache->by_name, count);
+    for (int i = 0; i < program->global_count; i++) {
+        Symbol *symbol = program->globals[i];
+        map_put(&cache->by_name, symbol->name, cache->symbol_count);
+        cache->symbols[cache->symbol_count++] = symbol;
+        for (int e = 0; symbol->is_array && e < symbol->array_size; e++) {
+            map_put(&cache->by_name, symbol->elements[e].name, cache->symbol_count);
+            cache->symbols[cache->symbol_count++] = &symbol->elements[e];
+        }
+    }
+}
+
+static Symbol* find_symbol(CompileCache *cache, const char *name, int is_function) {
+    int i = name ? map_get(&cache->by_name, name) : -1;
+    if (i < 0 || cache->symbols[i]->is_function != is_function) return NULL;
+    return cache->symbols[i];
+}
+
+// Llena 'fn', recién creada con su bloque de entrada; 0 si el archivo no es válido
+static int parse_function(CompileCache *cache, Reader *r, IRFunction *fn) {
+    expect(r, "FIS25-IR");
+    expect(r, "1");
+    expect(r, "function");
+    if (read_name(r) != fn->name) r->ok = 0;
+    int optimized = (int)read_int(r, 0, 1);
+    int inline_cost = (int)read_int(r, -1, 1000000000);
+    int temp_count = (int)read_int(r, 0, 1000000000);
+    int entry = (int)read_int(r, 0, 1000000000);
+
+    expect(r, "vars");
+    int var_count = (int)read_int(r, 0, 100000000);
+    for (int v = 0; r->ok && v < var_count; v++) {
+        IRVarKind kind = (IRVarKind)read_int(r, IRVAR_GLOBAL, IRVAR_TEMP);
+        DataType type = (DataType)read_int(r, TYPE_INT, TYPE_VOID);
+        int temp_id = (int)read_int(r, -1, 1000000000);
+        int origin = (int)read_int(r, 0, var_count - 1);
+        const char *name = read_name(r);
+        Symbol *symbol = NULL;
+        if (kind == IRVAR_GLOBAL || kind == IRVAR_RETURN) {
+            symbol = find_symbol(cache, name, kind == IRVAR_RETURN);
+            if (!symbol) r->ok = 0;
+        }
+        if (!r->ok) break;
+        int var = ir_add_var(fn, kind, name, symbol, type);
+        fn->vars[var].temp_id = temp_id;
+        fn->vars[var].origin = origin;
+    }
+    fn->temp_count = temp_count;
+
+    expect(r, "blocks");
+    int block_count = (int)read_int(r, 1, 100000000);
+    if (!r->ok || entry >= block_count) return 0;
+    while (fn->block_count < block_count) ir_new_block(fn);
+    fn->entry = entry;
+    for (int b = 0; r->ok && b < block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        block->term = (IRTermKind)read_int(r, TERM_GOTO, TERM_HALT);
+        block->succ[0] = (int)read_int(r, -1, block_count - 1);
+        block->succ[1] = (int)read_int(r, -1, block_count - 1);
+        block->cond = read_operand(r, var_count);
+        int count = (int)read_int(r, 0, 100000000);
+        for (int i = 0; r->ok && i < count; i++) {
+            IROp op = (IROp)read_int(r, IR_VAR, IR_NOP);
+            if (op == IR_PHI) r->ok = 0;
+            IRInstr *instr = ir_append(fn, b, op);
+            instr->dst = read_operand(r, var_count);
+            for (int k = 0; k < 3; k++) instr->src[k] = read_operand(r, var_count);
+            const char *callee = read_name(r);
+            if (callee) {
+                instr->callee = find_symbol(cache, callee, 1);
+                if (!instr->callee) r->ok = 0;
+            }
+            int arg_count = (int)read_int(r, 0, 1000000);
+            if (!r->ok) break;
+            if (arg_count > 0) {
+                instr->args = (Operand*)malloc(arg_count * sizeof(Operand));
+                instr->arg_count = arg_count;
+                for (int a = 0; a < arg_count; a++) instr->args[a] = read_operand(r, var_count);
+            }
+            if ((op == IR_CALL) != (instr->callee != NULL)) r->ok = 0;
+        }
+    }
+
+    expect(r, "layout");
+    int layout_count = (int)read_int(r, 0, block_count);
+    for (int i = 0; r->ok && i < layout_count; i++) {
+        ir_place_block(fn, (int)read_int(r, 0, block_count - 1));
+    }
+    skip_spaces(r);
+    if (r->p != r->end) r->ok = 0;
+
+    fn->optimized = optimized;
+    fn->inline_cost = inline_cost;
+    return r->ok;
+}
+
+static char* read_file(const char *path, long *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    char *text = NULL;
+    if (fseek(file, 0, SEEK_END) == 0 && (*size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        text = (char*)malloc(*size + 1);
+        if (fread(text, 1, *size, file) != (size_t)*size) {
+            free(text);
+            text = NULL;
+        }
+    }
+    fclose(file);
+    return text;
+}
+
+int cache_load_function(CompileCache *cache, ASTNode *node, IRProgram *program) {
+    int f = map_get(&cache->by_node, node);
+    if (f < 0 || cache->entries[f].tabulated) return 0;
+    if (!cache->by_name.keys) index_symbols(cache, program);
+
+    char path[CACHE_PATH_MAX];
+    cache_path(cache, cache->entries[f].key, path);
+    long size;
+    char *text = read_file(path, &size);
+    if (text) {
+        IRFunction *fn = ir_add_function(program, node->data.function_def.func_name,
+                                         node->data.function_def.symbol,
+                                         node->data.function_def.return_type);
+        Reader r = { text, text + size, 1 };
+        int ok = parse_function(cache, &r, fn);
+        free(text);
+        if (ok) {
+            cache->hits++;
+            return 1;
+        }
+        // Archivo dañado o de otra versión: se genera otra vez y se reemplaza
+        program->function_count--;
+        ir_free_function(fn);
+    }
+
+    cache->misses++;
+    if (cache->pending_count == cache->pending_capacity) {
+        cache->pending_capacity = cache->pending_capacity ? cache->pending_capacity * 2 : 16;
+        cache->pending = (PendingStore*)realloc(cache->pending, cache->pending_capacity * sizeof(PendingStore));
+    }
+    cache->pending[cache->pending_count].function = program->function_count;
+    cache->pending[cache->pending_count].key = cache->entries[f].key;
+    cache->pending_count++;
+    return 0;
+}
+
+/* ---------- Escritura ---------- */
+
+static void write_operand(FILE *out, Operand op) {
+    switch (op.kind) {
+        case OPND_VAR:
+            fprintf(out, " v%d", op.u.var);
+            break;
+        case OPND_INT:
+            fprintf(out, " i%d", op.u.int_value);
+            break;
+        case OPND_FLOAT:
+            fprintf(out, " f%a", (double)op.u.float_value);
+            break;
+        case OPND_STRING:
+            fprintf(out, " s%zu:%s", strlen(op.u.string_value), op.u.string_value);
+            break;
+        default:
+            fputs(" -", out);
+            break;
+    }
+}
+
+static void write_function(FILE *out, IRFunction *fn) {
+    fprintf(out, "%s\nfunction %s %d %d %d %d\n", CACHE_FORMAT, fn->name,
+            fn->optimized, fn->inline_cost, fn->temp_count, fn->entry);
+
+    fprintf(out, "vars %d\n", fn->var_count);
+    for (int v = 0; v < fn->var_count; v++) {
+        IRVar *var = &fn->vars[v];
+        fprintf(out, "%d %d %d %d %s\n", var->kind, var->type, var->temp_id, var->origin,
+                var->name ? var->name : "-");
+    }
+
+    fprintf(out, "blocks %d\n", fn->block_count);
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        fprintf(out, "%d %d %d", block->term, block->succ[0], block->succ[1]);
+        write_operand(out, block->cond);
+        fprintf(out, " %d\n", block->count);
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            fprintf(out, "%d", instr->op);
+            write_operand(out, instr->dst);
+            for (int k = 0; k < 3; k++) write_operand(out, instr->src[k]);
+            fprintf(out, " %s %d", instr->callee ? instr->callee->name : "-", instr->arg_count);
+            for (int a = 0; a < instr->arg_count; a++) write_operand(out, instr->args[a]);
+            fputc('\n', out);
+        }
+    }
+
+    fprintf(out, "layout %d", fn->layout_count);
+    for (int i = 0; i < fn->layout_count; i++) fprintf(out, " %d", fn->layout[i]);
+    fputc('\n', out);
+}
+
+void cache_store_functions(CompileCache *cache, IRProgram *program) {
+    char path[CACHE_PATH_MAX];
+    char temp_path[CACHE_PATH_MAX + 48];
+    for (int i = 0; i < cache->pending_count; i++) {
+        IRFunction *fn = program->functions[cache->pending[i].function];
+        cache_path(cache, cache->pending[i].key, path);
+        // Se escribe aparte y se renombra: otra compilación nunca ve un archivo
+        // a medias. El nombre temporal distingue también las compilaciones de
+        // un mismo proceso en el modo por lotes.
+        snprintf(temp_path, sizeof(temp_path), "%s.%ld.%lx.tmp", path, (long)getpid(),
+                 (unsigned long)(uintptr_t)cache);
+        FILE *out = fopen(temp_path, "w");
+        if (!out) cache_error("No se puede escribir en la caché", temp_path);
+        write_function(out, fn);
+        if (fclose(out) != 0) cache_error("No se puede escribir en la caché", temp_path);
+        if (rename(temp_path, path) != 0) cache_error("No se puede escribir en la caché", path);
+    }
+    cache->pending_count = 0;
+}
+
+void cache_close(CompileCache *cache, int *hits, int *misses) {
+    if (!cache) return;
+    *hits = cache->hits;
+    *misses = cache->misses;
+    map_free(&cache->by_node);
+    map_free(&cache->by_name);
+    free(cache->entries);
+    free(cache->symbols);
+    free(cache->pending);
+    free(cache);
+}
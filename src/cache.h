@@ -0,0 +1,31 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "ast.h"
+#include "symtable.h"
+#include "ir.h"
+#include "codegen.h"
+
+// Caché en disco de la IR de cada función (--cache-dir). La clave de una
+// función resume su subárbol del AST, las firmas de los globales y
+// funciones que usa y, de forma transitiva, las claves de todo lo que puede
+// llamar (la expansión en línea y la evaluación en compilación leen el
+// cuerpo de los llamados). Se guarda la IR ya optimizada y no el texto
+// FIS-25 porque los temporales, las etiquetas, las ranuras y los nombres
+// calificados se numeran en todo el programa al escribirlo.
+typedef struct CompileCache CompileCache;
+
+// Calcula la clave de cada función de 'root'; crea el directorio si no existe
+CompileCache* cache_open(const char *dir, ASTNode *root, const CodeGenOptions *options);
+
+// Si la función del nodo NODE_FUNCTION_DEF está en la caché la agrega a
+// 'program' ya optimizada y devuelve 1. Si no, recuerda que la función que
+// se va a generar en su lugar debe guardarse y devuelve 0.
+int cache_load_function(CompileCache *cache, ASTNode *node, IRProgram *program);
+
+// Guarda las funciones que no estaban en la caché, después de optimizarlas
+void cache_store_functions(CompileCache *cache, IRProgram *program);
+
+void cache_close(CompileCache *cache, int *hits, int *misses);
+
+#endif
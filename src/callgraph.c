@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "callgraph.h"
+
+// Componentes fuertemente conexas (Tarjan, versión iterativa)
+void call_graph_sccs(CallGraph *graph) {
+    int n = graph->function_count;
+    int *index = (int*)malloc((n + 1) * sizeof(int));
+    int *low = (int*)malloc((n + 1) * sizeof(int));
+    int *on_stack = (int*)calloc(n + 1, sizeof(int));
+    int *stack = (int*)malloc((n + 1) * sizeof(int));
+    int *call_stack = (int*)malloc((n + 1) * sizeof(int));
+    int *next_edge = (int*)malloc((n + 1) * sizeof(int));
+    int counter = 0, top = 0, scc_count = 0;
+
+    for (int f = 0; f < n; f++) index[f] = -1;
+
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0) continue;
+
+        int depth = 0;
+        call_stack[depth++] = root;
+        index[root] = low[root] = counter++;
+        next_edge[root] = graph->callee_start[root];
+        stack[top++] = root;
+        on_stack[root] = 1;
+
+        while (depth > 0) {
+            int f = call_stack[depth - 1];
+            if (next_edge[f] < graph->callee_start[f + 1]) {
+                int g = graph->callees[next_edge[f]++];
+                if (index[g] < 0) {
+                    index[g] = low[g] = counter++;
+                    next_edge[g] = graph->callee_start[g];
+                    stack[top++] = g;
+                    on_stack[g] = 1;
+                    call_stack[depth++] = g;
+                } else if (on_stack[g] && index[g] < low[f]) {
+                    low[f] = index[g];
+                }
+                continue;
+            }
+
+            depth--;
+            if (depth > 0) {
+                int parent = call_stack[depth - 1];
+                if (low[f] < low[parent]) low[parent] = low[f];
+            }
+            if (low[f] == index[f]) {
+                int size = 0, g;
+                do {
+                    g = stack[--top];
+                    on_stack[g] = 0;
+                    graph->scc[g] = scc_count;
+                    size++;
+                } while (g != f);
+                if (size > 1) {
+                    for (int i = top; i < top + size; i++) graph->recursive[stack[i]] = 1;
+                }
+                scc_count++;
+            }
+        }
+    }
+
+    free(next_edge);
+    free(call_stack);
+    free(stack);
+    free(on_stack);
+    free(low);
+    free(index);
+}
+
+CallGraph* build_call_graph(IRProgram *program) {
+    int n = program->function_count;
+    CallGraph *graph = (CallGraph*)calloc(1, sizeof(CallGraph));
+    graph->function_count = n;
+    graph->callee_start = (int*)calloc(n + 1, sizeof(int));
+    graph->scc = (int*)malloc((n + 1) * sizeof(int));
+    graph->recursive = (int*)calloc(n + 1, sizeof(int));
+
+    for (int i = 0; i < program->global_count; i++) {
+        if (program->globals[i]->is_function) program->globals[i]->address = -1;
+    }
+    for (int f = 0; f < n; f++) {
+        if (program->functions[f]->symbol) program->functions[f]->symbol->address = f;
+    }
+
+    // Dos pasadas: contar y después llenar las listas de llamados
+    for (int pass = 0; pass < 2; pass++) {
+        int edges = 0;
+        for (int f = 0; f < n; f++) {
+            IRFunction *fn = program->functions[f];
+            if (pass == 1) graph->callee_start[f] = edges;
+            for (int b = 0; b < fn->block_count; b++) {
+                IRBlock *block = &fn->blocks[b];
+                for (int i = 0; i < block->count; i++) {
+                    if (block->instrs[i].op != IR_CALL) continue;
+                    int callee = block->instrs[i].callee->address;
+                    if (callee < 0) continue;
+                    if (pass == 1) {
+                        graph->callees[edges] = callee;
+                        if (callee == f) graph->recursive[f] = 1;
+                    }
+                    edges++;
+                }
+            }
+        }
+        if (pass == 0) {
+            graph->callees = (int*)malloc((edges + 1) * sizeof(int));
+        } else {
+            graph->callee_start[n] = edges;
+        }
+    }
+
+    call_graph_sccs(graph);
+    return graph;
+}
+
+void free_call_graph(CallGraph *graph) {
+    if (!graph) return;
+    free(graph->callee_start);
+    free(graph->callees);
+    free(graph->scc);
+    free(graph->recursive);
+    free(graph);
+}
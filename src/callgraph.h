@@ -0,0 +1,24 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "ir.h"
+
+// Grafo de llamadas entre las funciones de un programa en IR. Las funciones
+// se numeran por su posición en program->functions y el campo 'address'
+// del símbolo de cada función guarda ese número.
+typedef struct CallGraph {
+    int function_count;
+    int *callee_start;  // Llamados de f en callees[callee_start[f] .. callee_start[f + 1])
+    int *callees;
+    int *scc;           // Componente fuertemente conexa de cada función
+    int *recursive;     // 1 si la función puede volver a llamarse a sí misma
+} CallGraph;
+
+CallGraph* build_call_graph(IRProgram *program);
+// Llena 'scc' a partir de las aristas, numerando las componentes de los
+// llamados a los llamadores, y marca en 'recursive' las que tienen más de
+// una función (build_call_graph marca las que se llaman a sí mismas)
+void call_graph_sccs(CallGraph *graph);
+void free_call_graph(CallGraph *graph);
+
+#endif
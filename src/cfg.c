@@ -0,0 +1,597 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cfg.h"
+
+// Grafo en formato compacto: aristas de v en edges[start[v] .. start[v + 1])
+typedef struct Graph {
+    int n;
+    int *start;
+    int *edges;
+} Graph;
+
+static void graph_free(Graph *g) {
+    free(g->start);
+    free(g->edges);
+}
+
+// Construye el grafo de sucesores (reverse = 0) o de predecesores (reverse = 1).
+// Con 'with_exit' se agrega el nodo block_count como sucesor de los RETURN.
+static Graph build_graph(IRFunction *fn, int reverse, int with_exit) {
+    Graph g;
+    int n = fn->block_count + (with_exit ? 1 : 0);
+    int *counts = (int*)calloc(n + 1, sizeof(int));
+
+    g.n = n;
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int s = 0; s < ir_successor_count(block); s++) {
+            counts[reverse ? block->succ[s] : b]++;
+        }
+        if (with_exit && (block->term == TERM_RETURN || block->term == TERM_HALT)) {
+            counts[reverse ? fn->block_count : b]++;
+        }
+    }
+
+    g.start = (int*)malloc((n + 1) * sizeof(int));
+    g.start[0] = 0;
+    for (int v = 0; v < n; v++) {
+        g.start[v + 1] = g.start[v] + counts[v];
+        counts[v] = g.start[v];
+    }
+    g.edges = (int*)malloc((g.start[n] + 1) * sizeof(int));
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int s = 0; s < ir_successor_count(block); s++) {
+            int from = b, to = block->succ[s];
+            if (reverse) { from = to; to = b; }
+            g.edges[counts[from]++] = to;
+        }
+        if (with_exit && (block->term == TERM_RETURN || block->term == TERM_HALT)) {
+            int from = b, to = fn->block_count;
+            if (reverse) { from = to; to = b; }
+            g.edges[counts[from]++] = to;
+        }
+    }
+
+    free(counts);
+    return g;
+}
+
+// Recorrido en profundidad iterativo; deja el orden posterior inverso en 'rpo'
+static int reverse_postorder(const Graph *succ, int root, int *rpo, int *rpo_index) {
+    int n = succ->n;
+    int *stack = (int*)malloc((n + 1) * sizeof(int));
+    int *next_edge = (int*)malloc((n + 1) * sizeof(int));
+    int *post = (int*)malloc((n + 1) * sizeof(int));
+    int top = 0, count = 0;
+
+    for (int v = 0; v < n; v++) rpo_index[v] = -1;
+
+    stack[top++] = root;
+    next_edge[root] = succ->start[root];
+    rpo_index[root] = 0;
+    while (top > 0) {
+        int v = stack[top - 1];
+        if (next_edge[v] < succ->start[v + 1]) {
+            int w = succ->edges[next_edge[v]++];
+            if (rpo_index[w] < 0) {
+                rpo_index[w] = 0;
+                next_edge[w] = succ->start[w];
+                stack[top++] = w;
+            }
+        } else {
+            post[count++] = v;
+            top--;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        rpo[i] = post[count - 1 - i];
+        rpo_index[rpo[i]] = i;
+    }
+
+    free(post);
+    free(next_edge);
+    free(stack);
+    return count;
+}
+
+// Algoritmo iterativo de Cooper, Harvey y Kennedy
+static void compute_idom(const Graph *succ, const Graph *pred, int root,
+                         int *idom, int *rpo, int *rpo_count, int *rpo_index) {
+    *rpo_count = reverse_postorder(succ, root, rpo, rpo_index);
+
+    for (int v = 0; v < succ->n; v++) idom[v] = -1;
+    idom[root] = root;
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 1; i < *rpo_count; i++) {
+            int b = rpo[i];
+            int new_idom = -1;
+            for (int e = pred->start[b]; e < pred->start[b + 1]; e++) {
+                int p = pred->edges[e];
+                if (idom[p] < 0) continue;
+                if (new_idom < 0) {
+                    new_idom = p;
+                    continue;
+                }
+                int x = p, y = new_idom;
+                while (x != y) {
+                    while (rpo_index[x] > rpo_index[y]) x = idom[x];
+                    while (rpo_index[y] > rpo_index[x]) y = idom[y];
+                }
+                new_idom = x;
+            }
+            if (idom[b] != new_idom) {
+                idom[b] = new_idom;
+                changed = 1;
+            }
+        }
+    }
+}
+
+DomInfo* cfg_dominators(IRFunction *fn) {
+    int n = fn->block_count;
+    DomInfo *dom = (DomInfo*)calloc(1, sizeof(DomInfo));
+    dom->block_count = n;
+    dom->rpo = (int*)malloc((n + 1) * sizeof(int));
+    dom->rpo_index = (int*)malloc((n + 1) * sizeof(int));
+    dom->idom = (int*)malloc((n + 1) * sizeof(int));
+
+    ir_compute_preds(fn);
+    Graph succ = build_graph(fn, 0, 0);
+    Graph pred = build_graph(fn, 1, 0);
+    compute_idom(&succ, &pred, fn->entry, dom->idom, dom->rpo, &dom->rpo_count, dom->rpo_index);
+    graph_free(&succ);
+    graph_free(&pred);
+
+    // Hijos en el árbol de dominadores
+    dom->child_start = (int*)calloc(n + 2, sizeof(int));
+    dom->children = (int*)malloc((n + 1) * sizeof(int));
+    for (int b = 0; b < n; b++) {
+        if (dom->idom[b] >= 0 && b != fn->entry) dom->child_start[dom->idom[b] + 1]++;
+    }
+    for (int b = 0; b < n; b++) dom->child_start[b + 1] += dom->child_start[b];
+    int *fill = (int*)malloc((n + 1) * sizeof(int));
+    memcpy(fill, dom->child_start, (n + 1) * sizeof(int));
+    for (int i = 0; i < dom->rpo_count; i++) {
+        int b = dom->rpo[i];
+        if (b != fn->entry) dom->children[fill[dom->idom[b]]++] = b;
+    }
+    free(fill);
+
+    // Numeración del árbol para consultas de dominancia en O(1)
+    dom->pre = (int*)malloc((n + 1) * sizeof(int));
+    dom->post = (int*)malloc((n + 1) * sizeof(int));
+    int *stack = (int*)malloc((n + 1) * sizeof(int));
+    int *next_child = (int*)malloc((n + 1) * sizeof(int));
+    int top = 0, clock = 0;
+    for (int b = 0; b < n; b++) dom->pre[b] = dom->post[b] = -1;
+    stack[top++] = fn->entry;
+    next_child[fn->entry] = dom->child_start[fn->entry];
+    dom->pre[fn->entry] = clock++;
+    while (top > 0) {
+        int b = stack[top - 1];
+        if (next_child[b] < dom->child_start[b + 1]) {
+            int c = dom->children[next_child[b]++];
+            dom->pre[c] = clock++;
+            next_child[c] = dom->child_start[c];
+            stack[top++] = c;
+        } else {
+            dom->post[b] = clock++;
+            top--;
+        }
+    }
+    free(next_child);
+    free(stack);
+
+    return dom;
+}
+
+int cfg_dominates(const DomInfo *dom, int a, int b) {
+    if (dom->pre[a] < 0 || dom->pre[b] < 0) return 0;
+    return dom->pre[a] <= dom->pre[b] && dom->post[b] <= dom->post[a];
+}
+
+void cfg_free_dominators(DomInfo *dom) {
+    if (!dom) return;
+    free(dom->rpo);
+    free(dom->rpo_index);
+    free(dom->idom);
+    free(dom->child_start);
+    free(dom->children);
+    free(dom->pre);
+    free(dom->post);
+    free(dom);
+}
+
+typedef struct LoopBuild {
+    int header;
+    int *blocks;
+    int count;
+} LoopBuild;
+
+static int compare_loop_size(const void *a, const void *b) {
+    const LoopBuild *x = (const LoopBuild*)a;
+    const LoopBuild *y = (const LoopBuild*)b;
+    if (x->count != y->count) return x->count - y->count;
+    return x->header - y->header;
+}
+
+LoopInfo* cfg_find_loops(IRFunction *fn, const DomInfo *dom) {
+    int n = fn->block_count;
+    LoopBuild *found = (LoopBuild*)malloc((n + 1) * sizeof(LoopBuild));
+    int found_count = 0, total = 0;
+    int *stamp = (int*)malloc((n + 1) * sizeof(int));
+    int *work = (int*)malloc((n + 1) * sizeof(int));
+    for (int b = 0; b < n; b++) stamp[b] = -1;
+
+    // Cada arista t -> h con h dominando a t cierra un lazo; su cuerpo son
+    // los bloques que llegan a t sin pasar por h
+    for (int i = 0; i < dom->rpo_count; i++) {
+        int h = dom->rpo[i];
+        IRBlock *header = &fn->blocks[h];
+        int top = 0, count = 0;
+
+        for (int p = 0; p < header->pred_count; p++) {
+            int t = header->preds[p];
+            if (dom->rpo_index[t] >= 0 && cfg_dominates(dom, h, t) && stamp[t] != h) {
+                stamp[t] = h;
+                work[top++] = t;
+            }
+        }
+        if (top == 0) continue;
+
+        if (stamp[h] != h) {
+            stamp[h] = h;
+            count++;
+        }
+        while (top > 0) {
+            int b = work[--top];
+            count++;
+            if (b == h) continue;
+            IRBlock *block = &fn->blocks[b];
+            for (int p = 0; p < block->pred_count; p++) {
+                int q = block->preds[p];
+                if (dom->rpo_index[q] >= 0 && stamp[q] != h) {
+                    stamp[q] = h;
+                    work[top++] = q;
+                }
+            }
+        }
+
+        int *blocks = (int*)malloc(count * sizeof(int));
+        int filled = 0;
+        for (int j = i; filled < count; j++) {
+            if (stamp[dom->rpo[j]] == h) blocks[filled++] = dom->rpo[j];
+        }
+        found[found_count].header = h;
+        found[found_count].blocks = blocks;
+        found[found_count].count = count;
+        found_count++;
+        total += count;
+    }
+
+    // Un lazo interno tiene menos bloques que los que lo contienen
+    qsort(found, found_count, sizeof(LoopBuild), compare_loop_size);
+
+    LoopInfo *loops = (LoopInfo*)calloc(1, sizeof(LoopInfo));
+    loops->loop_count = found_count;
+    loops->header = (int*)malloc((found_count + 1) * sizeof(int));
+    loops->preheader = (int*)malloc((found_count + 1) * sizeof(int));
+    loops->block_start = (int*)malloc((found_count + 1) * sizeof(int));
+    loops->blocks = (int*)malloc((total + 1) * sizeof(int));
+
+    int position = 0;
+    for (int l = 0; l < found_count; l++) {
+        int h = found[l].header;
+        loops->header[l] = h;
+        loops->block_start[l] = position;
+        for (int i = 0; i < found[l].count; i++) {
+            stamp[found[l].blocks[i]] = -2 - l;
+            loops->blocks[position++] = found[l].blocks[i];
+        }
+
+        int outside = -1, outside_count = 0;
+        IRBlock *header = &fn->blocks[h];
+        for (int p = 0; p < header->pred_count; p++) {
+            if (stamp[header->preds[p]] != -2 - l) {
+                outside = header->preds[p];
+                outside_count++;
+            }
+        }
+        loops->preheader[l] = (outside_count == 1 &&
+                               ir_successor_count(&fn->blocks[outside]) == 1) ? outside : -1;
+        free(found[l].blocks);
+    }
+    loops->block_start[found_count] = position;
+
+    free(found);
+    free(stamp);
+    free(work);
+    return loops;
+}
+
+void cfg_free_loops(LoopInfo *loops) {
+    if (!loops) return;
+    free(loops->header);
+    free(loops->preheader);
+    free(loops->block_start);
+    free(loops->blocks);
+    free(loops);
+}
+
+int cfg_loop_declarations(IRFunction *fn) {
+    DomInfo *dom = cfg_dominators(fn);
+    LoopInfo *loops = cfg_find_loops(fn, dom);
+    int count = 0;
+
+    for (int i = 0; i < loops->block_start[loops->loop_count]; i++) {
+        IRBlock *block = &fn->blocks[loops->blocks[i]];
+        for (int j = 0; j < block->count; j++) {
+            if (block->instrs[j].op == IR_VAR) count++;
+        }
+    }
+
+    cfg_free_loops(loops);
+    cfg_free_dominators(dom);
+    return count;
+}
+
+int* cfg_postdominators(IRFunction *fn) {
+    int n = fn->block_count + 1;
+    int *ipdom = (int*)malloc(n * sizeof(int));
+    int *rpo = (int*)malloc(n * sizeof(int));
+    int *rpo_index = (int*)malloc(n * sizeof(int));
+    int rpo_count;
+
+    // Dominadores del grafo invertido, con raíz en la salida virtual
+    Graph reverse_succ = build_graph(fn, 1, 1);
+    Graph reverse_pred = build_graph(fn, 0, 1);
+    compute_idom(&reverse_succ, &reverse_pred, fn->block_count, ipdom, rpo, &rpo_count, rpo_index);
+    graph_free(&reverse_succ);
+    graph_free(&reverse_pred);
+
+    free(rpo);
+    free(rpo_index);
+    return ipdom;
+}
+
+static void clear_block(IRFunction *fn, int b) {
+    IRBlock *block = &fn->blocks[b];
+    for (int i = 0; i < block->count; i++) {
+        free(block->instrs[i].args);
+        free(block->instrs[i].arg_blocks);
+    }
+    block->count = 0;
+    ir_set_return(fn, b);
+}
+
+int cfg_remove_unreachable(IRFunction *fn) {
+    int *reachable = ir_reachable_blocks(fn);
+    int removed = 0;
+
+    for (int b = 0; b < fn->block_count; b++) {
+        if (!reachable[b] && (fn->blocks[b].count > 0 || fn->blocks[b].term != TERM_RETURN)) {
+            clear_block(fn, b);
+            removed++;
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < fn->layout_count; i++) {
+        if (reachable[fn->layout[i]]) fn->layout[kept++] = fn->layout[i];
+    }
+    fn->layout_count = kept;
+
+    free(reachable);
+    return removed;
+}
+
+// Coloca 'block' justo antes de 'before' en el orden de salida
+static void place_before(IRFunction *fn, int block, int before) {
+    ir_place_block(fn, block);
+    int pos = fn->layout_count - 1;
+    while (pos > 0 && fn->layout[pos - 1] != before) {
+        fn->layout[pos] = fn->layout[pos - 1];
+        pos--;
+    }
+    if (pos == 0) {
+        // 'before' no está colocado: el bloque queda al final
+        memmove(&fn->layout[0], &fn->layout[1], (fn->layout_count - 1) * sizeof(int));
+        fn->layout[fn->layout_count - 1] = block;
+        return;
+    }
+    fn->layout[pos] = fn->layout[pos - 1];
+    fn->layout[pos - 1] = block;
+}
+
+int cfg_split_critical_edges(IRFunction *fn) {
+    int split = 0;
+    int original_count = fn->block_count;
+
+    ir_compute_preds(fn);
+    for (int b = 0; b < original_count; b++) {
+        if (fn->blocks[b].term != TERM_BRANCH) continue;
+        for (int s = 0; s < 2; s++) {
+            int target = fn->blocks[b].succ[s];
+            if (fn->blocks[target].pred_count < 2) continue;
+
+            int middle = ir_new_block(fn);
+            ir_set_goto(fn, middle, target);
+            fn->blocks[b].succ[s] = middle;
+            place_before(fn, middle, target);
+            split++;
+        }
+    }
+
+    ir_compute_preds(fn);
+    return split;
+}
+
+// Destino final de un salto que atraviesa bloques vacíos
+static int jump_target(IRFunction *fn, int target) {
+    for (int steps = 0; steps < fn->block_count; steps++) {
+        IRBlock *block = &fn->blocks[target];
+        if (block->count > 0 || block->term != TERM_GOTO || block->succ[0] == target ||
+            target == fn->entry) {
+            break;
+        }
+        target = block->succ[0];
+    }
+    return target;
+}
+
+int cfg_simplify(IRFunction *fn) {
+    int total = 0;
+    int changed = 1;
+
+    while (changed) {
+        changed = 0;
+
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+
+            if (block->term == TERM_BRANCH) {
+                Operand cond = block->cond;
+                if (cond.kind == OPND_INT || cond.kind == OPND_FLOAT) {
+                    int taken = cond.kind == OPND_INT ? cond.u.int_value != 0 : cond.u.float_value != 0.0f;
+                    ir_set_goto(fn, b, taken ? block->succ[0] : block->succ[1]);
+                    changed++;
+                } else if (block->succ[0] == block->succ[1]) {
+                    ir_set_goto(fn, b, block->succ[0]);
+                    changed++;
+                }
+            }
+
+            for (int s = 0; s < ir_successor_count(block); s++) {
+                int target = jump_target(fn, block->succ[s]);
+                if (target != block->succ[s]) {
+                    block->succ[s] = target;
+                    changed++;
+                }
+            }
+        }
+
+        cfg_remove_unreachable(fn);
+        ir_compute_preds(fn);
+
+        // Une cada bloque con su sucesor cuando es el único camino hacia él
+        for (int b = 0; b < fn->block_count; b++) {
+            while (fn->blocks[b].term == TERM_GOTO) {
+                int t = fn->blocks[b].succ[0];
+                if (t == b || t == fn->entry || fn->blocks[t].pred_count != 1) break;
+
+                for (int i = 0; i < fn->blocks[t].count; i++) {
+                    *ir_append(fn, b, IR_NOP) = fn->blocks[t].instrs[i];
+                }
+                IRBlock *block = &fn->blocks[b];
+                IRBlock *target = &fn->blocks[t];
+                block->term = target->term;
+                block->cond = target->cond;
+                block->succ[0] = target->succ[0];
+                block->succ[1] = target->succ[1];
+
+                // 't' deja de existir: sus sucesores ahora vienen de 'b'
+                for (int s = 0; s < ir_successor_count(block); s++) {
+                    IRBlock *succ = &fn->blocks[block->succ[s]];
+                    for (int p = 0; p < succ->pred_count; p++) {
+                        if (succ->preds[p] == t) succ->preds[p] = b;
+                    }
+                }
+                target->count = 0;
+                target->pred_count = 0;
+                ir_set_return(fn, t);
+                changed++;
+            }
+        }
+
+        cfg_remove_unreachable(fn);
+        total += changed;
+    }
+
+    ir_compute_preds(fn);
+    return total;
+}
+
+static int is_own_var(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    if (kind == IRVAR_RETURN) return fn->vars[var].symbol == fn->symbol;
+    return kind != IRVAR_GLOBAL;
+}
+
+static void read_var(IRFunction *fn, const char *assigned, int *unassigned, Operand op) {
+    if (op.kind == OPND_VAR && is_own_var(fn, op.u.var) && !assigned[op.u.var]) {
+        unassigned[op.u.var] = 1;
+    }
+}
+
+int* cfg_unassigned_reads(IRFunction *fn) {
+    int n = fn->var_count;
+    int *reachable = ir_reachable_blocks(fn);
+    int *unassigned = (int*)calloc(n + 1, sizeof(int));
+    char *out = (char*)malloc((size_t)fn->block_count * n + 1);
+    char *assigned = (char*)malloc(n + 1);
+
+    ir_compute_preds(fn);
+    memset(out, 1, (size_t)fn->block_count * n);
+
+    // Variables escritas en todo camino hasta la salida de cada bloque. Los
+    // conjuntos empiezan llenos y solo se achican; las lecturas que se marcan
+    // en la última pasada, ya sin cambios, son las que valen.
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        memset(unassigned, 0, n * sizeof(int));
+        for (int b = 0; b < fn->block_count; b++) {
+            if (!reachable[b]) continue;
+            IRBlock *block = &fn->blocks[b];
+            if (b == fn->entry) {
+                memset(assigned, 0, n);
+            } else {
+                memset(assigned, 1, n);
+                for (int p = 0; p < block->pred_count; p++) {
+                    int pred = block->preds[p];
+                    if (!reachable[pred]) continue;
+                    for (int v = 0; v < n; v++) assigned[v] &= out[(size_t)pred * n + v];
+                }
+            }
+
+            for (int i = 0; i < block->count; i++) {
+                IRInstr *instr = &block->instrs[i];
+                for (int k = 0; k < ir_use_count(instr); k++) {
+                    read_var(fn, assigned, unassigned, *ir_use_at(instr, k));
+                }
+                int def = ir_instr_def(instr);
+                if (def >= 0) assigned[def] = 1;
+                // Una llamada recursiva deja escrito el ret_ propio, si todo
+                // RETURN lo escribe (lo que esta misma pasada comprueba)
+                if (instr->op == IR_CALL && instr->callee == fn->symbol) {
+                    for (int v = 0; v < n; v++) {
+                        if (fn->vars[v].kind == IRVAR_RETURN && fn->vars[v].symbol == fn->symbol) assigned[v] = 1;
+                    }
+                }
+            }
+            if (block->term == TERM_BRANCH) read_var(fn, assigned, unassigned, block->cond);
+            if (block->term == TERM_RETURN && fn->symbol) {
+                for (int v = 0; v < n; v++) {
+                    if (fn->vars[v].kind == IRVAR_RETURN) read_var(fn, assigned, unassigned, ir_var(v));
+                }
+            }
+
+            if (memcmp(&out[(size_t)b * n], assigned, n) != 0) {
+                memcpy(&out[(size_t)b * n], assigned, n);
+                changed = 1;
+            }
+        }
+    }
+
+    free(out);
+    free(assigned);
+    free(reachable);
+    return unassigned;
+}
@@ -0,0 +1,66 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "ir.h"
+
+// Análisis y transformaciones del grafo de flujo de control de una función
+
+// Árbol de dominadores (Cooper, Harvey y Kennedy)
+typedef struct DomInfo {
+    int block_count;
+    int *rpo;           // Bloques alcanzables en orden posterior inverso
+    int rpo_count;
+    int *rpo_index;     // Posición de cada bloque en 'rpo'; -1 si es inalcanzable
+    int *idom;          // Dominador inmediato; la entrada es su propio idom
+    int *child_start;   // Hijos de b en children[child_start[b] .. child_start[b + 1])
+    int *children;
+    int *pre;           // Intervalo [pre, post] de cada bloque en el árbol
+    int *post;
+} DomInfo;
+
+// Calcula también los predecesores (ir_compute_preds)
+DomInfo* cfg_dominators(IRFunction *fn);
+int cfg_dominates(const DomInfo *dom, int a, int b);
+void cfg_free_dominators(DomInfo *dom);
+
+// Lazos naturales, uno por cabecera, de los más internos a los externos
+typedef struct LoopInfo {
+    int loop_count;
+    int *header;
+    int *preheader;     // Único predecesor de fuera del lazo, con un solo sucesor; -1 si no hay
+    int *block_start;   // Bloques del lazo l en blocks[block_start[l] .. block_start[l + 1]),
+    int *blocks;        // en orden posterior inverso (la cabecera primero)
+} LoopInfo;
+
+// Usa los predecesores que dejó cfg_dominators
+LoopInfo* cfg_find_loops(IRFunction *fn, const DomInfo *dom);
+void cfg_free_loops(LoopInfo *loops);
+
+// Instrucciones VAR dentro de algún lazo (un bloque que está en varios lazos
+// cuenta una vez por lazo). Las declaraciones van en el prólogo: debe ser 0.
+int cfg_loop_declarations(IRFunction *fn);
+
+// Postdominador inmediato de cada bloque; 'block_count' es la salida
+// virtual (sucesora de todos los RETURN y de las paradas). Los bloques que
+// no llegan a la salida quedan en -1.
+int* cfg_postdominators(IRFunction *fn);
+
+// Vacía los bloques inalcanzables y los quita del orden de salida
+int cfg_remove_unreachable(IRFunction *fn);
+
+// Parte las aristas de un bloque con dos sucesores hacia uno con varios
+// predecesores, para poder colocar copias en ellas
+int cfg_split_critical_edges(IRFunction *fn);
+
+// Resuelve saltos con condición constante, salta por encima de bloques
+// vacíos y une bloques en línea recta. No admite nodos phi.
+int cfg_simplify(IRFunction *fn);
+
+// Marca con 1 las variables propias (locales, parámetros, temporales y el
+// ret_ de la función) que algún camino lee antes de escribir. Un RETURN lee
+// ret_<función> y una llamada a la función misma lo escribe. FIS-25 no
+// borra una variable al declararla, así que esas lecturas ven el valor de
+// la llamada anterior (el llamador libera).
+int* cfg_unassigned_reads(IRFunction *fn);
+
+#endif
@@ -1,313 +1,785 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
 #include "codegen.h"
+#include "diag.h"
+#include "cfg.h"
+#include "cache.h"
+#include "bytecode.h"
 
 static void gen_statement(ASTNode *node, CodeGenContext *ctx);
-static char* gen_expression(ASTNode *expr, CodeGenContext *ctx);
+static Operand gen_expression(ASTNode *expr, CodeGenContext *ctx);
+static void gen_expression_into(ASTNode *expr, CodeGenContext *ctx, Operand dest);
 static void gen_param_gets(ASTNode *param, CodeGenContext *ctx);
-static const char* get_func_label(const char *name);
-static const char* get_func_ret_var(const char *name);
+static void gen_branch(ASTNode *expr, CodeGenContext *ctx, int when, int target);
+static void branch_if_false(CodeGenContext *ctx, Operand cond, int target);
 
-void emit(CodeGenContext *ctx, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    vfprintf(ctx->output, format, args);
-    va_end(args);
-    fprintf(ctx->output, "\n");
+// Tabla símbolo -> variable de la función actual (direccionamiento abierto)
+static unsigned symbol_hash(Symbol *sym) {
+    return (unsigned)(((uintptr_t)sym >> 4) * 2654435761u);
 }
 
-char* gen_temp_register(CodeGenContext *ctx) {
-    static char buffer[32];
-    snprintf(buffer, sizeof(buffer), "_t%d", ctx->next_temp++);
-    return strdup(buffer);
+static int var_map_find(VarMap *map, Symbol *sym) {
+    if (map->capacity == 0) return -1;
+    unsigned mask = (unsigned)map->capacity - 1;
+    for (unsigned i = symbol_hash(sym) & mask; map->keys[i]; i = (i + 1) & mask) {
+        if (map->keys[i] == sym) return map->values[i];
+    }
+    return -1;
 }
 
-char* gen_label(CodeGenContext *ctx) {
-    static char buffer[32];
-    snprintf(buffer, sizeof(buffer), "L%d", ctx->next_label++);
-    return strdup(buffer);
+static void var_map_put(VarMap *map, Symbol *sym, int var) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        Symbol **old_keys = map->keys;
+        int *old_values = map->values;
+        int old_capacity = map->capacity;
+
+        map->capacity = old_capacity ? old_capacity * 2 : 64;
+        map->keys = (Symbol**)calloc(map->capacity, sizeof(Symbol*));
+        map->values = (int*)malloc(map->capacity * sizeof(int));
+        map->count = 0;
+        for (int i = 0; i < old_capacity; i++) {
+            if (old_keys[i]) var_map_put(map, old_keys[i], old_values[i]);
+        }
+        free(old_keys);
+        free(old_values);
+    }
+
+    unsigned mask = (unsigned)map->capacity - 1;
+    unsigned i = symbol_hash(sym) & mask;
+    while (map->keys[i]) i = (i + 1) & mask;
+    map->keys[i] = sym;
+    map->values[i] = var;
+    map->count++;
 }
 
-static const char* get_func_label(const char *name) {
-    static char buffer[128];
-    snprintf(buffer, sizeof(buffer), "func_%s", name);
-    return buffer;
+static void var_map_clear(VarMap *map) {
+    if (map->keys) memset(map->keys, 0, map->capacity * sizeof(Symbol*));
+    map->count = 0;
 }
 
-static const char* get_func_ret_var(const char *name) {
-    static char buffer[128];
-    snprintf(buffer, sizeof(buffer), "ret_%s", name);
-    return buffer;
+// Variable de la función actual para un símbolo. Un símbolo de función
+// representa su valor de retorno (ret_<nombre>).
+static int var_for_symbol(CodeGenContext *ctx, Symbol *sym) {
+    int var = var_map_find(&ctx->vars, sym);
+    if (var >= 0) return var;
+
+    IRVarKind kind;
+    DataType type = sym->type;
+    if (sym->is_function) {
+        kind = IRVAR_RETURN;
+        type = sym->return_type;
+    } else if (sym->scope_level == 0) {
+        kind = IRVAR_GLOBAL;
+    } else {
+        kind = IRVAR_LOCAL;
+    }
+
+    var = ir_add_var(ctx->fn, kind, sym->name, sym, type);
+    var_map_put(&ctx->vars, sym, var);
+    return var;
 }
 
-static char* gen_expression(ASTNode *expr, CodeGenContext *ctx) {
-    if (!expr) return NULL;
+static IRInstr* emit(CodeGenContext *ctx, IROp op) {
+    return ir_append(ctx->fn, ctx->block, op);
+}
 
-    char *result = NULL;
+// Continúa la generación en 'block', colocado después del bloque actual
+static void start_block(CodeGenContext *ctx, int block) {
+    ir_place_block(ctx->fn, block);
+    ctx->block = block;
+}
 
-    switch (expr->type) {
-        case NODE_INT_LITERAL: {
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
-            emit(ctx, "ASSIGN %d %s", expr->data.int_value, result);
-            break;
-        }
+// Cada función usa su propio conjunto de temporales, para que ninguno quede
+// compartido entre una llamada y la función que la hizo
+static void reset_temp_pool(CodeGenContext *ctx) {
+    TempPool *pool = &ctx->temps;
+    if (pool->peak_live > ctx->stats.temps_peak_live) {
+        ctx->stats.temps_peak_live = pool->peak_live;
+    }
+    pool->free_count = 0;
+    pool->live = 0;
+    pool->peak_live = 0;
+}
 
-        case NODE_FLOAT_LITERAL: {
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
-            emit(ctx, "ASSIGN %f %s", expr->data.float_value, result);
-            break;
-        }
+static void begin_function(CodeGenContext *ctx, const char *name, Symbol *sym, DataType return_type) {
+    ctx->fn = ir_add_function(ctx->program, name, sym, return_type);
+    ctx->block = ctx->fn->entry;
+    ir_place_block(ctx->fn, ctx->block);
+    var_map_clear(&ctx->vars);
+    reset_temp_pool(ctx);
+    ctx->bounds_fail = -1;
+}
 
-        case NODE_BOOL_LITERAL: {
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
-            emit(ctx, "ASSIGN %d %s", expr->data.bool_value, result);
-            break;
-        }
+static void end_function(CodeGenContext *ctx) {
+    // Los bloques nuevos terminan en RETURN: la función no cae en la siguiente.
+    // Las declaraciones van al prólogo, fuera de cualquier lazo: ningún salto
+    // vuelve a la entrada.
+    if (ctx->bounds_fail >= 0) ir_place_block(ctx->fn, ctx->bounds_fail);
+    ir_declare_locals(ctx->fn);
+    reset_temp_pool(ctx);
+    ctx->fn = NULL;
+}
 
-        case NODE_STRING_LITERAL: {
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
-            emit(ctx, "ASSIGN %s %s", expr->data.string_value, result);
-            break;
-        }
+// Las sentencias fuera de funciones van a un bloque sin etiqueta, como antes
+static void ensure_function(CodeGenContext *ctx) {
+    if (!ctx->fn) {
+        begin_function(ctx, NULL, NULL, TYPE_VOID);
+    }
+}
+
+// Devuelve un temporal libre del mismo tipo (o uno nuevo); su VAR va en el
+// prólogo de la función
+Operand gen_temp_register(CodeGenContext *ctx, DataType type) {
+    TempPool *pool = &ctx->temps;
+    int var = -1;
 
-        case NODE_IDENTIFIER: {
-            result = strdup(expr->data.identifier);
+    for (int i = pool->free_count - 1; i >= 0; i--) {
+        if (ctx->fn->vars[pool->free_ids[i]].type == type) {
+            var = pool->free_ids[i];
+            pool->free_ids[i] = pool->free_ids[--pool->free_count];
             break;
         }
-        
+    }
+    if (var < 0) {
+        var = ir_add_var(ctx->fn, IRVAR_TEMP, NULL, NULL, type);
+        ctx->stats.temps_total++;
+    }
+
+    pool->live++;
+    if (pool->live > pool->peak_live) {
+        pool->peak_live = pool->live;
+    }
+    ctx->stats.temps_requested++;
+    return ir_var(var);
+}
+
+// Devuelve el temporal al pool tras su último uso; ignora variables y constantes
+void release_temp(CodeGenContext *ctx, Operand operand) {
+    if (operand.kind != OPND_VAR || ctx->fn->vars[operand.u.var].kind != IRVAR_TEMP) return;
+
+    TempPool *pool = &ctx->temps;
+    if (pool->free_count == pool->free_capacity) {
+        pool->free_capacity = pool->free_capacity ? pool->free_capacity * 2 : 16;
+        pool->free_ids = (int*)realloc(pool->free_ids, pool->free_capacity * sizeof(int));
+    }
+    pool->free_ids[pool->free_count++] = operand.u.var;
+    pool->live--;
+}
+
+static int contains_call(ASTNode *expr) {
+    if (!expr) return 0;
+
+    switch (expr->type) {
+        case NODE_FUNCTION_CALL:
+            return 1;
+        case NODE_BINOP:
+            return contains_call(expr->data.binop.left) || contains_call(expr->data.binop.right);
+        case NODE_UNOP:
+            return contains_call(expr->data.unop.operand);
+        case NODE_ARRAY_ACCESS:
+            return contains_call(expr->data.array_access.index);
+        default:
+            return 0;
+    }
+}
+
+static int args_contain_call(ASTNode *arg) {
+    for (; arg; arg = arg->data.argument.next) {
+        if (contains_call(arg->data.argument.expression)) return 1;
+    }
+    return 0;
+}
+
+// Expresiones que pueden detener la máquina o tener efectos: el lado derecho
+// de && y || solo se evalúa si hace falta
+static int needs_short_circuit(ASTNode *expr) {
+    if (!expr) return 0;
+
+    switch (expr->type) {
+        case NODE_FUNCTION_CALL:
+            return 1;
+        case NODE_BINOP:
+            if ((expr->data.binop.op == OP_DIV || expr->data.binop.op == OP_MOD) &&
+                (expr->data.binop.right->type != NODE_INT_LITERAL ||
+                 expr->data.binop.right->data.int_value == 0)) {
+                return 1;
+            }
+            return needs_short_circuit(expr->data.binop.left) ||
+                   needs_short_circuit(expr->data.binop.right);
+        case NODE_UNOP:
+            return needs_short_circuit(expr->data.unop.operand);
+        case NODE_ARRAY_ACCESS:
+            return expr->data.array_access.index->type != NODE_INT_LITERAL;
+        default:
+            return 0;
+    }
+}
+
+static int is_comparison(BinaryOperator op) {
+    return op == OP_EQ || op == OP_NE || op == OP_LT || op == OP_GT || op == OP_LE || op == OP_GE;
+}
+
+// Comparación que es verdadera exactamente cuando 'op' es falsa
+static IROp inverse_comparison(BinaryOperator op) {
+    switch (op) {
+        case OP_EQ: return IR_NE;
+        case OP_NE: return IR_EQ;
+        case OP_LT: return IR_GE;
+        case OP_GT: return IR_LE;
+        case OP_LE: return IR_GT;
+        default: return IR_LT;
+    }
+}
+
+static IROp binary_op(BinaryOperator op) {
+    switch (op) {
+        case OP_ADD: return IR_ADD;
+        case OP_SUB: return IR_SUB;
+        case OP_MUL: return IR_MUL;
+        case OP_DIV: return IR_DIV;
+        case OP_MOD: return IR_MOD;
+        case OP_EQ: return IR_EQ;
+        case OP_NE: return IR_NE;
+        case OP_LT: return IR_LT;
+        case OP_GT: return IR_GT;
+        case OP_LE: return IR_LE;
+        case OP_GE: return IR_GE;
+        case OP_AND: return IR_AND;
+        default: return IR_OR;
+    }
+}
+
+// --- Arrays ---
+// FIS-25 no tiene memoria indexada: cada elemento es una variable propia
+// (Symbol.elements). Con un índice constante se usa el elemento directamente;
+// con uno variable se comprueba el rango y una búsqueda binaria sobre el
+// índice lleva a la hoja que lee o escribe cada elemento. El análisis de
+// rangos (range.c) quita las comprobaciones que el programa ya garantiza.
+
+// Símbolo del array en a.length o a[i].length
+static Symbol* length_symbol(ASTNode *expr) {
+    ASTNode *array = expr->data.length.array;
+    if (array->type == NODE_ARRAY_ACCESS) return array->data.array_access.symbol;
+    return array->data.identifier.symbol;
+}
+
+// Elemento de un acceso con índice constante
+static Symbol* constant_element(ASTNode *access) {
+    Symbol *sym = access->data.array_access.symbol;
+    int index = access->data.array_access.index->data.int_value;
+    if (index < 0 || index >= sym->array_size) {
+        compile_error("Error: índice %d fuera del rango de '%s' (tamaño %d)\n",
+                      index, sym->name, sym->array_size);
+    }
+    return &sym->elements[index];
+}
+
+// Bloque compartido por la función que avisa y detiene la máquina
+static int bounds_fail_block(CodeGenContext *ctx) {
+    if (ctx->bounds_fail < 0) {
+        ctx->bounds_fail = ir_new_block(ctx->fn);
+        IRInstr *print = ir_append(ctx->fn, ctx->bounds_fail, IR_PRINT);
+        print->src[0] = ir_string("\"Error: índice fuera de rango\"");
+        ir_set_halt(ctx->fn, ctx->bounds_fail);
+    }
+    return ctx->bounds_fail;
+}
+
+// IFFALSE (index op bound) GOTO target
+static void branch_unless(CodeGenContext *ctx, IROp op, Operand index, int bound, int target) {
+    Operand cond = gen_temp_register(ctx, TYPE_BOOL);
+    IRInstr *instr = emit(ctx, op);
+    instr->dst = cond;
+    instr->src[0] = index;
+    instr->src[1] = ir_int(bound);
+    branch_if_false(ctx, cond, target);
+}
+
+// Búsqueda binaria sobre los elementos [low, high]; cada hoja copia
+// 'value' al elemento ('store') o el elemento a 'value' y salta a 'join'
+static void gen_element_search(CodeGenContext *ctx, Symbol *sym, Operand index, Operand value,
+                               int store, int low, int high, int join) {
+    if (low == high) {
+        Operand element = ir_var(var_for_symbol(ctx, &sym->elements[low]));
+        IRInstr *assign = emit(ctx, IR_ASSIGN);
+        assign->dst = store ? element : value;
+        assign->src[0] = store ? value : element;
+        ir_set_goto(ctx->fn, ctx->block, join);
+        return;
+    }
+
+    int mid = (low + high + 1) / 2;
+    int above = ir_new_block(ctx->fn);
+    branch_unless(ctx, IR_LT, index, mid, above);
+    gen_element_search(ctx, sym, index, value, store, low, mid - 1, join);
+    start_block(ctx, above);
+    gen_element_search(ctx, sym, index, value, store, mid, high, join);
+}
+
+// Acceso con índice variable: fuera de [0, tamaño) la máquina se detiene
+static void gen_element_access(CodeGenContext *ctx, Symbol *sym, Operand index, Operand value, int store) {
+    int fail = bounds_fail_block(ctx);
+    ctx->stats.bounds_checks++;
+    if (sym->array_size == 0) {
+        ir_set_goto(ctx->fn, ctx->block, fail);
+        start_block(ctx, ir_new_block(ctx->fn));
+        return;
+    }
+
+    int join = ir_new_block(ctx->fn);
+    branch_unless(ctx, IR_GE, index, 0, fail);
+    branch_unless(ctx, IR_LT, index, sym->array_size, fail);
+    gen_element_search(ctx, sym, index, value, store, 0, sym->array_size - 1, join);
+    start_block(ctx, join);
+}
+
+// Selección de instrucciones por patrones sobre el árbol de expresiones:
+// - hojas (literales y variables) se usan directamente como operandos
+// - una operación con hojas como hijos se emite en una sola instrucción
+// - el resultado de la raíz se escribe directo en el destino de la sentencia
+
+// Operando inmediato o variable para una hoja; OPND_NONE si el nodo no es hoja
+static Operand gen_leaf(ASTNode *expr, CodeGenContext *ctx) {
+    switch (expr->type) {
+        case NODE_INT_LITERAL:
+            return ir_int(expr->data.int_value);
+        case NODE_FLOAT_LITERAL:
+            return ir_float(expr->data.float_value);
+        case NODE_BOOL_LITERAL:
+            return ir_int(expr->data.bool_value ? 1 : 0);
+        case NODE_STRING_LITERAL:
+            return ir_string(expr->data.string_value);
+        case NODE_IDENTIFIER:
+            return ir_var(var_for_symbol(ctx, expr->data.identifier.symbol));
+        case NODE_ARRAY_ACCESS:
+            if (expr->data.array_access.index->type != NODE_INT_LITERAL) return ir_none();
+            return ir_var(var_for_symbol(ctx, constant_element(expr)));
+        case NODE_LENGTH:
+            // El índice de a[i].length no se evalúa
+            return ir_int(length_symbol(expr)->array_size);
+        default:
+            return ir_none();
+    }
+}
+
+// Emite la operación de 'expr' con resultado en 'dest'. Si 'dest' es
+// OPND_NONE se toma un temporal después de evaluar los operandos.
+static Operand gen_operation(ASTNode *expr, CodeGenContext *ctx, Operand dest) {
+    switch (expr->type) {
         case NODE_ARRAY_ACCESS: {
-            fprintf(stderr, "Error: acceso a arrays no soportado en esta versión del generador de código\n");
-            exit(1);
+            Symbol *sym = expr->data.array_access.symbol;
+            Operand index = gen_expression(expr->data.array_access.index, ctx);
+            if (dest.kind == OPND_NONE) dest = gen_temp_register(ctx, sym->type);
+            gen_element_access(ctx, sym, index, dest, 0);
+            release_temp(ctx, index);
+            return dest;
         }
-        
+
         case NODE_BINOP: {
-            char *left = gen_expression(expr->data.binop.left, ctx);
-            char *right = gen_expression(expr->data.binop.right, ctx);
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
-            
-            switch (expr->data.binop.op) {
-                case OP_ADD:
-                    emit(ctx, "ADD %s %s %s", left, right, result);
-                    break;
-                case OP_SUB:
-                    emit(ctx, "SUB %s %s %s", left, right, result);
-                    break;
-                case OP_MUL:
-                    emit(ctx, "MUL %s %s %s", left, right, result);
-                    break;
-                case OP_DIV:
-                    emit(ctx, "DIV %s %s %s", left, right, result);
-                    break;
-                case OP_MOD:
-                    emit(ctx, "MOD %s %s %s", left, right, result);
-                    break;
-                case OP_EQ:
-                    emit(ctx, "EQ %s %s %s", left, right, result);
-                    break;
-                case OP_NE:
-                    emit(ctx, "NEQ %s %s %s", left, right, result);
-                    break;
-                case OP_LT:
-                    emit(ctx, "LT %s %s %s", left, right, result);
-                    break;
-                case OP_GT:
-                    emit(ctx, "GT %s %s %s", left, right, result);
-                    break;
-                case OP_LE:
-                    emit(ctx, "LTE %s %s %s", left, right, result);
-                    break;
-                case OP_GE:
-                    emit(ctx, "GTE %s %s %s", left, right, result);
-                    break;
-                case OP_AND:
-                    emit(ctx, "AND %s %s %s", left, right, result);
-                    break;
-                case OP_OR:
-                    emit(ctx, "OR %s %s %s", left, right, result);
-                    break;
+            BinaryOperator op = expr->data.binop.op;
+            if ((op == OP_AND || op == OP_OR) && needs_short_circuit(expr->data.binop.right)) {
+                // El resultado se arma en un temporal propio: 'dest' puede
+                // leerse en el lado derecho
+                Operand value = gen_temp_register(ctx, TYPE_BOOL);
+                int right_block = ir_new_block(ctx->fn);
+                int end_block = ir_new_block(ctx->fn);
+                gen_expression_into(expr->data.binop.left, ctx, value);
+                if (op == OP_AND) {
+                    ir_set_branch(ctx->fn, ctx->block, value, right_block, end_block);
+                } else {
+                    ir_set_branch(ctx->fn, ctx->block, value, end_block, right_block);
+                }
+                start_block(ctx, right_block);
+                gen_expression_into(expr->data.binop.right, ctx, value);
+                ir_set_goto(ctx->fn, ctx->block, end_block);
+                start_block(ctx, end_block);
+                if (dest.kind == OPND_NONE) return value;
+
+                IRInstr *assign = emit(ctx, IR_ASSIGN);
+                assign->dst = dest;
+                assign->src[0] = value;
+                release_temp(ctx, value);
+                return dest;
             }
-            break;
+
+            Operand left = gen_expression(expr->data.binop.left, ctx);
+            Operand right = gen_expression(expr->data.binop.right, ctx);
+            if (dest.kind == OPND_NONE) dest = gen_temp_register(ctx, expr->data_type);
+
+            IRInstr *instr = emit(ctx, binary_op(op));
+            instr->dst = dest;
+            instr->src[0] = left;
+            instr->src[1] = right;
+            release_temp(ctx, left);
+            release_temp(ctx, right);
+            return dest;
         }
-        
+
         case NODE_UNOP: {
-            char *operand = gen_expression(expr->data.unop.operand, ctx);
-            result = gen_temp_register(ctx);
-            emit(ctx, "VAR %s", result);
+            Operand operand = gen_expression(expr->data.unop.operand, ctx);
+            if (dest.kind == OPND_NONE) dest = gen_temp_register(ctx, expr->data_type);
+
+            IRInstr *instr;
             switch (expr->data.unop.op) {
                 case OP_NEG:
-                    emit(ctx, "SUB 0 %s %s", operand, result);
+                    instr = emit(ctx, IR_SUB);
+                    instr->src[0] = ir_int(0);
+                    instr->src[1] = operand;
                     break;
-                case OP_NOT:
-                    emit(ctx, "EQ %s 0 %s", operand, result);
+                default:
+                    instr = emit(ctx, IR_EQ);
+                    instr->src[0] = operand;
+                    instr->src[1] = ir_int(0);
                     break;
             }
-            break;
+            instr->dst = dest;
+            release_temp(ctx, operand);
+            return dest;
         }
-        
-        case NODE_LENGTH: {
-            fprintf(stderr, "Error: operador .length no soportado en esta versión del generador de código\n");
-            exit(1);
-        }
-        
+
         case NODE_FUNCTION_CALL: {
-            ASTNode *arg = expr->data.function_call.arguments;
-            while (arg) {
-                char *arg_val = gen_expression(arg->data.argument.expression, ctx);
-                emit(ctx, "PARAM %s", arg_val);
-                arg = arg->data.argument.next;
+            // Los argumentos están en orden de apilado (el último primero)
+            int count = 0;
+            for (ASTNode *arg = expr->data.function_call.arguments; arg; arg = arg->data.argument.next) {
+                count++;
+            }
+
+            Operand *args = count ? (Operand*)malloc(count * sizeof(Operand)) : NULL;
+            int i = 0;
+            for (ASTNode *arg = expr->data.function_call.arguments; arg; arg = arg->data.argument.next) {
+                Operand value = gen_expression(arg->data.argument.expression, ctx);
+                // PARAM se escribe junto al GOSUB: si un argumento posterior
+                // llama a una función, la variable se copia antes de que cambie
+                if (value.kind == OPND_VAR && ctx->fn->vars[value.u.var].kind != IRVAR_TEMP &&
+                    args_contain_call(arg->data.argument.next)) {
+                    Operand copy = gen_temp_register(ctx, arg->data.argument.expression->data_type);
+                    IRInstr *assign = emit(ctx, IR_ASSIGN);
+                    assign->dst = copy;
+                    assign->src[0] = value;
+                    value = copy;
+                }
+                args[i++] = value;
             }
 
-            const char *label = get_func_label(expr->data.function_call.func_name);
-            emit(ctx, "GOSUB %s", label);
+            Symbol *sym = expr->data.function_call.symbol;
+            IRInstr *call = emit(ctx, IR_CALL);
+            call->callee = sym;
+            call->args = args;
+            call->arg_count = count;
+            for (i = 0; i < count; i++) {
+                release_temp(ctx, args[i]);
+            }
 
-            Symbol *sym = lookup_symbol(ctx->symtable, expr->data.function_call.func_name);
-            if (sym && sym->is_function && sym->return_type != TYPE_VOID) {
-                const char *ret_var = get_func_ret_var(expr->data.function_call.func_name);
-                result = gen_temp_register(ctx);
-                emit(ctx, "VAR %s", result);
-                emit(ctx, "ASSIGN %s %s", ret_var, result);
-            } else {
-                result = NULL;
+            if (sym->return_type == TYPE_VOID) {
+                return ir_none();
+            }
+            if (dest.kind == OPND_NONE) dest = gen_temp_register(ctx, sym->return_type);
+            IRInstr *assign = emit(ctx, IR_ASSIGN);
+            assign->dst = dest;
+            assign->src[0] = ir_var(var_for_symbol(ctx, sym));
+            return dest;
+        }
+
+        default:
+            return ir_none();
+    }
+}
+
+// Devuelve el operando con el valor de 'expr' (inmediato, variable o temporal)
+static Operand gen_expression(ASTNode *expr, CodeGenContext *ctx) {
+    if (!expr) return ir_none();
+
+    Operand leaf = gen_leaf(expr, ctx);
+    if (leaf.kind != OPND_NONE) return leaf;
+    return gen_operation(expr, ctx, ir_none());
+}
+
+// Evalúa 'expr' dejando el resultado directamente en la variable 'dest'
+static void gen_expression_into(ASTNode *expr, CodeGenContext *ctx, Operand dest) {
+    Operand leaf = gen_leaf(expr, ctx);
+    if (leaf.kind != OPND_NONE) {
+        IRInstr *instr = emit(ctx, IR_ASSIGN);
+        instr->dst = dest;
+        instr->src[0] = leaf;
+    } else {
+        gen_operation(expr, ctx, dest);
+    }
+}
+
+// IFFALSE cond GOTO target; la generación sigue en un bloque nuevo
+static void branch_if_false(CodeGenContext *ctx, Operand cond, int target) {
+    int next = ir_new_block(ctx->fn);
+    ir_set_branch(ctx->fn, ctx->block, cond, next, target);
+    release_temp(ctx, cond);
+    start_block(ctx, next);
+}
+
+// Código de saltos para condiciones: salta a 'target' si 'expr' vale 'when'
+// y si no sigue en un bloque nuevo. && y || se evalúan en cortocircuito y
+// una comparación va directo al IFFALSE, invertida cuando hay que saltar si
+// es verdadera, sin un booleano intermedio que combinar o negar.
+static void gen_branch(ASTNode *expr, CodeGenContext *ctx, int when, int target) {
+    switch (expr->type) {
+        case NODE_BOOL_LITERAL:
+            if (expr->data.bool_value == when) {
+                int next = ir_new_block(ctx->fn);
+                ir_set_goto(ctx->fn, ctx->block, target);
+                start_block(ctx, next);
+            }
+            return;
+
+        case NODE_UNOP:
+            if (expr->data.unop.op == OP_NOT) {
+                gen_branch(expr->data.unop.operand, ctx, !when, target);
+                return;
+            }
+            break;
+
+        case NODE_BINOP: {
+            BinaryOperator op = expr->data.binop.op;
+            if (op == OP_AND || op == OP_OR) {
+                // a && b es falso en cuanto a lo es; a || b, verdadero
+                int decided = op == OP_OR;
+                if (when == decided) {
+                    gen_branch(expr->data.binop.left, ctx, when, target);
+                    gen_branch(expr->data.binop.right, ctx, when, target);
+                } else {
+                    int skip = ir_new_block(ctx->fn);
+                    gen_branch(expr->data.binop.left, ctx, decided, skip);
+                    gen_branch(expr->data.binop.right, ctx, when, target);
+                    ir_set_goto(ctx->fn, ctx->block, skip);
+                    start_block(ctx, skip);
+                }
+                return;
+            }
+            if (is_comparison(op)) {
+                Operand left = gen_expression(expr->data.binop.left, ctx);
+                Operand right = gen_expression(expr->data.binop.right, ctx);
+                Operand cond = gen_temp_register(ctx, TYPE_BOOL);
+                IRInstr *instr = emit(ctx, when ? inverse_comparison(op) : binary_op(op));
+                instr->dst = cond;
+                instr->src[0] = left;
+                instr->src[1] = right;
+                release_temp(ctx, left);
+                release_temp(ctx, right);
+                branch_if_false(ctx, cond, target);
+                return;
             }
             break;
         }
-        
+
         default:
             break;
     }
-    
-    return result;
+
+    Operand value = gen_expression(expr, ctx);
+    if (when) {
+        Operand cond = gen_temp_register(ctx, TYPE_BOOL);
+        IRInstr *instr = emit(ctx, IR_EQ);
+        instr->dst = cond;
+        instr->src[0] = value;
+        instr->src[1] = ir_int(0);
+        release_temp(ctx, value);
+        value = cond;
+    }
+    branch_if_false(ctx, value, target);
+}
+
+// Bucle rotado: la condición se prueba una vez antes de entrar y otra al
+// final de cada vuelta, donde un solo IFFALSE regresa al cuerpo en lugar
+// de un IFFALSE al inicio más un GOTO al final
+static void gen_loop(ASTNode *condition, ASTNode *body, ASTNode *increment, CodeGenContext *ctx) {
+    int body_block = ir_new_block(ctx->fn);
+    int end_block = ir_new_block(ctx->fn);
+
+    gen_branch(condition, ctx, 0, end_block);
+    ir_set_goto(ctx->fn, ctx->block, body_block);
+    start_block(ctx, body_block);
+    gen_statement(body, ctx);
+    gen_statement(increment, ctx);
+    gen_branch(condition, ctx, 1, body_block);
+    ir_set_goto(ctx->fn, ctx->block, end_block);
+    start_block(ctx, end_block);
+}
+
+// Los valores se asignan en el orden en que se escribieron; la lista de la
+// gramática está invertida
+static void gen_array_init(ASTNode *node, CodeGenContext *ctx) {
+    Symbol *sym = node->data.array_decl.symbol;
+    ASTNode **values = (ASTNode**)malloc((sym->array_size + 1) * sizeof(ASTNode*));
+    int i = sym->array_size;
+    for (ASTNode *elem = node->data.array_decl.elements; elem; elem = elem->data.argument.next) {
+        values[--i] = elem->data.argument.expression;
+    }
+    for (i = 0; i < sym->array_size; i++) {
+        gen_expression_into(values[i], ctx, ir_var(var_for_symbol(ctx, &sym->elements[i])));
+    }
+    free(values);
+}
+
+// Arrays declarados fuera de funciones, en orden de declaración
+static void collect_global_arrays(ASTNode *node, CodeGenContext *ctx) {
+    if (!node) return;
+    if (node->type == NODE_STATEMENT_LIST) {
+        collect_global_arrays(node->data.stmt_list.statement, ctx);
+        collect_global_arrays(node->data.stmt_list.next, ctx);
+        return;
+    }
+    if (node->type != NODE_ARRAY_DECLARATION) return;
+    ctx->global_arrays = (ASTNode**)realloc(ctx->global_arrays,
+                                            (ctx->global_array_count + 1) * sizeof(ASTNode*));
+    ctx->global_arrays[ctx->global_array_count++] = node;
 }
 
 static void gen_statement(ASTNode *node, CodeGenContext *ctx) {
     if (!node) return;
-    
+
+    switch (node->type) {
+        case NODE_STATEMENT_LIST:
+        case NODE_DECLARATION:
+        case NODE_ARRAY_DECLARATION:
+        case NODE_FUNCTION_DEF:
+            break;
+        default:
+            ensure_function(ctx);
+            break;
+    }
+
     switch (node->type) {
         case NODE_STATEMENT_LIST:
             gen_statement(node->data.stmt_list.statement, ctx);
             gen_statement(node->data.stmt_list.next, ctx);
             break;
-            
+
         case NODE_DECLARATION: {
             if (ctx->current_function) {
-                emit(ctx, "VAR %s", node->data.declaration.var_name);
+                Operand var = ir_var(var_for_symbol(ctx, node->data.declaration.symbol));
                 if (node->data.declaration.init_value) {
-                    char *value = gen_expression(node->data.declaration.init_value, ctx);
-                    emit(ctx, "ASSIGN %s %s", value, node->data.declaration.var_name);
+                    gen_expression_into(node->data.declaration.init_value, ctx, var);
                 }
             } else {
                 if (node->data.declaration.init_value) {
-                    fprintf(stderr, "Error: inicialización global no soportada en esta versión del generador de código\n");
-                    exit(1);
+                    compile_error("Error: inicialización global no soportada en esta versión del generador de código\n");
                 }
             }
             break;
         }
-        
-        case NODE_ARRAY_DECLARATION: {
-            fprintf(stderr, "Error: declaración de arrays no soportada en esta versión del generador de código\n");
-            exit(1);
-        }
-        
+
+        case NODE_ARRAY_DECLARATION:
+            // Los arrays globales se inicializan al entrar a main
+            if (ctx->current_function) gen_array_init(node, ctx);
+            break;
+
         case NODE_ASSIGNMENT: {
-            char *value = gen_expression(node->data.assignment.value, ctx);
-            emit(ctx, "ASSIGN %s %s", value, node->data.assignment.var_name);
+            gen_expression_into(node->data.assignment.value, ctx,
+                                ir_var(var_for_symbol(ctx, node->data.assignment.symbol)));
             break;
         }
-        
+
         case NODE_ARRAY_ASSIGNMENT: {
-            fprintf(stderr, "Error: asignación a arrays no soportada en esta versión del generador de código\n");
-            exit(1);
+            ASTNode *access = node->data.array_assign.array_access;
+            ASTNode *value_expr = node->data.array_assign.value;
+            if (access->data.array_access.index->type == NODE_INT_LITERAL) {
+                gen_expression_into(value_expr, ctx, ir_var(var_for_symbol(ctx, constant_element(access))));
+                break;
+            }
+
+            Operand index = gen_expression(access->data.array_access.index, ctx);
+            // Una llamada en el valor podría cambiar la variable del índice
+            if (index.kind == OPND_VAR && ctx->fn->vars[index.u.var].kind != IRVAR_TEMP &&
+                contains_call(value_expr)) {
+                Operand copy = gen_temp_register(ctx, TYPE_INT);
+                IRInstr *assign = emit(ctx, IR_ASSIGN);
+                assign->dst = copy;
+                assign->src[0] = index;
+                index = copy;
+            }
+            Operand value = gen_expression(value_expr, ctx);
+            gen_element_access(ctx, access->data.array_access.symbol, index, value, 1);
+            release_temp(ctx, index);
+            release_temp(ctx, value);
+            break;
         }
-        
+
         case NODE_IF: {
-            char *cond = gen_expression(node->data.if_stmt.condition, ctx);
-            char *else_label = gen_label(ctx);
-            char *end_label = gen_label(ctx);
+            int end_block = ir_new_block(ctx->fn);
+            int else_block = node->data.if_stmt.else_branch ? ir_new_block(ctx->fn) : end_block;
 
+            gen_branch(node->data.if_stmt.condition, ctx, 0, else_block);
+            gen_statement(node->data.if_stmt.then_branch, ctx);
             if (node->data.if_stmt.else_branch) {
-                emit(ctx, "IFFALSE %s GOTO %s", cond, else_label);
-                gen_statement(node->data.if_stmt.then_branch, ctx);
-                emit(ctx, "GOTO %s", end_label);
-                emit(ctx, "LABEL %s", else_label);
+                ir_set_goto(ctx->fn, ctx->block, end_block);
+                start_block(ctx, else_block);
                 gen_statement(node->data.if_stmt.else_branch, ctx);
-                emit(ctx, "LABEL %s", end_label);
-            } else {
-                emit(ctx, "IFFALSE %s GOTO %s", cond, end_label);
-                gen_statement(node->data.if_stmt.then_branch, ctx);
-                emit(ctx, "LABEL %s", end_label);
             }
+            ir_set_goto(ctx->fn, ctx->block, end_block);
+            start_block(ctx, end_block);
             break;
         }
-        
-        case NODE_WHILE: {
-            char *start_label = gen_label(ctx);
-            char *end_label = gen_label(ctx);
-            
-            emit(ctx, "LABEL %s", start_label);
-            char *cond = gen_expression(node->data.while_stmt.condition, ctx);
-            emit(ctx, "IFFALSE %s GOTO %s", cond, end_label);
-            gen_statement(node->data.while_stmt.body, ctx);
-            emit(ctx, "GOTO %s", start_label);
-            emit(ctx, "LABEL %s", end_label);
+
+        case NODE_WHILE:
+            gen_loop(node->data.while_stmt.condition, node->data.while_stmt.body, NULL, ctx);
             break;
-        }
-        
-        case NODE_FOR: {
-            char *start_label = gen_label(ctx);
-            char *end_label = gen_label(ctx);
-            
+
+        case NODE_FOR:
             gen_statement(node->data.for_stmt.init, ctx);
-            emit(ctx, "LABEL %s", start_label);
-            char *cond = gen_expression(node->data.for_stmt.condition, ctx);
-            emit(ctx, "IFFALSE %s GOTO %s", cond, end_label);
-            gen_statement(node->data.for_stmt.body, ctx);
-            gen_statement(node->data.for_stmt.increment, ctx);
-            emit(ctx, "GOTO %s", start_label);
-            emit(ctx, "LABEL %s", end_label);
+            gen_loop(node->data.for_stmt.condition, node->data.for_stmt.body,
+                     node->data.for_stmt.increment, ctx);
             break;
-        }
-        
+
         case NODE_FUNCTION_DEF: {
-            const char *func_name = node->data.function_def.func_name;
-            const char *label = get_func_label(func_name);
+            // Las sentencias sueltas anteriores quedan en su propio bloque
+            if (ctx->fn) end_function(ctx);
+            if (ctx->cache && cache_load_function(ctx->cache, node, ctx->program)) break;
 
-            emit(ctx, "");
-            emit(ctx, "LABEL %s", label);
+            Symbol *sym = node->data.function_def.symbol;
+            begin_function(ctx, node->data.function_def.func_name, sym,
+                           node->data.function_def.return_type);
+            ctx->current_function = node->data.function_def.func_name;
+            ctx->current_return_type = node->data.function_def.return_type;
 
             ASTNode *param = node->data.function_def.parameters;
             while (param) {
-                emit(ctx, "VAR %s", param->data.parameter.param_name);
+                Symbol *param_sym = param->data.parameter.symbol;
+                int var = ir_add_var(ctx->fn, IRVAR_PARAM, param_sym->name, param_sym, param_sym->type);
+                var_map_put(&ctx->vars, param_sym, var);
                 param = param->data.parameter.next;
             }
 
-            ctx->current_function = func_name;
-            ctx->current_return_type = node->data.function_def.return_type;
-
             gen_param_gets(node->data.function_def.parameters, ctx);
+            if (strcmp(node->data.function_def.func_name, "main") == 0) {
+                for (int i = 0; i < ctx->global_array_count; i++) {
+                    gen_array_init(ctx->global_arrays[i], ctx);
+                }
+            }
             gen_statement(node->data.function_def.body, ctx);
 
             ctx->current_function = NULL;
             ctx->current_return_type = TYPE_VOID;
+            end_function(ctx);
             break;
         }
-        
+
         case NODE_PIXEL: {
-            char *x = gen_expression(node->data.pixel.x, ctx);
-            char *y = gen_expression(node->data.pixel.y, ctx);
-            char *c = gen_expression(node->data.pixel.color, ctx);
-            emit(ctx, "PIXEL %s %s %s", x, y, c);
+            Operand x = gen_expression(node->data.pixel.x, ctx);
+            Operand y = gen_expression(node->data.pixel.y, ctx);
+            Operand c = gen_expression(node->data.pixel.color, ctx);
+            IRInstr *instr = emit(ctx, IR_PIXEL);
+            instr->src[0] = x;
+            instr->src[1] = y;
+            instr->src[2] = c;
+            release_temp(ctx, x);
+            release_temp(ctx, y);
+            release_temp(ctx, c);
             break;
         }
-        
+
         case NODE_KEY: {
+            Operand key_val;
             if (node->data.key.key_code->type == NODE_INT_LITERAL) {
                 int code = node->data.key.key_code->data.int_value;
                 int mapped = code;
@@ -320,42 +792,47 @@ static void gen_statement(ASTNode *node, CodeGenContext *ctx) {
                     case 32: mapped = 8; break;  /* Space */
                     default: mapped = code; break;
                 }
-                emit(ctx, "KEY %d %s", mapped, node->data.key.dest_var);
+                key_val = ir_int(mapped);
             } else {
-                char *key_val = gen_expression(node->data.key.key_code, ctx);
-                emit(ctx, "KEY %s %s", key_val, node->data.key.dest_var);
+                key_val = gen_expression(node->data.key.key_code, ctx);
             }
+            IRInstr *instr = emit(ctx, IR_KEY);
+            instr->dst = ir_var(var_for_symbol(ctx, node->data.key.dest_symbol));
+            instr->src[0] = key_val;
+            release_temp(ctx, key_val);
             break;
         }
-        
+
         case NODE_INPUT: {
-            emit(ctx, "INPUT %s", node->data.input.input_var);
+            emit(ctx, IR_INPUT)->dst = ir_var(var_for_symbol(ctx, node->data.input.symbol));
             break;
         }
-        
+
         case NODE_PRINT: {
-            char *value = gen_expression(node->data.print.expression, ctx);
-            emit(ctx, "PRINT %s", value);
+            Operand value = gen_expression(node->data.print.expression, ctx);
+            emit(ctx, IR_PRINT)->src[0] = value;
+            release_temp(ctx, value);
             break;
         }
-        
+
         case NODE_RETURN: {
-            if (node->data.return_stmt.return_value) {
-                char *ret_val = gen_expression(node->data.return_stmt.return_value, ctx);
-                if (ctx->current_function && ctx->current_return_type != TYPE_VOID) {
-                    const char *ret_var = get_func_ret_var(ctx->current_function);
-                    emit(ctx, "ASSIGN %s %s", ret_val, ret_var);
-                }
+            ASTNode *value = node->data.return_stmt.return_value;
+            if (value && ctx->current_function && ctx->current_return_type != TYPE_VOID) {
+                gen_expression_into(value, ctx, ir_var(var_for_symbol(ctx, ctx->fn->symbol)));
+            } else if (value) {
+                release_temp(ctx, gen_expression(value, ctx));
             }
-            emit(ctx, "RETURN");
+            ir_set_return(ctx->fn, ctx->block);
+            // Lo que siga al return queda en un bloque inalcanzable
+            start_block(ctx, ir_new_block(ctx->fn));
             break;
         }
 
         case NODE_FUNCTION_CALL: {
-            (void)gen_expression(node, ctx);
+            release_temp(ctx, gen_expression(node, ctx));
             break;
         }
-        
+
         default:
             break;
     }
@@ -364,45 +841,103 @@ static void gen_statement(ASTNode *node, CodeGenContext *ctx) {
 static void gen_param_gets(ASTNode *param, CodeGenContext *ctx) {
     if (!param) return;
     gen_param_gets(param->data.parameter.next, ctx);
-    emit(ctx, "PARAM_GET %s", param->data.parameter.param_name);
+    emit(ctx, IR_PARAM_GET)->dst = ir_var(var_for_symbol(ctx, param->data.parameter.symbol));
+}
+
+static double elapsed_ms(struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double ms = (now.tv_sec - since->tv_sec) * 1000.0 + (now.tv_nsec - since->tv_nsec) / 1e6;
+    *since = now;
+    return ms;
+}
+
+// Libera la IR y el resto de lo que reserva generate_code. Si un error
+// interrumpe la compilación en el modo por lotes, la llama compile_error.
+static void release_codegen(void *data) {
+    CodeGenContext *ctx = (CodeGenContext*)data;
+    int hits, misses;
+    cache_close(ctx->cache, &hits, &misses);
+    ir_free_program(ctx->program);
+    free(ctx->vars.keys);
+    free(ctx->vars.values);
+    free(ctx->temps.free_ids);
+    free(ctx->global_arrays);
 }
 
-void generate_code(ASTNode *root, FILE *output, SymbolTable *table) {
+void generate_code(ASTNode *root, FILE *output, SymbolTable *table,
+                   const CodeGenOptions *options, CodeGenStats *stats) {
     CodeGenContext ctx;
-    ctx.output = output;
-    ctx.next_temp = 0;
-    ctx.next_label = 0;
-    ctx.var_offset = 0;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.program = ir_create_program(table);
+    diag_on_recover(release_codegen, &ctx);
     ctx.symtable = table;
     ctx.current_function = NULL;
     ctx.current_return_type = TYPE_VOID;
+    ctx.bounds_fail = -1;
 
-    emit(&ctx, "; Código generado por el compilador FIS-25");
-    emit(&ctx, "; Arquitectura: FIS-25");
+    struct timespec clock;
+    clock_gettime(CLOCK_MONOTONIC, &clock);
 
-    for (int i = 0; i < MAX_SYMBOLS; i++) {
-        Symbol *sym = table->symbols[i];
-        while (sym) {
-            if (sym->is_function) {
-                if (sym->return_type != TYPE_VOID) {
-                    const char *ret_var = get_func_ret_var(sym->name);
-                    emit(&ctx, "VAR %s", ret_var);
-                }
-            } else if (!sym->is_array) {
-                emit(&ctx, "VAR %s", sym->name);
-            }
-            sym = sym->next;
+    collect_global_arrays(root, &ctx);
+    if (options && options->cache_dir) ctx.cache = cache_open(options->cache_dir, root, options);
+    gen_statement(root, &ctx);
+    if (ctx.fn) end_function(&ctx);
+
+    ir_qualify_names(ctx.program);
+    ctx.stats.lower_ms = elapsed_ms(&clock);
+    for (int t = 0; options && t < options->table_count; t++) {
+        tabulate_function(ctx.program, &options->tables[t], &ctx.stats.opt);
+    }
+    if (options && options->optimize) {
+        optimize_program(ctx.program, options->inline_limit, options->threads, &ctx.stats.opt);
+    }
+    if (ctx.cache) cache_store_functions(ctx.cache, ctx.program);
+    ctx.stats.optimize_ms = elapsed_ms(&clock);
+
+    for (int f = 0; f < ctx.program->function_count; f++) {
+        IRFunction *fn = ctx.program->functions[f];
+        if (cfg_loop_declarations(fn) > 0) {
+            fprintf(stderr, "Error interno: VAR dentro de un lazo en %s\n",
+                    fn->name ? fn->name : "las sentencias globales");
+            exit(1);
+        }
+    }
+
+    ctx.stats.ir = ir_collect_stats(ctx.program);
+    if (options && options->emit == EMIT_C) {
+        ctx.stats.instructions = ir_print_c_program(ctx.program, output);
+        ctx.stats.print_ms = elapsed_ms(&clock);
+    } else {
+        // Todo el texto se arma en memoria y se escribe con un solo write
+        OutBuffer text;
+        out_init(&text);
+        ctx.stats.instructions = ir_print_program(ctx.program, &text, options ? options->threads : 1);
+        // El binario se ensambla desde el mismo texto: los dos formatos
+        // describen siempre el mismo programa
+        OutBuffer binary;
+        out_init(&binary);
+        if (options && options->emit == EMIT_BIN) bytecode_assemble(&text, &binary);
+        OutBuffer *result = options && options->emit == EMIT_BIN ? &binary : &text;
+        ctx.stats.print_ms = elapsed_ms(&clock);
+        fflush(output);
+        int write_error = out_write(result, fileno(output)) != 0 ? errno : 0;
+        ctx.stats.write_ms = elapsed_ms(&clock);
+        ctx.stats.print_ms += ctx.stats.write_ms;
+        ctx.stats.output_bytes = result->length;
+        out_free(&binary);
+        out_free(&text);
+        if (write_error) {
+            compile_error("Error: No se puede escribir la salida: %s\n", strerror(write_error));
         }
     }
 
-    emit(&ctx, "");
-    emit(&ctx, "GOSUB func_main");
-    char *end_label = gen_label(&ctx);
-    emit(&ctx, "LABEL %s", end_label);
-    emit(&ctx, "GOTO %s", end_label);
-    emit(&ctx, "");
+    cache_close(ctx.cache, &ctx.stats.cache_hits, &ctx.stats.cache_misses);
+    ctx.cache = NULL;
+    if (stats) {
+        *stats = ctx.stats;
+    }
 
-    gen_statement(root, &ctx);
-    
-    emit(&ctx, "; Fin del programa");
+    diag_on_recover(NULL, NULL);
+    release_codegen(&ctx);
 }
@@ -4,24 +4,87 @@
 #include <stdio.h>
 #include "ast.h"
 #include "symtable.h"
+#include "ir.h"
+#include "opt.h"
 
-// Contexto de generación de código
+// Estadísticas de la generación de código
+typedef struct CodeGenStats {
+    int instructions;       // Instrucciones FIS-25 emitidas (sentencias con --emit=c)
+    int temps_requested;    // Temporales pedidos por las expresiones
+    int temps_total;        // Temporales distintos declarados con VAR
+    int temps_peak_live;    // Máximo de temporales vivos a la vez en una función
+    int bounds_checks;      // Accesos a arrays con índice variable (llevan comprobación)
+    int cache_hits;         // Funciones cargadas de la caché (--cache-dir)
+    int cache_misses;       // Funciones generadas y guardadas en la caché
+    double lower_ms;        // Tiempo de cada etapa, en milisegundos de reloj
+    double optimize_ms;
+    double print_ms;        // Incluye write_ms
+    double write_ms;        // Solo el write() de la salida FIS-25 o binaria
+    size_t output_bytes;    // Tamaño de la salida FIS-25 o binaria
+    IRStats ir;             // Tamaño de la IR antes de escribirla
+    OptStats opt;           // Optimizaciones aplicadas a la IR
+} CodeGenStats;
+
+// Formato de salida
+typedef enum {
+    EMIT_FIS25,             // Ensamblador FIS-25
+    EMIT_C,                 // C portable para compilar con gcc
+    EMIT_BIN                // FIS-25 binario (bytecode.h)
+} EmitFormat;
+
+// Opciones de la generación de código
+typedef struct CodeGenOptions {
+    int optimize;           // Optimiza la IR de cada función (-O0 lo desactiva)
+    int inline_limit;       // Crecimiento máximo por llamada expandida; 0 no expande
+    EmitFormat emit;
+    const TableSpec *tables; // Funciones a tabular (--table)
+    int table_count;
+    const char *cache_dir;  // Caché de la IR de cada función; NULL sin caché
+    int threads;            // Hilos para optimizar y escribir las funciones (--threads)
+} CodeGenOptions;
+
+// Temporales libres de la función actual. Cada temporal se usa una sola vez,
+// así que queda libre en cuanto se emite la instrucción que lo consume.
+typedef struct TempPool {
+    int *free_ids;          // Índices de variables IRVAR_TEMP
+    int free_count;
+    int free_capacity;
+    int live;
+    int peak_live;
+} TempPool;
+
+// Símbolo -> variable de la función que se está bajando a IR
+typedef struct VarMap {
+    Symbol **keys;
+    int *values;
+    int capacity;
+    int count;
+} VarMap;
+
+// Contexto de generación de código: el AST se baja a la IR de la función
+// actual y al final ir_print_program escribe el texto FIS-25
 typedef struct CodeGenContext {
-    FILE *output;
-    int next_temp;      // Siguiente variable temporal
-    int next_label;     // Siguiente etiqueta
-    int var_offset;     // Reservado (no usado actualmente)
+    IRProgram *program;
+    IRFunction *fn;         // NULL fuera de funciones
+    int block;              // Bloque donde se agregan instrucciones
     SymbolTable *symtable;
     const char *current_function;
     DataType current_return_type;
+    VarMap vars;
+    TempPool temps;
+    int bounds_fail;        // Bloque que detiene la máquina por un índice fuera de rango; -1 si no hay
+    ASTNode **global_arrays; // Arrays globales: se inicializan al entrar a main
+    int global_array_count;
+    struct CompileCache *cache; // NULL sin --cache-dir
+    CodeGenStats stats;
 } CodeGenContext;
 
 // Funciones principales
-void generate_code(ASTNode *root, FILE *output, SymbolTable *table);
+void generate_code(ASTNode *root, FILE *output, SymbolTable *table,
+                   const CodeGenOptions *options, CodeGenStats *stats);
 
 // Funciones auxiliares
-char* gen_temp_register(CodeGenContext *ctx);
-char* gen_label(CodeGenContext *ctx);
-void emit(CodeGenContext *ctx, const char *format, ...);
+Operand gen_temp_register(CodeGenContext *ctx, DataType type);
+void release_temp(CodeGenContext *ctx, Operand operand);
 
 #endif
@@ -0,0 +1,471 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Evaluación en compilación de llamadas con argumentos constantes. La
+// llamada se ejecuta sobre la IR del llamado con la semántica de la
+// máquina virtual y, si termina dentro del presupuesto, se sustituye por
+// la copia de su resultado en ret_<llamado>.
+//
+// Una función se puede evaluar si no tiene efectos visibles: la ejecución
+// se abandona al llegar a PIXEL, KEY, INPUT o PRINT, al escribir o leer un
+// global, al leer una variable que no se escribió durante la evaluación
+// (conservaría el valor de una llamada anterior) o ante un error de la
+// máquina (división entre cero, índice fuera de rango, ...), que se deja
+// para la ejecución. Como las variables de FIS-25 son globales, una
+// llamada recursiva pisa las del llamador igual que en la máquina.
+
+typedef enum {
+    EVAL_INT,
+    EVAL_FLOAT,
+    EVAL_STRING
+} EvalKind;
+
+typedef struct EvalValue {
+    EvalKind kind;
+    int i;
+    double f;
+    const char *s;
+} EvalValue;
+
+// Variable FIS-25: un global o ret_ por su símbolo, una local o parámetro
+// por función y nombre (ir_qualify_names los hace únicos), un temporal por
+// función y número
+typedef struct EvalKey {
+    const void *owner;
+    const void *name;
+    int id;
+} EvalKey;
+
+typedef struct EvalSlot {
+    EvalKey key;
+    EvalValue value;
+    int used;
+} EvalSlot;
+
+typedef struct EvalState {
+    IRProgram *program;
+    EvalSlot *vars;
+    int var_capacity;
+    int var_count;
+    EvalValue *params;
+    int param_count;
+    int param_capacity;
+    int steps;
+    int depth;
+    int out_of_budget;
+    signed char *evaluable; // Por función: 1 sí, 0 no, -1 sin calcular
+    int *exhausted;         // Funciones que agotaron el presupuesto en esta búsqueda
+    int exhausted_count;
+} EvalState;
+
+static EvalKey var_key(IRFunction *fn, int var) {
+    IRVar *v = &fn->vars[var];
+    EvalKey key;
+    switch (v->kind) {
+        case IRVAR_GLOBAL:
+        case IRVAR_RETURN:
+            key.owner = NULL;
+            key.name = v->symbol;
+            key.id = v->kind;
+            break;
+        case IRVAR_TEMP:
+            key.owner = fn;
+            key.name = NULL;
+            key.id = v->temp_id;
+            break;
+        default:
+            key.owner = fn;
+            key.name = v->name;
+            key.id = -1;
+            break;
+    }
+    return key;
+}
+
+static unsigned key_hash(EvalKey key) {
+    size_t h = (size_t)key.owner * 31u + (size_t)key.name;
+    h = h * 31u + (unsigned)key.id;
+    return (unsigned)(h ^ (h >> 16));
+}
+
+static int key_equal(EvalKey a, EvalKey b) {
+    return a.owner == b.owner && a.name == b.name && a.id == b.id;
+}
+
+static EvalSlot* find_slot(EvalState *st, EvalKey key) {
+    unsigned mask = st->var_capacity - 1;
+    unsigned slot = key_hash(key) & mask;
+    while (st->vars[slot].used && !key_equal(st->vars[slot].key, key)) slot = (slot + 1) & mask;
+    return &st->vars[slot];
+}
+
+static void store(EvalState *st, EvalKey key, EvalValue value) {
+    if (2 * (st->var_count + 1) > st->var_capacity) {
+        EvalSlot *old = st->vars;
+        int old_capacity = st->var_capacity;
+        st->var_capacity *= 2;
+        st->vars = (EvalSlot*)calloc(st->var_capacity, sizeof(EvalSlot));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].used) *find_slot(st, old[i].key) = old[i];
+        }
+        free(old);
+    }
+    EvalSlot *slot = find_slot(st, key);
+    if (!slot->used) {
+        slot->used = 1;
+        slot->key = key;
+        st->var_count++;
+    }
+    slot->value = value;
+}
+
+static EvalValue eval_int(int i) {
+    EvalValue value;
+    memset(&value, 0, sizeof(value));
+    value.kind = EVAL_INT;
+    value.i = i;
+    return value;
+}
+
+static EvalValue eval_float(double f) {
+    EvalValue value = eval_int(0);
+    value.kind = EVAL_FLOAT;
+    value.f = f;
+    return value;
+}
+
+// La constante float llega a la máquina como el texto que escribe ir_print
+static double vm_float(float f) {
+    char text[64];
+    snprintf(text, sizeof(text), "%f", f);
+    return strtod(text, NULL);
+}
+
+static int read_operand(EvalState *st, IRFunction *fn, Operand op, EvalValue *value) {
+    switch (op.kind) {
+        case OPND_INT:
+            *value = eval_int(op.u.int_value);
+            return 1;
+        case OPND_FLOAT:
+            *value = eval_float(vm_float(op.u.float_value));
+            return 1;
+        case OPND_STRING:
+            *value = eval_int(0);
+            value->kind = EVAL_STRING;
+            value->s = op.u.string_value;
+            return 1;
+        case OPND_VAR: {
+            if (fn->vars[op.u.var].kind == IRVAR_GLOBAL) return 0;
+            EvalSlot *slot = find_slot(st, var_key(fn, op.u.var));
+            if (!slot->used) return 0;
+            *value = slot->value;
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int write_operand(EvalState *st, IRFunction *fn, Operand op, EvalValue value) {
+    if (op.kind != OPND_VAR || fn->vars[op.u.var].kind == IRVAR_GLOBAL) return 0;
+    store(st, var_key(fn, op.u.var), value);
+    return 1;
+}
+
+static int is_true(EvalValue value) {
+    if (value.kind == EVAL_FLOAT) return value.f != 0.0;
+    if (value.kind == EVAL_STRING) return value.s[0] != '\0';
+    return value.i != 0;
+}
+
+static double as_double(EvalValue value) {
+    return value.kind == EVAL_FLOAT ? value.f : (double)value.i;
+}
+
+// Operación binaria como la máquina virtual; 0 donde la máquina se detiene
+static int binary(IROp op, EvalValue a, EvalValue b, EvalValue *result) {
+    if (op == IR_AND || op == IR_OR) {
+        *result = eval_int(op == IR_AND ? is_true(a) && is_true(b) : is_true(a) || is_true(b));
+        return 1;
+    }
+
+    if (a.kind == EVAL_STRING || b.kind == EVAL_STRING) {
+        if (a.kind != b.kind || (op != IR_EQ && op != IR_NE)) return 0;
+        int equal = strcmp(a.s, b.s) == 0;
+        *result = eval_int(op == IR_EQ ? equal : !equal);
+        return 1;
+    }
+
+    if (op >= IR_EQ) {
+        double x = as_double(a), y = as_double(b);
+        int value;
+        switch (op) {
+            case IR_EQ: value = x == y; break;
+            case IR_NE: value = x != y; break;
+            case IR_LT: value = x < y; break;
+            case IR_GT: value = x > y; break;
+            case IR_LE: value = x <= y; break;
+            default: value = x >= y; break;
+        }
+        *result = eval_int(value);
+        return 1;
+    }
+
+    if (a.kind == EVAL_FLOAT || b.kind == EVAL_FLOAT) {
+        double x = as_double(a), y = as_double(b);
+        switch (op) {
+            case IR_ADD: *result = eval_float(x + y); return 1;
+            case IR_SUB: *result = eval_float(x - y); return 1;
+            case IR_MUL: *result = eval_float(x * y); return 1;
+            case IR_DIV:
+                if (y == 0.0) return 0;
+                *result = eval_float(x / y);
+                return 1;
+            default:
+                return 0;
+        }
+    }
+
+    int value;
+    if (!ir_fold_binary(op, a.i, b.i, &value)) return 0;
+    *result = eval_int(value);
+    return 1;
+}
+
+// Una función que lee variables antes de escribirlas depende de llamadas
+// anteriores, y quitar una de sus llamadas cambiaría las siguientes
+static int is_evaluable(EvalState *st, IRFunction *fn, int f) {
+    if (st->evaluable[f] < 0) {
+        int *unassigned = cfg_unassigned_reads(fn);
+        st->evaluable[f] = fn->name != NULL;
+        for (int v = 0; v < fn->var_count; v++) {
+            if (unassigned[v]) st->evaluable[f] = 0;
+        }
+        free(unassigned);
+    }
+    return st->evaluable[f];
+}
+
+static int run_function(EvalState *st, int f);
+
+static void push(EvalState *st, EvalValue value) {
+    if (st->param_count == st->param_capacity) {
+        st->param_capacity *= 2;
+        st->params = (EvalValue*)realloc(st->params, st->param_capacity * sizeof(EvalValue));
+    }
+    st->params[st->param_count++] = value;
+}
+
+static int run_call(EvalState *st, IRFunction *fn, IRInstr *instr) {
+    for (int i = 0; i < instr->arg_count; i++) {
+        EvalValue value;
+        if (!read_operand(st, fn, instr->args[i], &value)) return 0;
+        push(st, value);
+    }
+    return instr->callee->address >= 0 && run_function(st, instr->callee->address);
+}
+
+static int run_instruction(EvalState *st, IRFunction *fn, IRInstr *instr) {
+    EvalValue a, b, result;
+
+    switch (instr->op) {
+        case IR_VAR:
+        case IR_NOP:
+            return 1;
+        case IR_ASSIGN:
+            return read_operand(st, fn, instr->src[0], &a) && write_operand(st, fn, instr->dst, a);
+        case IR_PARAM_GET:
+            // La pila tiene solo los argumentos de la evaluación
+            if (st->param_count == 0) return 0;
+            return write_operand(st, fn, instr->dst, st->params[--st->param_count]);
+        case IR_CALL:
+            return run_call(st, fn, instr);
+        case IR_PIXEL:
+        case IR_KEY:
+        case IR_INPUT:
+        case IR_PRINT:
+        case IR_PHI:
+            return 0;
+        default:
+            return read_operand(st, fn, instr->src[0], &a) && read_operand(st, fn, instr->src[1], &b) &&
+                   binary(instr->op, a, b, &result) && write_operand(st, fn, instr->dst, result);
+    }
+}
+
+static int run_function(EvalState *st, int f) {
+    IRFunction *fn = st->program->functions[f];
+    if (!is_evaluable(st, fn, f)) return 0;
+    if (st->depth == CONSTEVAL_MAX_DEPTH) {
+        st->out_of_budget = 1;
+        return 0;
+    }
+
+    st->depth++;
+    int b = fn->entry;
+    for (;;) {
+        IRBlock *block = &fn->blocks[b];
+        st->steps += block->count + 1;
+        if (st->steps > CONSTEVAL_MAX_STEPS) {
+            st->out_of_budget = 1;
+            return 0;
+        }
+        for (int i = 0; i < block->count; i++) {
+            if (!run_instruction(st, fn, &block->instrs[i])) return 0;
+        }
+
+        if (block->term == TERM_RETURN) break;
+        if (block->term == TERM_HALT) return 0;
+        if (block->term == TERM_GOTO) {
+            b = block->succ[0];
+        } else {
+            EvalValue cond;
+            if (!read_operand(st, fn, block->cond, &cond)) return 0;
+            b = is_true(cond) ? block->succ[0] : block->succ[1];
+        }
+    }
+    st->depth--;
+    return 1;
+}
+
+// Constante que la máquina leería con el mismo valor
+static int result_operand(EvalValue value, Operand *result) {
+    switch (value.kind) {
+        case EVAL_INT:
+            *result = ir_int(value.i);
+            return 1;
+        case EVAL_FLOAT:
+            if ((double)(float)value.f != value.f || vm_float((float)value.f) != value.f) return 0;
+            *result = ir_float((float)value.f);
+            return 1;
+        default:
+            *result = ir_string(value.s);
+            return 1;
+    }
+}
+
+static void init_state(EvalState *st, IRProgram *program, signed char *evaluable) {
+    memset(st, 0, sizeof(*st));
+    st->program = program;
+    st->var_capacity = 64;
+    st->vars = (EvalSlot*)calloc(st->var_capacity, sizeof(EvalSlot));
+    st->param_capacity = 16;
+    st->params = (EvalValue*)malloc(st->param_capacity * sizeof(EvalValue));
+    st->evaluable = evaluable;
+}
+
+static void free_state(EvalState *st) {
+    free(st->vars);
+    free(st->params);
+    free(st->exhausted);
+}
+
+static int is_exhausted(const EvalState *st, int f) {
+    for (int i = 0; i < st->exhausted_count; i++) {
+        if (st->exhausted[i] == f) return 1;
+    }
+    return 0;
+}
+
+// Ejecuta la función 'f' con argumentos constantes desde un estado vacío
+static int evaluate(EvalState *st, int f, const Operand *args, int arg_count) {
+    if (f < 0 || st->evaluable[f] == 0 || is_exhausted(st, f)) return 0;
+    for (int i = 0; i < arg_count; i++) {
+        if (args[i].kind == OPND_VAR) return 0;
+    }
+
+    st->var_count = 0;
+    memset(st->vars, 0, st->var_capacity * sizeof(EvalSlot));
+    st->param_count = 0;
+    st->steps = 0;
+    st->depth = 0;
+    st->out_of_budget = 0;
+
+    for (int i = 0; i < arg_count; i++) {
+        EvalValue value;
+        read_operand(st, NULL, args[i], &value);
+        push(st, value);
+    }
+    int ok = run_function(st, f) && st->param_count == 0;
+    // Si agotó el presupuesto una vez, no se vuelve a intentar en esta
+    // función. No se anota en 'evaluable', que otros hilos leen.
+    if (st->out_of_budget) {
+        st->exhausted = (int*)realloc(st->exhausted, (st->exhausted_count + 1) * sizeof(int));
+        st->exhausted[st->exhausted_count++] = f;
+    }
+    return ok;
+}
+
+// Valor que dejó la evaluación en ret_<función>
+static int return_value(EvalState *st, Symbol *function, Operand *result) {
+    EvalKey key;
+    key.owner = NULL;
+    key.name = function;
+    key.id = IRVAR_RETURN;
+    EvalSlot *slot = find_slot(st, key);
+    return slot->used && result_operand(slot->value, result);
+}
+
+// Evalúa la llamada; 1 si se sustituyó
+static int evaluate_call(EvalState *st, IRFunction *fn, IRInstr *instr) {
+    int f = instr->callee->address;
+    if (!evaluate(st, f, instr->args, instr->arg_count)) return 0;
+
+    // Sin valor de retorno la llamada no tiene efectos: se quita
+    int ret = -1;
+    for (int v = 0; v < fn->var_count; v++) {
+        if (fn->vars[v].kind == IRVAR_RETURN && fn->vars[v].symbol == instr->callee) ret = v;
+    }
+    if (st->program->functions[f]->return_type == TYPE_VOID || ret < 0) {
+        free(instr->args);
+        memset(instr, 0, sizeof(*instr));
+        instr->op = IR_NOP;
+        return 1;
+    }
+
+    Operand value;
+    if (!return_value(st, instr->callee, &value)) return 0;
+    free(instr->args);
+    memset(instr, 0, sizeof(*instr));
+    instr->op = IR_ASSIGN;
+    instr->dst = ir_var(ret);
+    instr->src[0] = value;
+    return 1;
+}
+
+void consteval_classify(IRProgram *program, int f, signed char *evaluable) {
+    EvalState st;
+    memset(&st, 0, sizeof(st));
+    st.program = program;
+    st.evaluable = evaluable;
+    is_evaluable(&st, program->functions[f], f);
+}
+
+int consteval_function(IRProgram *program, int f, const Operand *args, int arg_count,
+                       signed char *evaluable, Operand *result) {
+    EvalState st;
+    init_state(&st, program, evaluable);
+    int ok = evaluate(&st, f, args, arg_count) && return_value(&st, program->functions[f]->symbol, result);
+    free_state(&st);
+    return ok;
+}
+
+int evaluate_calls(IRProgram *program, IRFunction *fn, signed char *evaluable, OptStats *stats) {
+    EvalState st;
+    init_state(&st, program, evaluable);
+
+    int evaluated = 0;
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            if (block->instrs[i].op == IR_CALL) evaluated += evaluate_call(&st, fn, &block->instrs[i]);
+        }
+    }
+    if (evaluated) ir_remove_nops(fn);
+
+    free_state(&st);
+    stats->evaluated += evaluated;
+    return evaluated;
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "diag.h"
+
+#define DIAG_MESSAGE_MAX 1024
+
+static _Thread_local const char *current_path = NULL;
+static _Thread_local jmp_buf *current_recover = NULL;
+static _Thread_local void (*current_release)(void *data) = NULL;
+static _Thread_local void *current_release_data = NULL;
+
+void diag_begin(const char *path, jmp_buf *recover) {
+    current_path = path;
+    current_recover = recover;
+}
+
+void diag_end(void) {
+    current_path = NULL;
+    current_recover = NULL;
+    diag_on_recover(NULL, NULL);
+}
+
+void diag_on_recover(void (*release)(void *data), void *data) {
+    current_release = release;
+    current_release_data = data;
+}
+
+void compile_error(const char *format, ...) {
+    // Un solo fputs por mensaje para que no se mezclen los de varios hilos
+    char message[DIAG_MESSAGE_MAX];
+    int length = 0;
+    if (current_path) {
+        length = snprintf(message, sizeof(message), "%s: ", current_path);
+        if (length < 0 || length >= DIAG_MESSAGE_MAX) length = 0;
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message + length, sizeof(message) - length, format, args);
+    va_end(args);
+    fputs(message, stderr);
+
+    if (current_recover) {
+        jmp_buf *recover = current_recover;
+        void (*release)(void *data) = current_release;
+        void *data = current_release_data;
+        diag_end();
+        if (release) release(data);
+        longjmp(*recover, 1);
+    }
+    exit(1);
+}
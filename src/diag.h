@@ -0,0 +1,25 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <setjmp.h>
+
+// Errores del programa que se compila (léxicos, sintácticos, semánticos y
+// los que encuentra el generador de código). compile_error escribe el
+// mensaje en stderr y termina la compilación: si el hilo no instaló un
+// punto de recuperación termina el proceso con código 1; si lo instaló
+// (modo por lotes) vuelve a él y solo falla ese programa.
+//
+// Los errores internos y la falta de memoria siguen terminando el proceso.
+void compile_error(const char *format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+// Desde aquí y hasta diag_end, los errores del hilo llevan delante 'path'
+// (si no es NULL) y saltan a 'recover'
+void diag_begin(const char *path, jmp_buf *recover);
+void diag_end(void);
+
+// Lo que una etapa tiene reservado mientras corre (la IR de generate_code):
+// si un error salta a 'recover', antes se llama release(data), cuando el
+// marco de la etapa todavía existe. release NULL lo quita; diag_end también.
+void diag_on_recover(void (*release)(void *data), void *data);
+
+#endif
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "driver.h"
+#include "parse.h"
+#include "diag.h"
+#include "fold.h"
+#include "intern.h"
+#include "pool.h"
+
+// Lo que hay que liberar si compile_error interrumpe la compilación (la IR
+// la libera generate_code, ver diag_on_recover). Vive en el heap porque las
+// variables locales que cambian entre setjmp y longjmp quedan
+// indeterminadas.
+typedef struct Compilation {
+    ParseContext parse;
+    FILE *input;
+    FILE *output;           // NULL si ya se cerró o si es la salida estándar
+    SymbolTable *symtable;
+} Compilation;
+
+static void run_compilation(Compilation *c, const char *input_path, const char *output_path,
+                            const CodeGenOptions *options, int batch, CompileResult *result) {
+    c->input = fopen(input_path, "r");
+    if (!c->input) {
+        compile_error("Error: No se puede abrir el archivo %s\n", input_path);
+    }
+
+    c->symtable = create_symbol_table();
+
+    // Con la salida en stdout ('-') el progreso va a stderr para no mezclarse
+    int to_stdout = strcmp(output_path, "-") == 0;
+    if (to_stdout && batch) {
+        compile_error("Error: La salida estándar no se puede usar en el modo por lotes\n");
+    }
+    FILE *progress = batch ? NULL : to_stdout ? stderr : stdout;
+
+    if (progress) fprintf(progress, "=== Compilando %s ===\n", input_path);
+
+    ASTNode *root = parse_program(&c->parse, c->input);
+    if (!root) {
+        compile_error("✗ Error en la compilación\n");
+    }
+    if (progress) {
+        fprintf(progress, "✓ Análisis sintáctico completado\n");
+        fprintf(progress, "✓ Verificando semántica...\n");
+    }
+    semantic_analysis(root, c->symtable);
+    if (progress) fprintf(progress, "✓ Análisis semántico completado\n");
+
+    // Plegado de constantes
+    result->folded = fold_constants(root);
+
+    // Generación de código
+    if (progress) {
+        fprintf(progress, "✓ Generando código %s...\n",
+                options->emit == EMIT_C ? "C" : options->emit == EMIT_BIN ? "FIS-25 binario" : "FIS-25");
+    }
+    if (to_stdout) {
+        generate_code(root, stdout, c->symtable, options, &result->codegen);
+        if (fflush(stdout) != 0) {
+            compile_error("Error: No se puede escribir la salida estándar\n");
+        }
+    } else {
+        c->output = fopen(output_path, "w");
+        if (!c->output) {
+            compile_error("Error: No se puede crear el archivo %s\n", output_path);
+        }
+
+        generate_code(root, c->output, c->symtable, options, &result->codegen);
+        FILE *output = c->output;
+        c->output = NULL;
+        if (fclose(output) != 0) {
+            remove(output_path);
+            compile_error("Error: No se puede escribir el archivo %s\n", output_path);
+        }
+    }
+
+    result->ast_nodes = ast_node_count();
+    result->ast_bytes_used = ast_bytes_used();
+    result->ast_bytes_reserved = ast_bytes_reserved();
+    result->atoms = intern_count();
+
+    if (progress) {
+        fprintf(progress, "✓ Código generado exitosamente en %s\n", to_stdout ? "la salida estándar" : output_path);
+        fprintf(progress, "=== Compilación exitosa ===\n");
+    }
+}
+
+int compile_file(const char *input_path, const char *output_path,
+                 const CodeGenOptions *options, int batch, CompileResult *result) {
+    memset(result, 0, sizeof(*result));
+    Compilation *c = (Compilation*)calloc(1, sizeof(Compilation));
+    if (!c) {
+        fprintf(stderr, "Error: sin memoria para compilar %s\n", input_path);
+        exit(1);
+    }
+
+    jmp_buf recover;
+    volatile int failed = 1;
+    if (setjmp(recover) == 0) {
+        diag_begin(batch ? input_path : NULL, &recover);
+        run_compilation(c, input_path, output_path, options, batch, result);
+        diag_end();
+        failed = 0;
+    }
+
+    parse_release(&c->parse);
+    if (c->output) {
+        fclose(c->output);
+        remove(output_path);
+    }
+    if (c->input) fclose(c->input);
+    if (c->symtable) free_symbol_table(c->symtable);
+    free_ast();
+    intern_release();
+    free(c);
+    return failed;
+}
+
+typedef struct BatchEntry {
+    char *input_path;
+    char *output_path;
+    int failed;
+} BatchEntry;
+
+typedef struct Batch {
+    BatchEntry *entries;
+    int count;
+    const CodeGenOptions *options;
+} Batch;
+
+static void compile_entry(void *data, int worker, int task) {
+    (void)worker;
+    Batch *batch = (Batch*)data;
+    BatchEntry *entry = &batch->entries[task];
+    CompileResult result;
+    entry->failed = compile_file(entry->input_path, entry->output_path, batch->options, 1, &result);
+}
+
+// Lee la lista de programas; devuelve 0 si alguna línea no es válida
+static int read_batch(const char *list_path, Batch *batch) {
+    FILE *list = strcmp(list_path, "-") == 0 ? stdin : fopen(list_path, "r");
+    if (!list) {
+        fprintf(stderr, "Error: No se puede abrir el archivo %s\n", list_path);
+        return 0;
+    }
+
+    int capacity = 0;
+    char *line = NULL;
+    size_t line_size = 0;
+    int line_number = 0;
+    int valid = 1;
+    while (valid && getline(&line, &line_size, list) != -1) {
+        line_number++;
+        char *save;
+        char *input_path = strtok_r(line, " \t\r\n", &save);
+        if (!input_path || input_path[0] == '#') continue;
+        char *output_path = strtok_r(NULL, " \t\r\n", &save);
+        if (!output_path || strtok_r(NULL, " \t\r\n", &save)) {
+            fprintf(stderr, "Error: %s:%d: se esperaba \"entrada salida\"\n", list_path, line_number);
+            valid = 0;
+            break;
+        }
+        if (batch->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            batch->entries = (BatchEntry*)realloc(batch->entries, capacity * sizeof(BatchEntry));
+            if (!batch->entries) {
+                fprintf(stderr, "Error: sin memoria para la lista de programas\n");
+                exit(1);
+            }
+        }
+        BatchEntry *entry = &batch->entries[batch->count++];
+        entry->input_path = strdup(input_path);
+        entry->output_path = strdup(output_path);
+        entry->failed = 1;
+    }
+
+    free(line);
+    if (list != stdin) fclose(list);
+    return valid;
+}
+
+int compile_batch(const char *list_path, int jobs, const CodeGenOptions *options,
+                  int show_stats) {
+    Batch batch;
+    batch.entries = NULL;
+    batch.count = 0;
+    batch.options = options;
+
+    int failed = 0;
+    if (read_batch(list_path, &batch)) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pool_run(jobs, batch.count, NULL, NULL, compile_entry, &batch);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        for (int i = 0; i < batch.count; i++) {
+            BatchEntry *entry = &batch.entries[i];
+            if (entry->failed) {
+                printf("✗ %s\n", entry->input_path);
+                failed++;
+            } else {
+                printf("✓ %s -> %s\n", entry->input_path, entry->output_path);
+            }
+        }
+        printf("=== Lote: %d programas compilados, %d con errores ===\n",
+               batch.count - failed, failed);
+
+        if (show_stats) {
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+            printf("--- Estadísticas ---\n");
+            printf("Tiempo: %.1f ms para %d programas en %d hilos\n",
+                   ms, batch.count, jobs < batch.count ? jobs : batch.count);
+            printf("Memoria: pico RSS %ld KB\n", usage.ru_maxrss);
+        }
+    } else {
+        failed = 1;
+    }
+
+    for (int i = 0; i < batch.count; i++) {
+        free(batch.entries[i].input_path);
+        free(batch.entries[i].output_path);
+    }
+    free(batch.entries);
+    return failed > 0;
+}
@@ -0,0 +1,35 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <stddef.h>
+#include "codegen.h"
+
+// Resultado de compilar un programa, para --stats. El AST y los
+// identificadores se liberan al terminar, así que sus tamaños se copian.
+typedef struct CompileResult {
+    size_t ast_nodes;
+    size_t ast_bytes_used;
+    size_t ast_bytes_reserved;
+    size_t atoms;
+    int folded;
+    CodeGenStats codegen;
+} CompileResult;
+
+// Compila el programa 'input_path' en 'output_path' ('-' es la salida
+// estándar, y entonces el progreso va a stderr). Devuelve 0 si compiló; si
+// no, el error ya se escribió en stderr y no queda archivo de salida. En el modo por lotes ('batch') no escribe el progreso en stdout
+// y los errores llevan delante el nombre del programa.
+//
+// Cada hilo puede compilar un programa a la vez: el AST y la tabla de
+// identificadores son del hilo y se liberan al terminar.
+int compile_file(const char *input_path, const char *output_path,
+                 const CodeGenOptions *options, int batch, CompileResult *result);
+
+// Modo por lotes (--batch): compila en 'jobs' hilos los programas de
+// 'list_path' ('-' es la entrada estándar), una línea "entrada salida" por
+// programa; se ignoran las líneas vacías y las que empiezan con '#'.
+// Informa cada programa en el orden de la lista y devuelve 1 si alguno falló.
+int compile_batch(const char *list_path, int jobs, const CodeGenOptions *options,
+                  int show_stats);
+
+#endif
@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "fold.h"
+
+static _Thread_local int folded_count = 0;
+
+static int is_numeric_literal(ASTNode *node) {
+    return node->type == NODE_INT_LITERAL || node->type == NODE_FLOAT_LITERAL;
+}
+
+// Valor con el que la máquina virtual lee un literal float, que el
+// compilador escribe con %f
+static double machine_float(float value) {
+    char text[64];
+    snprintf(text, sizeof(text), "%f", value);
+    return strtod(text, NULL);
+}
+
+// La máquina virtual opera los números en double
+static double numeric_value(ASTNode *node) {
+    if (node->type == NODE_INT_LITERAL) return (double)node->data.int_value;
+    return machine_float(node->data.float_value);
+}
+
+static int is_int_constant(ASTNode *node, int value) {
+    return node->type == NODE_INT_LITERAL && node->data.int_value == value;
+}
+
+static int is_numeric_constant(ASTNode *node, int value) {
+    return is_int_constant(node, value) ||
+           (node->type == NODE_FLOAT_LITERAL && node->data.float_value == (float)value);
+}
+
+static int is_bool_constant(ASTNode *node, int value) {
+    return node->type == NODE_BOOL_LITERAL && node->data.bool_value == value;
+}
+
+// Una expresión sin llamadas ni accesos a arrays con índice variable (que
+// pueden detener la máquina) puede descartarse sin cambiar el programa
+static int has_side_effects(ASTNode *expr) {
+    if (!expr) return 0;
+
+    switch (expr->type) {
+        case NODE_FUNCTION_CALL:
+            return 1;
+        case NODE_BINOP:
+            return has_side_effects(expr->data.binop.left) ||
+                   has_side_effects(expr->data.binop.right);
+        case NODE_UNOP:
+            return has_side_effects(expr->data.unop.operand);
+        case NODE_ARRAY_ACCESS:
+            return expr->data.array_access.index->type != NODE_INT_LITERAL;
+        default:
+            return 0;
+    }
+}
+
+static ASTNode* folded(ASTNode *node) {
+    folded_count++;
+    return node;
+}
+
+// Aritmética entera con el desbordamiento circular de la máquina virtual
+static int wrap_int(BinaryOperator op, int a, int b) {
+    switch (op) {
+        case OP_ADD: return (int)((unsigned)a + (unsigned)b);
+        case OP_SUB: return (int)((unsigned)a - (unsigned)b);
+        case OP_MUL: return (int)((unsigned)a * (unsigned)b);
+        case OP_DIV: return a / b;
+        case OP_MOD: return a % b;
+        default: return 0;
+    }
+}
+
+static ASTNode* fold_literal_binop(ASTNode *expr, ASTNode *left, ASTNode *right) {
+    BinaryOperator op = expr->data.binop.op;
+
+    switch (op) {
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+            if (!is_numeric_literal(left) || !is_numeric_literal(right)) return expr;
+            if (left->type == NODE_INT_LITERAL && right->type == NODE_INT_LITERAL) {
+                int a = left->data.int_value;
+                int b = right->data.int_value;
+                if ((op == OP_DIV || op == OP_MOD) && (b == 0 || (a == INT_MIN && b == -1))) {
+                    return expr;
+                }
+                return folded(create_int_literal_node(wrap_int(op, a, b)));
+            } else {
+                // Promoción a float, como en check_expression_type, pero
+                // calculada en double como en la máquina virtual. El
+                // resultado se pliega solo si el literal que lo reemplaza
+                // se lee con el mismo valor (16777216.0 + 1.0 no cabe en un
+                // float y queda para la ejecución).
+                double a = numeric_value(left);
+                double b = numeric_value(right);
+                double result;
+                switch (op) {
+                    case OP_ADD: result = a + b; break;
+                    case OP_SUB: result = a - b; break;
+                    case OP_MUL: result = a * b; break;
+                    case OP_DIV:
+                        if (b == 0.0) return expr;
+                        result = a / b;
+                        break;
+                    default:
+                        return expr;
+                }
+                if (machine_float((float)result) != result) return expr;
+                return folded(create_float_literal_node((float)result));
+            }
+
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_GT:
+        case OP_LE:
+        case OP_GE: {
+            double a, b;
+            if (is_numeric_literal(left) && is_numeric_literal(right)) {
+                a = numeric_value(left);
+                b = numeric_value(right);
+            } else if (left->type == NODE_BOOL_LITERAL && right->type == NODE_BOOL_LITERAL) {
+                a = left->data.bool_value;
+                b = right->data.bool_value;
+            } else {
+                return expr;
+            }
+            int result;
+            switch (op) {
+                case OP_EQ: result = a == b; break;
+                case OP_NE: result = a != b; break;
+                case OP_LT: result = a < b; break;
+                case OP_GT: result = a > b; break;
+                case OP_LE: result = a <= b; break;
+                default: result = a >= b; break;
+            }
+            return folded(create_bool_literal_node(result));
+        }
+
+        case OP_AND:
+        case OP_OR:
+            if (left->type != NODE_BOOL_LITERAL || right->type != NODE_BOOL_LITERAL) return expr;
+            if (op == OP_AND) {
+                return folded(create_bool_literal_node(left->data.bool_value && right->data.bool_value));
+            }
+            return folded(create_bool_literal_node(left->data.bool_value || right->data.bool_value));
+    }
+
+    return expr;
+}
+
+// Identidades algebraicas; 'x' solo sustituye al nodo si conserva su tipo
+static ASTNode* simplify_binop(ASTNode *expr, ASTNode *left, ASTNode *right) {
+    DataType type = expr->data_type;
+    int same_left = left->data_type == type;
+    int same_right = right->data_type == type;
+
+    switch (expr->data.binop.op) {
+        case OP_ADD:
+            if (is_numeric_constant(right, 0) && same_left) return folded(left);
+            if (is_numeric_constant(left, 0) && same_right) return folded(right);
+            break;
+        case OP_SUB:
+            if (is_numeric_constant(right, 0) && same_left) return folded(left);
+            break;
+        case OP_MUL:
+            if (is_numeric_constant(right, 1) && same_left) return folded(left);
+            if (is_numeric_constant(left, 1) && same_right) return folded(right);
+            if (type == TYPE_INT && (is_int_constant(left, 0) || is_int_constant(right, 0)) &&
+                !has_side_effects(left) && !has_side_effects(right)) {
+                return folded(create_int_literal_node(0));
+            }
+            break;
+        case OP_DIV:
+            if (is_numeric_constant(right, 1) && same_left) return folded(left);
+            break;
+        case OP_AND:
+            if (is_bool_constant(right, 1)) return folded(left);
+            if (is_bool_constant(left, 1)) return folded(right);
+            if (is_bool_constant(left, 0) || (is_bool_constant(right, 0) && !has_side_effects(left))) {
+                return folded(create_bool_literal_node(0));
+            }
+            break;
+        case OP_OR:
+            if (is_bool_constant(right, 0)) return folded(left);
+            if (is_bool_constant(left, 0)) return folded(right);
+            if (is_bool_constant(left, 1) || (is_bool_constant(right, 1) && !has_side_effects(left))) {
+                return folded(create_bool_literal_node(1));
+            }
+            break;
+        default:
+            break;
+    }
+
+    return expr;
+}
+
+static ASTNode* fold_unop(ASTNode *expr, ASTNode *operand) {
+    switch (expr->data.unop.op) {
+        case OP_NEG:
+            if (operand->type == NODE_INT_LITERAL) {
+                return folded(create_int_literal_node((int)(0u - (unsigned)operand->data.int_value)));
+            }
+            if (operand->type == NODE_FLOAT_LITERAL) {
+                return folded(create_float_literal_node(-operand->data.float_value));
+            }
+            // -(-x) => x
+            if (operand->type == NODE_UNOP && operand->data.unop.op == OP_NEG) {
+                return folded(operand->data.unop.operand);
+            }
+            break;
+        case OP_NOT:
+            if (operand->type == NODE_BOOL_LITERAL) {
+                return folded(create_bool_literal_node(!operand->data.bool_value));
+            }
+            if (operand->type == NODE_INT_LITERAL) {
+                return folded(create_int_literal_node(operand->data.int_value == 0));
+            }
+            // !!b => b (solo para bool: !!5 vale 1)
+            if (operand->type == NODE_UNOP && operand->data.unop.op == OP_NOT &&
+                operand->data.unop.operand->data_type == TYPE_BOOL) {
+                return folded(operand->data.unop.operand);
+            }
+            break;
+    }
+
+    return expr;
+}
+
+static ASTNode* fold_expression(ASTNode *expr) {
+    if (!expr) return NULL;
+
+    switch (expr->type) {
+        case NODE_BINOP: {
+            ASTNode *left = fold_expression(expr->data.binop.left);
+            ASTNode *right = fold_expression(expr->data.binop.right);
+            expr->data.binop.left = left;
+            expr->data.binop.right = right;
+
+            ASTNode *result = fold_literal_binop(expr, left, right);
+            if (result == expr) {
+                result = simplify_binop(expr, left, right);
+            }
+            return result;
+        }
+
+        case NODE_UNOP: {
+            ASTNode *operand = fold_expression(expr->data.unop.operand);
+            expr->data.unop.operand = operand;
+            return fold_unop(expr, operand);
+        }
+
+        case NODE_ARRAY_ACCESS:
+            expr->data.array_access.index = fold_expression(expr->data.array_access.index);
+            return expr;
+
+        case NODE_FUNCTION_CALL: {
+            ASTNode *arg = expr->data.function_call.arguments;
+            while (arg) {
+                arg->data.argument.expression = fold_expression(arg->data.argument.expression);
+                arg = arg->data.argument.next;
+            }
+            return expr;
+        }
+
+        default:
+            return expr;
+    }
+}
+
+static void fold_statement(ASTNode *node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NODE_STATEMENT_LIST:
+            fold_statement(node->data.stmt_list.statement);
+            fold_statement(node->data.stmt_list.next);
+            break;
+
+        case NODE_DECLARATION:
+            node->data.declaration.init_value = fold_expression(node->data.declaration.init_value);
+            break;
+
+        case NODE_ASSIGNMENT:
+            node->data.assignment.value = fold_expression(node->data.assignment.value);
+            break;
+
+        case NODE_ARRAY_DECLARATION:
+            for (ASTNode *elem = node->data.array_decl.elements; elem; elem = elem->data.argument.next) {
+                elem->data.argument.expression = fold_expression(elem->data.argument.expression);
+            }
+            break;
+
+        case NODE_ARRAY_ASSIGNMENT:
+            fold_expression(node->data.array_assign.array_access);
+            node->data.array_assign.value = fold_expression(node->data.array_assign.value);
+            break;
+
+        case NODE_IF:
+            node->data.if_stmt.condition = fold_expression(node->data.if_stmt.condition);
+            fold_statement(node->data.if_stmt.then_branch);
+            fold_statement(node->data.if_stmt.else_branch);
+            break;
+
+        case NODE_WHILE:
+            node->data.while_stmt.condition = fold_expression(node->data.while_stmt.condition);
+            fold_statement(node->data.while_stmt.body);
+            break;
+
+        case NODE_FOR:
+            fold_statement(node->data.for_stmt.init);
+            node->data.for_stmt.condition = fold_expression(node->data.for_stmt.condition);
+            fold_statement(node->data.for_stmt.increment);
+            fold_statement(node->data.for_stmt.body);
+            break;
+
+        case NODE_FUNCTION_DEF:
+            fold_statement(node->data.function_def.body);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            fold_expression(node);
+            break;
+
+        case NODE_PIXEL:
+            node->data.pixel.x = fold_expression(node->data.pixel.x);
+            node->data.pixel.y = fold_expression(node->data.pixel.y);
+            node->data.pixel.color = fold_expression(node->data.pixel.color);
+            break;
+
+        case NODE_PRINT:
+            node->data.print.expression = fold_expression(node->data.print.expression);
+            break;
+
+        case NODE_RETURN:
+            node->data.return_stmt.return_value = fold_expression(node->data.return_stmt.return_value);
+            break;
+
+        // El código de tecla no se pliega: codegen solo traduce los literales escritos
+        default:
+            break;
+    }
+}
+
+int fold_constants(ASTNode *root) {
+    folded_count = 0;
+    fold_statement(root);
+    return folded_count;
+}
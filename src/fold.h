@@ -0,0 +1,13 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "ast.h"
+
+// Plegado de constantes y simplificación algebraica sobre el AST anotado
+// por el análisis semántico. Evalúa subárboles de literales int/float/bool
+// con las mismas reglas de promoción que check_expression_type y aplica
+// identidades (x+0, x*1, x*0, !!b, ...). Devuelve cuántas expresiones
+// se simplificaron.
+int fold_constants(ASTNode *root);
+
+#endif
@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Expansión en línea de llamadas a funciones pequeñas. Una llamada cuesta
+// un PARAM por argumento, el GOSUB, un PARAM_GET por parámetro, el RETURN
+// y la copia de ret_<función>; si el cuerpo del llamado no es mucho más
+// grande que eso, se copia en el llamador. Las variables propias del
+// llamado pasan a ser temporales nuevos del llamador, así que no chocan
+// con las suyas ni con las de otra copia de la misma función.
+//
+// Las funciones se expanden después de optimizarse (optimize_program las
+// recorre de los llamados a los llamadores) y el llamador se optimiza
+// después con el cuerpo ya copiado.
+
+static int is_local(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    return kind != IRVAR_GLOBAL && kind != IRVAR_RETURN;
+}
+
+// Variable propia: local, parámetro, temporal o el ret_<función> de la
+// función misma. Son las que se renombran al expandir.
+static int is_own(IRFunction *fn, int var) {
+    return is_local(fn, var) || (fn->vars[var].kind == IRVAR_RETURN &&
+                                 fn->vars[var].symbol == fn->symbol);
+}
+
+int inline_cost(IRFunction *fn) {
+    if (!fn->name || !fn->symbol) return -1;
+
+    int *reachable = ir_reachable_blocks(fn);
+    int size = 0, params = 0, has_call = 0, ok = 1;
+    for (int b = 0; b < fn->block_count && ok; b++) {
+        if (!reachable[b]) continue;
+        IRBlock *block = &fn->blocks[b];
+        if (b != fn->entry) size++;
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            if (instr->op == IR_VAR || instr->op == IR_NOP) continue;
+            if (instr->op == IR_PHI) ok = 0;
+            if (instr->op == IR_CALL) has_call = 1;
+            if (instr->op == IR_PARAM_GET) {
+                if (b != fn->entry) ok = 0;
+                params++;
+            }
+            size++;
+        }
+    }
+    free(reachable);
+
+    // Una variable leída antes de escribirse conserva el valor de la llamada
+    // anterior, que se pierde al renombrarla
+    if (ok) {
+        int *unassigned = cfg_unassigned_reads(fn);
+        for (int v = 0; v < fn->var_count; v++) {
+            if (unassigned[v]) ok = 0;
+        }
+        free(unassigned);
+    }
+    if (!ok) return -1;
+
+    // PARAM y PARAM_GET por argumento, GOSUB, RETURN y la copia del valor
+    int growth = size - (2 * params + 3);
+    if (growth < 0) growth = 0;
+    // Una función que llama a otras cuenta doble: su cuerpo crece al
+    // expandir a su vez las llamadas de sus llamadores
+    return has_call ? 2 * growth : growth;
+}
+
+typedef struct InlineSite {
+    IRFunction *fn;         // Llamador
+    IRFunction *callee;
+    int *var_map;           // Variable del llamado -> variable del llamador; -1 sin asignar
+} InlineSite;
+
+// Variable del llamador para un global o el ret_ de otra función
+static int shared_var(IRFunction *fn, const IRVar *var) {
+    for (int v = 0; v < fn->var_count; v++) {
+        if (fn->vars[v].kind == var->kind && fn->vars[v].symbol == var->symbol) return v;
+    }
+    return ir_add_var(fn, var->kind, var->name, var->symbol, var->type);
+}
+
+static void map_operand(InlineSite *site, Operand *op) {
+    if (op->kind != OPND_VAR) return;
+    int v = op->u.var;
+    if (site->var_map[v] < 0) {
+        const IRVar *var = &site->callee->vars[v];
+        if (is_own(site->callee, v)) {
+            site->var_map[v] = ir_add_var(site->fn, IRVAR_TEMP, NULL, NULL, var->type);
+        } else {
+            site->var_map[v] = shared_var(site->fn, var);
+        }
+    }
+    op->u.var = site->var_map[v];
+}
+
+// El llamador lee ret_<llamado> solo en la copia que sigue a cada llamada,
+// a lo sumo con declaraciones en medio
+static int return_read_after_calls(IRFunction *fn, IRFunction *callee) {
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        if (block->term == TERM_BRANCH && block->cond.kind == OPND_VAR &&
+            fn->vars[block->cond.u.var].kind == IRVAR_RETURN &&
+            fn->vars[block->cond.u.var].symbol == callee->symbol) {
+            return 0;
+        }
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (op->kind != OPND_VAR || fn->vars[op->u.var].kind != IRVAR_RETURN ||
+                    fn->vars[op->u.var].symbol != callee->symbol) {
+                    continue;
+                }
+                int prev = i - 1;
+                while (prev >= 0 && block->instrs[prev].op == IR_VAR) prev--;
+                if (instr->op != IR_ASSIGN || k != 0 || prev < 0 ||
+                    block->instrs[prev].op != IR_CALL || block->instrs[prev].callee != callee->symbol) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+static int param_count(IRFunction *fn) {
+    IRBlock *entry = &fn->blocks[fn->entry];
+    int count = 0;
+    for (int i = 0; i < entry->count; i++) {
+        if (entry->instrs[i].op == IR_PARAM_GET) count++;
+    }
+    return count;
+}
+
+// Copia el cuerpo del llamado en lugar de la llamada block.instrs[index].
+// El bloque se parte en dos: lo anterior a la llamada salta a la copia de
+// la entrada, y los RETURN de la copia saltan a un bloque nuevo con el
+// resto. Devuelve ese bloque.
+static int expand_call(IRFunction *fn, int block, int index, IRFunction *callee) {
+    InlineSite site;
+    site.fn = fn;
+    site.callee = callee;
+    site.var_map = (int*)malloc((callee->var_count + 1) * sizeof(int));
+    for (int v = 0; v < callee->var_count; v++) site.var_map[v] = -1;
+
+    int *reachable = ir_reachable_blocks(callee);
+    int *block_map = (int*)malloc((callee->block_count + 1) * sizeof(int));
+    int copied = 0;
+    for (int l = 0; l < callee->layout_count; l++) {
+        int b = callee->layout[l];
+        if (reachable[b]) block_map[b] = ir_new_block(fn);
+        copied += reachable[b];
+    }
+    int rest = ir_new_block(fn);
+
+    // Lo que sigue a la llamada pasa al bloque nuevo
+    IRBlock *caller_block = &fn->blocks[block];
+    IRInstr call = caller_block->instrs[index];
+    for (int i = index + 1; i < caller_block->count; i++) {
+        *ir_append(fn, rest, caller_block->instrs[i].op) = caller_block->instrs[i];
+    }
+    IRBlock *rest_block = &fn->blocks[rest];
+    rest_block->term = caller_block->term;
+    rest_block->cond = caller_block->cond;
+    rest_block->succ[0] = caller_block->succ[0];
+    rest_block->succ[1] = caller_block->succ[1];
+    caller_block->count = index;
+    ir_set_goto(fn, block, block_map[callee->entry]);
+
+    int param = 0;
+    for (int l = 0; l < callee->layout_count; l++) {
+        int b = callee->layout[l];
+        if (!reachable[b]) continue;
+        IRBlock *source = &callee->blocks[b];
+        int target = block_map[b];
+
+        for (int i = 0; i < source->count; i++) {
+            if (source->instrs[i].op == IR_NOP) continue;
+            IRInstr *copy = ir_append(fn, target, source->instrs[i].op);
+            *copy = source->instrs[i];
+            copy->arg_blocks = NULL;
+            if (copy->args) {
+                copy->args = (Operand*)malloc(copy->arg_count * sizeof(Operand));
+                memcpy(copy->args, source->instrs[i].args, copy->arg_count * sizeof(Operand));
+            }
+            map_operand(&site, &copy->dst);
+            for (int k = 0; k < ir_use_count(copy); k++) map_operand(&site, ir_use_at(copy, k));
+
+            // El último argumento apilado es el primero que se saca
+            if (copy->op == IR_PARAM_GET) {
+                copy->op = IR_ASSIGN;
+                copy->src[0] = call.args[call.arg_count - 1 - param++];
+            }
+        }
+
+        IRBlock *copy_block = &fn->blocks[target];
+        switch (source->term) {
+            case TERM_GOTO:
+                ir_set_goto(fn, target, block_map[source->succ[0]]);
+                break;
+            case TERM_BRANCH:
+                copy_block->cond = source->cond;
+                map_operand(&site, &copy_block->cond);
+                ir_set_branch(fn, target, copy_block->cond,
+                              block_map[source->succ[0]], block_map[source->succ[1]]);
+                break;
+            case TERM_RETURN:
+                ir_set_goto(fn, target, rest);
+                break;
+            case TERM_HALT:
+                ir_set_halt(fn, target);
+                break;
+        }
+    }
+
+    // La copia de ret_<llamado> que seguía a la llamada lee el temporal
+    rest_block = &fn->blocks[rest];
+    int first = 0;
+    while (first < rest_block->count && rest_block->instrs[first].op == IR_VAR) first++;
+    for (int v = 0; v < callee->var_count; v++) {
+        if (site.var_map[v] < 0 || callee->vars[v].kind != IRVAR_RETURN) continue;
+        if (callee->vars[v].symbol != callee->symbol || first == rest_block->count) continue;
+        IRInstr *copy = &rest_block->instrs[first];
+        if (copy->op == IR_ASSIGN && copy->src[0].kind == OPND_VAR &&
+            fn->vars[copy->src[0].u.var].kind == IRVAR_RETURN &&
+            fn->vars[copy->src[0].u.var].symbol == callee->symbol) {
+            copy->src[0] = ir_var(site.var_map[v]);
+        }
+    }
+
+    // Los bloques copiados y el resto van justo después del bloque partido
+    int position = 0;
+    while (fn->layout[position] != block) position++;
+    int added = copied + 1;
+    for (int i = 0; i < added; i++) ir_place_block(fn, rest);
+    memmove(&fn->layout[position + 1 + added], &fn->layout[position + 1],
+            (fn->layout_count - added - position - 1) * sizeof(int));
+    int next = position + 1;
+    for (int l = 0; l < callee->layout_count; l++) {
+        if (reachable[callee->layout[l]]) fn->layout[next++] = block_map[callee->layout[l]];
+    }
+    fn->layout[next] = rest;
+
+    free(call.args);
+    free(block_map);
+    free(reachable);
+    free(site.var_map);
+    return rest;
+}
+
+int inline_calls(IRProgram *program, IRFunction *fn, const int *cost, int limit, OptStats *stats) {
+    int *worklist = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    int capacity = fn->block_count + 1;
+    int top = 0, inlined = 0;
+    for (int b = fn->block_count - 1; b >= 0; b--) worklist[top++] = b;
+
+    while (top > 0) {
+        int b = worklist[--top];
+        for (int i = 0; i < fn->blocks[b].count; i++) {
+            IRInstr *instr = &fn->blocks[b].instrs[i];
+            if (instr->op != IR_CALL || instr->callee->address < 0) continue;
+            int f = instr->callee->address;
+            IRFunction *callee = program->functions[f];
+            if (callee == fn || cost[f] < 0 || cost[f] > limit) continue;
+
+            // El llamador tiene que seguir entrando en los límites de SSA
+            if (fn->block_count + callee->block_count + 1 > OPT_MAX_BLOCKS ||
+                fn->var_count + callee->var_count > OPT_MAX_VARS) {
+                continue;
+            }
+            if (param_count(callee) != instr->arg_count || !return_read_after_calls(fn, callee)) continue;
+
+            int rest = expand_call(fn, b, i, callee);
+            if (top >= capacity) {
+                capacity *= 2;
+                worklist = (int*)realloc(worklist, capacity * sizeof(int));
+            }
+            worklist[top++] = rest;
+            inlined++;
+            break;
+        }
+    }
+
+    free(worklist);
+    stats->inlined += inlined;
+    return inlined;
+}
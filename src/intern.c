@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "intern.h"
+
+#define INTERN_INITIAL_CAPACITY 1024
+
+// Cabecera que precede a los caracteres de cada átomo
+typedef struct AtomHeader {
+    unsigned int hash;
+    unsigned int length;
+    char str[];
+} AtomHeader;
+
+// Una tabla por hilo, como el AST cuyos identificadores guarda
+static _Thread_local Arena intern_arena;
+static _Thread_local AtomHeader **slots = NULL;
+static _Thread_local size_t capacity = 0;
+static _Thread_local size_t count = 0;
+
+static unsigned int hash_string(const char *str, size_t *length) {
+    unsigned int hash = 5381;
+    const char *p = str;
+    int c;
+    while ((c = (unsigned char)*p++))
+        hash = ((hash << 5) + hash) + c;
+    *length = (size_t)(p - str - 1);
+    return hash;
+}
+
+static AtomHeader* header_of(const char *atom) {
+    return (AtomHeader*)(atom - offsetof(AtomHeader, str));
+}
+
+static void grow_table(void) {
+    size_t new_capacity = capacity ? capacity * 2 : INTERN_INITIAL_CAPACITY;
+    AtomHeader **new_slots = (AtomHeader**)calloc(new_capacity, sizeof(AtomHeader*));
+    if (!new_slots) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para la tabla de identificadores\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        AtomHeader *entry = slots[i];
+        if (!entry) continue;
+        size_t index = entry->hash & (new_capacity - 1);
+        while (new_slots[index]) {
+            index = (index + 1) & (new_capacity - 1);
+        }
+        new_slots[index] = entry;
+    }
+
+    free(slots);
+    slots = new_slots;
+    capacity = new_capacity;
+}
+
+const char* intern(const char *str) {
+    if (count * 2 >= capacity) {
+        grow_table();
+    }
+
+    size_t length;
+    unsigned int hash = hash_string(str, &length);
+    size_t index = hash & (capacity - 1);
+
+    while (slots[index]) {
+        AtomHeader *entry = slots[index];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->str, str, length) == 0) {
+            return entry->str;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+
+    AtomHeader *entry = (AtomHeader*)arena_alloc(&intern_arena, sizeof(AtomHeader) + length + 1);
+    entry->hash = hash;
+    entry->length = (unsigned int)length;
+    memcpy(entry->str, str, length + 1);
+    slots[index] = entry;
+    count++;
+
+    return entry->str;
+}
+
+unsigned int atom_hash(const char *atom) {
+    return header_of(atom)->hash;
+}
+
+size_t intern_count(void) {
+    return count;
+}
+
+void intern_release(void) {
+    free(slots);
+    slots = NULL;
+    capacity = 0;
+    count = 0;
+    arena_release(&intern_arena);
+}
@@ -0,0 +1,17 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+// Tabla de identificadores internados, una por hilo.
+// Un átomo es una cadena canónica: dos identificadores iguales producen el
+// mismo puntero, así que se pueden comparar con '==' en lugar de strcmp.
+// El hash se calcula una sola vez al internar y se guarda junto a la cadena.
+
+const char* intern(const char *str);
+unsigned int atom_hash(const char *atom);
+
+size_t intern_count(void);
+void intern_release(void);
+
+#endif
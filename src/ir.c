@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ir.h"
+
+// Crecimiento de arreglos dinámicos al doble
+static void* grow(void *items, int *capacity, int needed, size_t item_size, int initial) {
+    if (needed <= *capacity) return items;
+    int new_capacity = *capacity ? *capacity : initial;
+    while (new_capacity < needed) new_capacity *= 2;
+    items = realloc(items, (size_t)new_capacity * item_size);
+    if (!items) {
+        fprintf(stderr, "Error: sin memoria para la representación intermedia\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return items;
+}
+
+IRProgram* ir_create_program(SymbolTable *table) {
+    IRProgram *program = (IRProgram*)calloc(1, sizeof(IRProgram));
+
+    // Tras el análisis solo quedan los globales, en orden de declaración
+    program->global_count = (int)table->entry_count;
+    program->globals = (Symbol**)malloc((table->entry_count + 1) * sizeof(Symbol*));
+    for (size_t i = 0; i < table->entry_count; i++) {
+        program->globals[i] = table->entries[i];
+    }
+    return program;
+}
+
+IRFunction* ir_add_function(IRProgram *program, const char *name, Symbol *symbol, DataType return_type) {
+    IRFunction *fn = (IRFunction*)calloc(1, sizeof(IRFunction));
+    fn->name = name;
+    fn->symbol = symbol;
+    fn->return_type = return_type;
+    fn->inline_cost = -1;
+    fn->entry = ir_new_block(fn);
+
+    program->functions = (IRFunction**)grow(program->functions, &program->function_capacity,
+                                            program->function_count + 1, sizeof(IRFunction*), 16);
+    program->functions[program->function_count++] = fn;
+    return fn;
+}
+
+// Bloque nuevo, vacío y terminado en RETURN hasta que se le asigne un salto
+int ir_new_block(IRFunction *fn) {
+    fn->blocks = (IRBlock*)grow(fn->blocks, &fn->block_capacity, fn->block_count + 1,
+                                sizeof(IRBlock), 8);
+    IRBlock *block = &fn->blocks[fn->block_count];
+    memset(block, 0, sizeof(IRBlock));
+    block->term = TERM_RETURN;
+    block->succ[0] = -1;
+    block->succ[1] = -1;
+    return fn->block_count++;
+}
+
+// Coloca el bloque a continuación del último en el orden de salida
+void ir_place_block(IRFunction *fn, int block) {
+    fn->layout = (int*)grow(fn->layout, &fn->layout_capacity, fn->layout_count + 1, sizeof(int), 8);
+    fn->layout[fn->layout_count++] = block;
+}
+
+int ir_add_var(IRFunction *fn, IRVarKind kind, const char *name, Symbol *symbol, DataType type) {
+    fn->vars = (IRVar*)grow(fn->vars, &fn->var_capacity, fn->var_count + 1, sizeof(IRVar), 16);
+    IRVar *var = &fn->vars[fn->var_count];
+    var->name = name;
+    var->kind = kind;
+    var->symbol = symbol;
+    var->type = type;
+    var->temp_id = kind == IRVAR_TEMP ? fn->temp_count++ : -1;
+    var->origin = fn->var_count;
+    var->qualified = 0;
+    var->slot = -1;
+    return fn->var_count++;
+}
+
+IRInstr* ir_append(IRFunction *fn, int block, IROp op) {
+    IRBlock *b = &fn->blocks[block];
+    b->instrs = (IRInstr*)grow(b->instrs, &b->capacity, b->count + 1, sizeof(IRInstr), 8);
+    IRInstr *instr = &b->instrs[b->count++];
+    memset(instr, 0, sizeof(IRInstr));
+    instr->op = op;
+    return instr;
+}
+
+// Inserta una instrucción antes de la posición 'index' del bloque
+IRInstr* ir_insert(IRFunction *fn, int block, int index, IROp op) {
+    IRBlock *b = &fn->blocks[block];
+    b->instrs = (IRInstr*)grow(b->instrs, &b->capacity, b->count + 1, sizeof(IRInstr), 8);
+    memmove(&b->instrs[index + 1], &b->instrs[index], (b->count - index) * sizeof(IRInstr));
+    b->count++;
+    IRInstr *instr = &b->instrs[index];
+    memset(instr, 0, sizeof(IRInstr));
+    instr->op = op;
+    return instr;
+}
+
+// Declara al inicio de la entrada, una sola vez, cada local, parámetro y
+// temporal que aparece en la función, y numera los temporales usados
+void ir_declare_locals(IRFunction *fn) {
+    char *used = (char*)calloc(fn->var_count + 1, 1);
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (op->kind == OPND_VAR) used[op->u.var] = 1;
+            }
+            if (instr->dst.kind == OPND_VAR) used[instr->dst.u.var] = 1;
+        }
+        if (block->term == TERM_BRANCH && block->cond.kind == OPND_VAR) used[block->cond.u.var] = 1;
+    }
+
+    int position = 0;
+    fn->temp_count = 0;
+    for (int v = 0; v < fn->var_count; v++) {
+        IRVarKind kind = fn->vars[v].kind;
+        if (!used[v] || kind == IRVAR_GLOBAL || kind == IRVAR_RETURN) continue;
+        if (kind == IRVAR_TEMP) fn->vars[v].temp_id = fn->temp_count++;
+        ir_insert(fn, fn->entry, position++, IR_VAR)->dst = ir_var(v);
+    }
+
+    free(used);
+}
+
+// Compacta los bloques quitando las instrucciones IR_NOP
+void ir_remove_nops(IRFunction *fn) {
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        int kept = 0;
+        for (int i = 0; i < block->count; i++) {
+            if (block->instrs[i].op == IR_NOP) {
+                free(block->instrs[i].args);
+                free(block->instrs[i].arg_blocks);
+                continue;
+            }
+            block->instrs[kept++] = block->instrs[i];
+        }
+        block->count = kept;
+    }
+}
+
+void ir_set_goto(IRFunction *fn, int block, int target) {
+    IRBlock *b = &fn->blocks[block];
+    b->term = TERM_GOTO;
+    b->succ[0] = target;
+    b->succ[1] = -1;
+}
+
+void ir_set_branch(IRFunction *fn, int block, Operand cond, int if_true, int if_false) {
+    IRBlock *b = &fn->blocks[block];
+    b->term = TERM_BRANCH;
+    b->cond = cond;
+    b->succ[0] = if_true;
+    b->succ[1] = if_false;
+}
+
+void ir_set_return(IRFunction *fn, int block) {
+    IRBlock *b = &fn->blocks[block];
+    b->term = TERM_RETURN;
+    b->succ[0] = -1;
+    b->succ[1] = -1;
+}
+
+void ir_set_halt(IRFunction *fn, int block) {
+    IRBlock *b = &fn->blocks[block];
+    b->term = TERM_HALT;
+    b->succ[0] = -1;
+    b->succ[1] = -1;
+}
+
+Operand ir_var(int var) {
+    Operand op;
+    op.kind = OPND_VAR;
+    op.u.var = var;
+    return op;
+}
+
+Operand ir_int(int value) {
+    Operand op;
+    op.kind = OPND_INT;
+    op.u.int_value = value;
+    return op;
+}
+
+Operand ir_float(float value) {
+    Operand op;
+    op.kind = OPND_FLOAT;
+    op.u.float_value = value;
+    return op;
+}
+
+Operand ir_string(const char *value) {
+    Operand op;
+    op.kind = OPND_STRING;
+    op.u.string_value = value;
+    return op;
+}
+
+Operand ir_none(void) {
+    Operand op;
+    op.kind = OPND_NONE;
+    op.u.int_value = 0;
+    return op;
+}
+
+int ir_operand_equal(Operand a, Operand b) {
+    if (a.kind != b.kind) return 0;
+    switch (a.kind) {
+        case OPND_VAR: return a.u.var == b.u.var;
+        case OPND_INT: return a.u.int_value == b.u.int_value;
+        case OPND_FLOAT: return a.u.float_value == b.u.float_value;
+        case OPND_STRING: return strcmp(a.u.string_value, b.u.string_value) == 0;
+        default: return 1;
+    }
+}
+
+int ir_successor_count(const IRBlock *block) {
+    switch (block->term) {
+        case TERM_GOTO: return 1;
+        case TERM_BRANCH: return 2;
+        default: return 0;
+    }
+}
+
+// Recalcula las listas de predecesores a partir de los sucesores
+void ir_compute_preds(IRFunction *fn) {
+    int *counts = (int*)calloc(fn->block_count + 1, sizeof(int));
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int s = 0; s < ir_successor_count(block); s++) {
+            counts[block->succ[s]]++;
+        }
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        free(block->preds);
+        block->preds = counts[b] ? (int*)malloc(counts[b] * sizeof(int)) : NULL;
+        block->pred_count = 0;
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int s = 0; s < ir_successor_count(block); s++) {
+            IRBlock *succ = &fn->blocks[block->succ[s]];
+            succ->preds[succ->pred_count++] = b;
+        }
+    }
+
+    free(counts);
+}
+
+// Marca con 1 los bloques alcanzables desde la entrada (el llamador libera)
+int* ir_reachable_blocks(IRFunction *fn) {
+    int *reachable = (int*)calloc(fn->block_count + 1, sizeof(int));
+    int *stack = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    int top = 0;
+
+    stack[top++] = fn->entry;
+    reachable[fn->entry] = 1;
+    while (top > 0) {
+        IRBlock *block = &fn->blocks[stack[--top]];
+        for (int s = 0; s < ir_successor_count(block); s++) {
+            int succ = block->succ[s];
+            if (!reachable[succ]) {
+                reachable[succ] = 1;
+                stack[top++] = succ;
+            }
+        }
+    }
+
+    free(stack);
+    return reachable;
+}
+
+IRStats ir_collect_stats(IRProgram *program) {
+    IRStats stats = {0, 0, 0, 0};
+
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        int *reachable = ir_reachable_blocks(fn);
+        stats.functions++;
+        for (int b = 0; b < fn->block_count; b++) {
+            if (!reachable[b]) continue;
+            stats.blocks++;
+            stats.edges += ir_successor_count(&fn->blocks[b]);
+            stats.instructions += fn->blocks[b].count;
+        }
+        free(reachable);
+    }
+
+    return stats;
+}
+
+int ir_fold_binary(IROp op, int a, int b, int *result) {
+    switch (op) {
+        case IR_ADD: *result = (int)((unsigned)a + (unsigned)b); return 1;
+        case IR_SUB: *result = (int)((unsigned)a - (unsigned)b); return 1;
+        case IR_MUL: *result = (int)((unsigned)a * (unsigned)b); return 1;
+        case IR_DIV:
+            if (b == 0) return 0;
+            *result = b == -1 ? (int)(0u - (unsigned)a) : a / b;
+            return 1;
+        case IR_MOD:
+            if (b == 0) return 0;
+            *result = b == -1 ? 0 : a % b;
+            return 1;
+        case IR_EQ: *result = a == b; return 1;
+        case IR_NE: *result = a != b; return 1;
+        case IR_LT: *result = a < b; return 1;
+        case IR_GT: *result = a > b; return 1;
+        case IR_LE: *result = a <= b; return 1;
+        case IR_GE: *result = a >= b; return 1;
+        case IR_AND: *result = a != 0 && b != 0; return 1;
+        case IR_OR: *result = a != 0 || b != 0; return 1;
+        default: return 0;
+    }
+}
+
+int ir_instr_def(const IRInstr *instr) {
+    if (instr->op == IR_VAR || instr->op == IR_NOP || instr->dst.kind != OPND_VAR) return -1;
+    return instr->dst.u.var;
+}
+
+int ir_use_count(const IRInstr *instr) {
+    return 3 + instr->arg_count;
+}
+
+Operand* ir_use_at(IRInstr *instr, int k) {
+    return k < 3 ? &instr->src[k] : &instr->args[k - 3];
+}
+
+// Conjunto de átomos (direccionamiento abierto sobre el puntero)
+typedef struct NameSet {
+    const char **names;
+    int *owners;        // Función que usa el nombre; -1 si son varias o es global
+    int capacity;
+    int count;
+} NameSet;
+
+static unsigned name_hash(const char *name) {
+    return (unsigned)(((uintptr_t)name >> 3) * 2654435761u);
+}
+
+static int* name_set_slot(NameSet *set, const char *name) {
+    unsigned mask = (unsigned)set->capacity - 1;
+    unsigned i = name_hash(name) & mask;
+    while (set->names[i] && set->names[i] != name) i = (i + 1) & mask;
+    if (!set->names[i]) return NULL;
+    return &set->owners[i];
+}
+
+static void name_set_add(NameSet *set, const char *name, int owner) {
+    unsigned mask = (unsigned)set->capacity - 1;
+    unsigned i = name_hash(name) & mask;
+    while (set->names[i] && set->names[i] != name) i = (i + 1) & mask;
+    if (set->names[i]) {
+        if (set->owners[i] != owner) set->owners[i] = -1;
+        return;
+    }
+    set->names[i] = name;
+    set->owners[i] = owner;
+    set->count++;
+}
+
+void ir_qualify_names(IRProgram *program) {
+    int total = program->global_count;
+    for (int f = 0; f < program->function_count; f++) {
+        total += program->functions[f]->var_count;
+    }
+
+    NameSet set;
+    set.capacity = 64;
+    while (set.capacity < total * 2) set.capacity *= 2;
+    set.names = (const char**)calloc(set.capacity, sizeof(const char*));
+    set.owners = (int*)malloc(set.capacity * sizeof(int));
+    set.count = 0;
+
+    for (int i = 0; i < program->global_count; i++) {
+        name_set_add(&set, program->globals[i]->name, -1);
+    }
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        for (int v = 0; v < fn->var_count; v++) {
+            IRVar *var = &fn->vars[v];
+            if (var->kind == IRVAR_LOCAL || var->kind == IRVAR_PARAM) {
+                name_set_add(&set, var->name, f);
+            }
+        }
+    }
+
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        for (int v = 0; v < fn->var_count; v++) {
+            IRVar *var = &fn->vars[v];
+            if (var->kind == IRVAR_LOCAL || var->kind == IRVAR_PARAM) {
+                var->qualified = *name_set_slot(&set, var->name) == -1;
+            }
+        }
+    }
+
+    free(set.names);
+    free(set.owners);
+}
+
+void ir_free_function(IRFunction *fn) {
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            free(block->instrs[i].args);
+            free(block->instrs[i].arg_blocks);
+        }
+        free(block->instrs);
+        free(block->preds);
+    }
+    free(fn->blocks);
+    free(fn->vars);
+    free(fn->layout);
+    free(fn);
+}
+
+void ir_free_program(IRProgram *program) {
+    if (!program) return;
+    for (int f = 0; f < program->function_count; f++) {
+        ir_free_function(program->functions[f]);
+    }
+    free(program->functions);
+    free(program->globals);
+    free(program);
+}
@@ -0,0 +1,210 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "symtable.h"
+#include "outbuf.h"
+
+// Representación intermedia de tres direcciones entre el AST y el texto
+// FIS-25. Cada función es un arreglo de bloques básicos; cada bloque tiene
+// instrucciones sin saltos y un terminador con aristas explícitas a sus
+// sucesores. Los bloques se identifican por su índice en la función.
+
+// Operandos
+typedef enum {
+    OPND_NONE,
+    OPND_VAR,       // Variable de la función (índice en IRFunction.vars)
+    OPND_INT,
+    OPND_FLOAT,
+    OPND_STRING
+} OperandKind;
+
+typedef struct Operand {
+    OperandKind kind;
+    union {
+        int var;
+        int int_value;
+        float float_value;
+        const char *string_value;
+    } u;
+} Operand;
+
+// Variables visibles desde una función
+typedef enum {
+    IRVAR_GLOBAL,   // Global del programa
+    IRVAR_RETURN,   // ret_<función>, compartida entre llamador y llamado
+    IRVAR_PARAM,
+    IRVAR_LOCAL,
+    IRVAR_TEMP
+} IRVarKind;
+
+typedef struct IRVar {
+    const char *name;   // Átomo; NULL en temporales
+    IRVarKind kind;
+    Symbol *symbol;     // Variable, o función dueña del valor de retorno
+    DataType type;
+    int temp_id;        // Número del temporal dentro de la función
+    int origin;         // Variable original de la que es versión (SSA)
+    int qualified;      // Se escribe como _<función>_<nombre> (ir_qualify_names)
+    int slot;           // Ranura compartida entre funciones (_s<slot>); -1 si no tiene
+} IRVar;
+
+typedef enum {
+    IR_VAR,         // Declara dst
+    IR_ASSIGN,      // dst = a
+    IR_ADD,         // dst = a op b
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,
+    IR_MOD,
+    IR_EQ,
+    IR_NE,
+    IR_LT,
+    IR_GT,
+    IR_LE,
+    IR_GE,
+    IR_AND,
+    IR_OR,
+    IR_PARAM_GET,   // dst = siguiente parámetro
+    IR_CALL,        // PARAM args... ; GOSUB callee
+    IR_PIXEL,       // pixel(a, b, c)
+    IR_KEY,         // dst = key(a)
+    IR_INPUT,       // dst = input()
+    IR_PRINT,       // print(a)
+    IR_PHI,         // dst = phi(args), solo dentro de las optimizaciones SSA
+    IR_NOP          // Instrucción eliminada, no se escribe
+} IROp;
+
+typedef struct IRInstr {
+    IROp op;
+    Operand dst;
+    Operand src[3];
+    Symbol *callee;     // IR_CALL
+    Operand *args;      // IR_CALL: argumentos en el orden en que se apilan
+    int *arg_blocks;    // IR_PHI: bloque predecesor de cada argumento
+    int arg_count;
+} IRInstr;
+
+typedef enum {
+    TERM_GOTO,      // Salta a succ[0]
+    TERM_BRANCH,    // Si cond es falsa salta a succ[1], si no a succ[0]
+    TERM_RETURN,
+    TERM_HALT       // Detiene la máquina: GOTO L0, el bucle final del programa
+} IRTermKind;
+
+typedef struct IRBlock {
+    IRInstr *instrs;
+    int count;
+    int capacity;
+    IRTermKind term;
+    Operand cond;
+    int succ[2];
+    int *preds;         // Calculados por ir_compute_preds
+    int pred_count;
+} IRBlock;
+
+typedef struct IRFunction {
+    const char *name;   // NULL: sentencias fuera de funciones
+    Symbol *symbol;
+    DataType return_type;
+
+    IRVar *vars;
+    int var_count;
+    int var_capacity;
+    int temp_count;
+
+    IRBlock *blocks;
+    int block_count;
+    int block_capacity;
+    int entry;
+
+    int *layout;        // Orden de los bloques en la salida
+    int layout_count;
+    int layout_capacity;
+
+    int optimized;      // Ya pasó por optimize_program (o se cargó así de la caché)
+    int inline_cost;    // Costo de expandirla que calculó optimize_program; -1 si no se expande
+} IRFunction;
+
+typedef struct IRProgram {
+    IRFunction **functions;
+    int function_count;
+    int function_capacity;
+
+    Symbol **globals;   // Variables y funciones globales en orden de declaración
+    int global_count;
+} IRProgram;
+
+// Estadísticas de la IR
+typedef struct IRStats {
+    int functions;
+    int blocks;
+    int edges;
+    int instructions;
+} IRStats;
+
+// Construcción
+IRProgram* ir_create_program(SymbolTable *table);
+IRFunction* ir_add_function(IRProgram *program, const char *name, Symbol *symbol, DataType return_type);
+int ir_new_block(IRFunction *fn);
+void ir_place_block(IRFunction *fn, int block);
+int ir_add_var(IRFunction *fn, IRVarKind kind, const char *name, Symbol *symbol, DataType type);
+IRInstr* ir_append(IRFunction *fn, int block, IROp op);
+IRInstr* ir_insert(IRFunction *fn, int block, int index, IROp op);
+void ir_remove_nops(IRFunction *fn);
+// VAR de las variables propias en el prólogo; la entrada no debe ser
+// destino de saltos
+void ir_declare_locals(IRFunction *fn);
+void ir_set_goto(IRFunction *fn, int block, int target);
+void ir_set_branch(IRFunction *fn, int block, Operand cond, int if_true, int if_false);
+void ir_set_return(IRFunction *fn, int block);
+void ir_set_halt(IRFunction *fn, int block);
+
+// Operandos
+Operand ir_var(int var);
+Operand ir_int(int value);
+Operand ir_float(float value);
+Operand ir_string(const char *value);
+Operand ir_none(void);
+int ir_operand_equal(Operand a, Operand b);
+
+// Análisis del CFG
+int ir_successor_count(const IRBlock *block);
+void ir_compute_preds(IRFunction *fn);
+int* ir_reachable_blocks(IRFunction *fn);
+IRStats ir_collect_stats(IRProgram *program);
+
+// Evalúa una operación binaria entera con la semántica de FIS-25
+// (aritmética circular). Devuelve 0 si no se puede evaluar en compilación
+// (división entre cero) o si 'op' no es binaria.
+int ir_fold_binary(IROp op, int a, int b, int *result);
+
+// Variable escrita por la instrucción, o -1
+int ir_instr_def(const IRInstr *instr);
+// Operandos leídos por la instrucción: src[0..2] y luego args
+int ir_use_count(const IRInstr *instr);
+Operand* ir_use_at(IRInstr *instr, int k);
+
+// Marca como 'qualified' las variables locales y parámetros cuyo nombre
+// coincide con un global o con una local de otra función: en FIS-25 todas
+// las variables comparten un único espacio de nombres
+void ir_qualify_names(IRProgram *program);
+
+void ir_free_function(IRFunction *fn);
+void ir_free_program(IRProgram *program);
+
+// Salida FIS-25 (ir_print.c): agrega el texto a 'output' y devuelve el
+// número de instrucciones escritas. Con threads > 1 las funciones se
+// escriben en paralelo, con el mismo texto.
+int ir_print_program(IRProgram *program, OutBuffer *output, int threads);
+
+// Nombre FIS-25 de una variable de 'fn'. Los temporales se numeran a partir
+// de 'temp_base', que avanza con el temp_count de cada función escrita.
+#define IR_NAME_MAX 256
+void ir_var_name(IRFunction *fn, int var, int temp_base, char *buffer, size_t size);
+
+// Salida en C portable (ir_print_c.c); devuelve el número de sentencias
+int ir_print_c_program(IRProgram *program, FILE *output);
+
+#endif
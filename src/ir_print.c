@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "pool.h"
+
+// Escritura de la IR como texto FIS-25. Solo se escriben los bloques
+// alcanzables, en el orden de 'layout'; un salto al bloque que sigue en la
+// salida se omite y solo llevan LABEL los bloques que son destino de un salto.
+// Los operandos ya son números (variable, entero, etiqueta), así que se
+// formatean directamente en el búfer de salida.
+
+typedef struct PrintContext {
+    OutBuffer *output;
+    int instructions;
+    int next_label;
+    int temp_base;      // Numeración global de temporales: _t<base + temp_id>
+} PrintContext;
+
+static void print_line(PrintContext *ctx, const char *line) {
+    out_str(ctx->output, line);
+    out_char(ctx->output, '\n');
+    if (line[0] != '\0' && line[0] != ';') {
+        ctx->instructions++;
+    }
+}
+
+void ir_var_name(IRFunction *fn, int var, int temp_base, char *buffer, size_t size) {
+    IRVar *v = &fn->vars[var];
+    if (v->slot >= 0) {
+        snprintf(buffer, size, "_s%d", v->slot);
+        return;
+    }
+    switch (v->kind) {
+        case IRVAR_TEMP:
+            snprintf(buffer, size, "_t%d", temp_base + v->temp_id);
+            break;
+        case IRVAR_RETURN:
+            snprintf(buffer, size, "ret_%s", v->name);
+            break;
+        case IRVAR_PARAM:
+        case IRVAR_LOCAL:
+            if (v->qualified) {
+                snprintf(buffer, size, "_%s_%s", fn->name, v->name);
+            } else {
+                snprintf(buffer, size, "%s", v->name);
+            }
+            break;
+        default:
+            snprintf(buffer, size, "%s", v->name);
+            break;
+    }
+}
+
+// Igual que ir_var_name, sin pasar por un arreglo intermedio
+static void print_var(PrintContext *ctx, IRFunction *fn, int var) {
+    OutBuffer *out = ctx->output;
+    IRVar *v = &fn->vars[var];
+    if (v->slot >= 0) {
+        out_str(out, "_s");
+        out_int(out, v->slot);
+        return;
+    }
+    switch (v->kind) {
+        case IRVAR_TEMP:
+            out_str(out, "_t");
+            out_int(out, ctx->temp_base + v->temp_id);
+            break;
+        case IRVAR_RETURN:
+            out_str(out, "ret_");
+            out_str(out, v->name);
+            break;
+        case IRVAR_PARAM:
+        case IRVAR_LOCAL:
+            if (v->qualified) {
+                out_char(out, '_');
+                out_str(out, fn->name);
+                out_char(out, '_');
+            }
+            out_str(out, v->name);
+            break;
+        default:
+            out_str(out, v->name);
+            break;
+    }
+}
+
+static void print_operand(PrintContext *ctx, IRFunction *fn, Operand op) {
+    OutBuffer *out = ctx->output;
+
+    switch (op.kind) {
+        case OPND_VAR:
+            print_var(ctx, fn, op.u.var);
+            break;
+        case OPND_INT:
+            out_int(out, op.u.int_value);
+            break;
+        case OPND_FLOAT:
+            out_float(out, op.u.float_value);
+            break;
+        case OPND_STRING:
+            out_str(out, op.u.string_value);
+            break;
+        default:
+            break;
+    }
+}
+
+// Escribe "OPCODE op1 op2 ..." y cuenta la instrucción
+static void print_instr(PrintContext *ctx, IRFunction *fn, const char *opcode,
+                        const Operand *ops, int count) {
+    out_str(ctx->output, opcode);
+    for (int i = 0; i < count; i++) {
+        out_char(ctx->output, ' ');
+        print_operand(ctx, fn, ops[i]);
+    }
+    out_char(ctx->output, '\n');
+    ctx->instructions++;
+}
+
+static const char* binary_opcode(IROp op) {
+    switch (op) {
+        case IR_ADD: return "ADD";
+        case IR_SUB: return "SUB";
+        case IR_MUL: return "MUL";
+        case IR_DIV: return "DIV";
+        case IR_MOD: return "MOD";
+        case IR_EQ: return "EQ";
+        case IR_NE: return "NEQ";
+        case IR_LT: return "LT";
+        case IR_GT: return "GT";
+        case IR_LE: return "LTE";
+        case IR_GE: return "GTE";
+        case IR_AND: return "AND";
+        case IR_OR: return "OR";
+        default: return NULL;
+    }
+}
+
+static void print_instruction(PrintContext *ctx, IRFunction *fn, IRInstr *instr) {
+    Operand ops[3];
+
+    switch (instr->op) {
+        case IR_VAR:
+            print_instr(ctx, fn, "VAR", &instr->dst, 1);
+            break;
+        case IR_ASSIGN:
+            ops[0] = instr->src[0];
+            ops[1] = instr->dst;
+            print_instr(ctx, fn, "ASSIGN", ops, 2);
+            break;
+        case IR_PARAM_GET:
+            print_instr(ctx, fn, "PARAM_GET", &instr->dst, 1);
+            break;
+        case IR_CALL:
+            for (int i = 0; i < instr->arg_count; i++) {
+                print_instr(ctx, fn, "PARAM", &instr->args[i], 1);
+            }
+            out_str(ctx->output, "GOSUB func_");
+            out_str(ctx->output, instr->callee->name);
+            out_char(ctx->output, '\n');
+            ctx->instructions++;
+            break;
+        case IR_PIXEL:
+            print_instr(ctx, fn, "PIXEL", instr->src, 3);
+            break;
+        case IR_KEY:
+            ops[0] = instr->src[0];
+            ops[1] = instr->dst;
+            print_instr(ctx, fn, "KEY", ops, 2);
+            break;
+        case IR_INPUT:
+            print_instr(ctx, fn, "INPUT", &instr->dst, 1);
+            break;
+        case IR_PRINT:
+            print_instr(ctx, fn, "PRINT", instr->src, 1);
+            break;
+        case IR_NOP:
+            break;
+        case IR_PHI:
+            fprintf(stderr, "Error interno: nodo phi en la salida FIS-25\n");
+            exit(1);
+        default:
+            ops[0] = instr->src[0];
+            ops[1] = instr->src[1];
+            ops[2] = instr->dst;
+            print_instr(ctx, fn, binary_opcode(instr->op), ops, 3);
+            break;
+    }
+}
+
+static void print_jump(PrintContext *ctx, const char *prefix, int label) {
+    out_str(ctx->output, prefix);
+    out_str(ctx->output, "GOTO L");
+    out_int(ctx->output, label);
+    out_char(ctx->output, '\n');
+    ctx->instructions++;
+}
+
+// Orden de salida de una función y sus etiquetas, numeradas desde 0 dentro
+// de la función; al escribirla se les suma la base que le toca
+typedef struct FunctionLayout {
+    int *order;         // Bloques alcanzables en orden de salida
+    int count;
+    int *labels;        // Etiqueta de cada bloque; -1 si no lleva
+    int label_count;
+} FunctionLayout;
+
+static void layout_function(IRFunction *fn, FunctionLayout *layout) {
+    int *reachable = ir_reachable_blocks(fn);
+    int *labels = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    int *order = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    int *placed = (int*)calloc(fn->block_count + 1, sizeof(int));
+    int count = 0;
+
+    // Bloques alcanzables en orden de salida
+    for (int i = 0; i < fn->layout_count; i++) {
+        int b = fn->layout[i];
+        if (reachable[b] && !placed[b]) {
+            placed[b] = 1;
+            order[count++] = b;
+        }
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        if (reachable[b] && !placed[b]) {
+            order[count++] = b;
+        }
+        labels[b] = -1;
+    }
+
+    // Primera pasada: qué bloques necesitan etiqueta
+    for (int i = 0; i < count; i++) {
+        IRBlock *block = &fn->blocks[order[i]];
+        int next = i + 1 < count ? order[i + 1] : -1;
+        if (block->term == TERM_GOTO && block->succ[0] != next) {
+            labels[block->succ[0]] = 0;
+        } else if (block->term == TERM_BRANCH) {
+            labels[block->succ[1]] = 0;
+            if (block->succ[0] != next) labels[block->succ[0]] = 0;
+        }
+    }
+    layout->label_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (labels[order[i]] == 0) labels[order[i]] = layout->label_count++;
+    }
+
+    layout->order = order;
+    layout->count = count;
+    layout->labels = labels;
+    free(placed);
+    free(reachable);
+}
+
+static void free_layout(FunctionLayout *layout) {
+    free(layout->order);
+    free(layout->labels);
+}
+
+// Escribe la función con sus etiquetas a partir de ctx->next_label y sus
+// temporales a partir de ctx->temp_base
+static void print_function(PrintContext *ctx, IRFunction *fn, const FunctionLayout *layout) {
+    const int *order = layout->order;
+    int count = layout->count;
+    int base = ctx->next_label;
+    int labels_end = base + layout->label_count;
+    int *labels = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    for (int b = 0; b < fn->block_count; b++) {
+        labels[b] = layout->labels[b] >= 0 ? base + layout->labels[b] : -1;
+    }
+
+    if (fn->name) {
+        print_line(ctx, "");
+    }
+
+    for (int i = 0; i < count; i++) {
+        int b = order[i];
+        IRBlock *block = &fn->blocks[b];
+        int next = i + 1 < count ? order[i + 1] : -1;
+
+        if (b == fn->entry && fn->name) {
+            out_str(ctx->output, "LABEL func_");
+            out_str(ctx->output, fn->name);
+            out_char(ctx->output, '\n');
+            ctx->instructions++;
+        }
+        if (labels[b] >= 0) {
+            out_str(ctx->output, "LABEL L");
+            out_int(ctx->output, labels[b]);
+            out_char(ctx->output, '\n');
+            ctx->instructions++;
+        }
+
+        for (int j = 0; j < block->count; j++) {
+            print_instruction(ctx, fn, &block->instrs[j]);
+        }
+
+        switch (block->term) {
+            case TERM_GOTO:
+                if (block->succ[0] != next) print_jump(ctx, "", labels[block->succ[0]]);
+                break;
+            case TERM_BRANCH:
+                out_str(ctx->output, "IFFALSE ");
+                print_operand(ctx, fn, block->cond);
+                print_jump(ctx, " ", labels[block->succ[1]]);
+                if (block->succ[0] != next) print_jump(ctx, "", labels[block->succ[0]]);
+                break;
+            case TERM_RETURN:
+                print_line(ctx, "RETURN");
+                break;
+            case TERM_HALT:
+                print_jump(ctx, "", 0);
+                break;
+        }
+    }
+
+    ctx->next_label = labels_end;
+    ctx->temp_base += fn->temp_count;
+    free(labels);
+}
+
+// Con varios hilos cada función se escribe en su propio búfer y los
+// búferes se copian al de la salida en el orden del programa. Las etiquetas y
+// los temporales de cada función empiezan donde terminan los de la
+// anterior, así que el texto es el mismo que con un hilo.
+typedef struct PrintJob {
+    IRProgram *program;
+    FunctionLayout *layouts;
+    int *label_base;
+    int *temp_base;
+    OutBuffer *text;
+    int *instructions;
+} PrintJob;
+
+static void layout_task(void *data, int worker, int f) {
+    PrintJob *job = (PrintJob*)data;
+    (void)worker;
+    layout_function(job->program->functions[f], &job->layouts[f]);
+}
+
+static void print_task(void *data, int worker, int f) {
+    PrintJob *job = (PrintJob*)data;
+    (void)worker;
+    PrintContext ctx;
+    out_init(&job->text[f]);
+    ctx.output = &job->text[f];
+    ctx.instructions = 0;
+    ctx.next_label = job->label_base[f];
+    ctx.temp_base = job->temp_base[f];
+    print_function(&ctx, job->program->functions[f], &job->layouts[f]);
+    job->instructions[f] = ctx.instructions;
+    free_layout(&job->layouts[f]);
+}
+
+static void print_functions_parallel(PrintContext *ctx, IRProgram *program, int threads) {
+    int n = program->function_count;
+    PrintJob job;
+    job.program = program;
+    job.layouts = (FunctionLayout*)malloc((n + 1) * sizeof(FunctionLayout));
+    job.label_base = (int*)malloc((n + 1) * sizeof(int));
+    job.temp_base = (int*)malloc((n + 1) * sizeof(int));
+    job.text = (OutBuffer*)malloc((n + 1) * sizeof(OutBuffer));
+    job.instructions = (int*)calloc(n + 1, sizeof(int));
+
+    pool_run(threads, n, NULL, NULL, layout_task, &job);
+    for (int f = 0; f < n; f++) {
+        job.label_base[f] = ctx->next_label;
+        job.temp_base[f] = ctx->temp_base;
+        ctx->next_label += job.layouts[f].label_count;
+        ctx->temp_base += program->functions[f]->temp_count;
+    }
+    pool_run(threads, n, NULL, NULL, print_task, &job);
+
+    for (int f = 0; f < n; f++) {
+        out_append(ctx->output, &job.text[f]);
+        ctx->instructions += job.instructions[f];
+        out_free(&job.text[f]);
+    }
+
+    free(job.layouts);
+    free(job.label_base);
+    free(job.temp_base);
+    free(job.text);
+    free(job.instructions);
+}
+
+int ir_print_program(IRProgram *program, OutBuffer *output, int threads) {
+    PrintContext ctx;
+    ctx.output = output;
+    ctx.instructions = 0;
+    ctx.next_label = 1;     // L0 es el bucle final del programa
+    ctx.temp_base = 0;
+
+    print_line(&ctx, "; Código generado por el compilador FIS-25");
+    print_line(&ctx, "; Arquitectura: FIS-25");
+
+    for (int i = 0; i < program->global_count; i++) {
+        Symbol *sym = program->globals[i];
+        if (sym->is_function) {
+            if (sym->return_type != TYPE_VOID) {
+                out_str(output, "VAR ret_");
+                out_str(output, sym->name);
+                out_char(output, '\n');
+                ctx.instructions++;
+            }
+        } else if (sym->is_array) {
+            for (int e = 0; e < sym->array_size; e++) {
+                out_str(output, "VAR ");
+                out_str(output, sym->elements[e].name);
+                out_char(output, '\n');
+                ctx.instructions++;
+            }
+        } else {
+            out_str(output, "VAR ");
+            out_str(output, sym->name);
+            out_char(output, '\n');
+            ctx.instructions++;
+        }
+    }
+
+    print_line(&ctx, "");
+    print_line(&ctx, "GOSUB func_main");
+    print_line(&ctx, "LABEL L0");
+    print_line(&ctx, "GOTO L0");
+    print_line(&ctx, "");
+
+    if (threads > 1) {
+        print_functions_parallel(&ctx, program, threads);
+    } else {
+        for (int f = 0; f < program->function_count; f++) {
+            FunctionLayout layout;
+            layout_function(program->functions[f], &layout);
+            print_function(&ctx, program->functions[f], &layout);
+            free_layout(&layout);
+        }
+    }
+
+    print_line(&ctx, "; Fin del programa");
+    return ctx.instructions;
+}
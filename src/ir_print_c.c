@@ -0,0 +1,653 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+// Salida en C portable de la misma IR que se escribe como FIS-25, para
+// compilar un programa a binario nativo con gcc y usarlo como oráculo
+// rápido frente a la máquina virtual.
+//
+// El binario reproduce la semántica de FIS-25 y no la de C: cada variable
+// FIS-25 es un global de C (una llamada recursiva pisa las del llamador),
+// los valores llevan su tipo como en la máquina virtual (un int asignado a
+// una variable float sigue siendo int) y la aritmética entera es circular.
+// Acepta las mismas opciones --key, --keys, --input y --fb que la máquina.
+
+static const char *runtime[] = {
+    "#include <stdio.h>",
+    "#include <stdlib.h>",
+    "#include <string.h>",
+    "#include <ctype.h>",
+    "",
+    "#define FB_SIZE 64",
+    "#define CALL_STACK_MAX 4096",
+    "#define PARAM_STACK_MAX 65536",
+    "#define MAX_KEY_EVENTS 256",
+    "#define MAX_INPUTS 256",
+    "",
+    "/* Cada programa usa solo parte de estas funciones */",
+    "#if defined(__GNUC__)",
+    "#define FIS_UNUSED __attribute__((unused))",
+    "#else",
+    "#define FIS_UNUSED",
+    "#endif",
+    "",
+    "enum { VAL_INT, VAL_FLOAT, VAL_STRING };",
+    "enum { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_EQ, OP_NEQ, OP_LT, OP_GT, OP_LTE, OP_GTE };",
+    "",
+    "typedef struct Value {",
+    "    int kind;",
+    "    union {",
+    "        int i;",
+    "        double f;",
+    "        const char *s;",
+    "    } as;",
+    "} Value;",
+    "",
+    "typedef struct KeyEvent {",
+    "    int key;",
+    "    long from;",
+    "    long to;",
+    "} KeyEvent;",
+    "",
+    "static Value param_stack[PARAM_STACK_MAX];",
+    "static int param_depth;",
+    "static int call_depth;",
+    "static int framebuffer[FB_SIZE][FB_SIZE];",
+    "static KeyEvent key_events[MAX_KEY_EVENTS];",
+    "static int key_event_count;",
+    "static long key_reads;",
+    "static Value inputs[MAX_INPUTS];",
+    "static int input_count;",
+    "static int next_input;",
+    "",
+    "static void fatal(const char *message) {",
+    "    fprintf(stderr, \"Error: %s\\n\", message);",
+    "    exit(1);",
+    "}",
+    "",
+    "static Value fis_int(int i) {",
+    "    Value value;",
+    "    value.kind = VAL_INT;",
+    "    value.as.i = i;",
+    "    return value;",
+    "}",
+    "",
+    "static Value fis_float(double f) {",
+    "    Value value;",
+    "    value.kind = VAL_FLOAT;",
+    "    value.as.f = f;",
+    "    return value;",
+    "}",
+    "",
+    "FIS_UNUSED static Value fis_string(const char *s) {",
+    "    Value value;",
+    "    value.kind = VAL_STRING;",
+    "    value.as.s = s;",
+    "    return value;",
+    "}",
+    "",
+    "FIS_UNUSED static double as_float(Value value) {",
+    "    return value.kind == VAL_FLOAT ? value.as.f : (double)value.as.i;",
+    "}",
+    "",
+    "FIS_UNUSED static int as_int(Value value) {",
+    "    if (value.kind == VAL_STRING) fatal(\"se esperaba un número\");",
+    "    return value.kind == VAL_FLOAT ? (int)value.as.f : value.as.i;",
+    "}",
+    "",
+    "FIS_UNUSED static int is_true(Value value) {",
+    "    if (value.kind == VAL_FLOAT) return value.as.f != 0.0;",
+    "    if (value.kind == VAL_STRING) return value.as.s[0] != '\\0';",
+    "    return value.as.i != 0;",
+    "}",
+    "",
+    "FIS_UNUSED static Value arithmetic(int op, Value a, Value b) {",
+    "    if (a.kind == VAL_STRING || b.kind == VAL_STRING) fatal(\"operación aritmética sobre una cadena\");",
+    "    if (a.kind == VAL_FLOAT || b.kind == VAL_FLOAT) {",
+    "        double x = as_float(a), y = as_float(b);",
+    "        switch (op) {",
+    "            case OP_ADD: return fis_float(x + y);",
+    "            case OP_SUB: return fis_float(x - y);",
+    "            case OP_MUL: return fis_float(x * y);",
+    "            case OP_DIV:",
+    "                if (y == 0.0) fatal(\"división entre cero\");",
+    "                return fis_float(x / y);",
+    "            default:",
+    "                fatal(\"MOD requiere operandos enteros\");",
+    "        }",
+    "    }",
+    "    int x = a.as.i, y = b.as.i;",
+    "    switch (op) {",
+    "        case OP_ADD: return fis_int((int)((unsigned)x + (unsigned)y));",
+    "        case OP_SUB: return fis_int((int)((unsigned)x - (unsigned)y));",
+    "        case OP_MUL: return fis_int((int)((unsigned)x * (unsigned)y));",
+    "        case OP_DIV:",
+    "            if (y == 0) fatal(\"división entre cero\");",
+    "            return fis_int(y == -1 ? (int)(0u - (unsigned)x) : x / y);",
+    "        default:",
+    "            if (y == 0) fatal(\"división entre cero\");",
+    "            return fis_int(y == -1 ? 0 : x % y);",
+    "    }",
+    "}",
+    "",
+    "FIS_UNUSED static Value compare(int op, Value a, Value b) {",
+    "    if (a.kind == VAL_STRING || b.kind == VAL_STRING) {",
+    "        if (a.kind != b.kind) fatal(\"comparación entre cadena y número\");",
+    "        int cmp = strcmp(a.as.s, b.as.s);",
+    "        if (op == OP_EQ) return fis_int(cmp == 0);",
+    "        if (op == OP_NEQ) return fis_int(cmp != 0);",
+    "        fatal(\"comparación relacional sobre cadenas\");",
+    "    }",
+    "    double x = as_float(a), y = as_float(b);",
+    "    switch (op) {",
+    "        case OP_EQ: return fis_int(x == y);",
+    "        case OP_NEQ: return fis_int(x != y);",
+    "        case OP_LT: return fis_int(x < y);",
+    "        case OP_GT: return fis_int(x > y);",
+    "        case OP_LTE: return fis_int(x <= y);",
+    "        default: return fis_int(x >= y);",
+    "    }",
+    "}",
+    "",
+    "FIS_UNUSED static void enter(void) {",
+    "    if (call_depth == CALL_STACK_MAX) fatal(\"desbordamiento de la pila de llamadas\");",
+    "    call_depth++;",
+    "}",
+    "",
+    "FIS_UNUSED static void push(Value value) {",
+    "    if (param_depth == PARAM_STACK_MAX) fatal(\"desbordamiento de la pila de parámetros\");",
+    "    param_stack[param_depth++] = value;",
+    "}",
+    "",
+    "FIS_UNUSED static Value pop(void) {",
+    "    if (param_depth == 0) fatal(\"PARAM_GET sin parámetros en la pila\");",
+    "    return param_stack[--param_depth];",
+    "}",
+    "",
+    "FIS_UNUSED static void pixel(Value x, Value y, Value color) {",
+    "    int px = as_int(x), py = as_int(y), c = as_int(color);",
+    "    if (px >= 0 && px < FB_SIZE && py >= 0 && py < FB_SIZE) framebuffer[py][px] = c;",
+    "}",
+    "",
+    "FIS_UNUSED static Value key(Value id) {",
+    "    int k = as_int(id), pressed = 0;",
+    "    for (int i = 0; i < key_event_count; i++) {",
+    "        KeyEvent *event = &key_events[i];",
+    "        if (event->key == k && key_reads >= event->from && (event->to < 0 || key_reads < event->to)) {",
+    "            pressed = 1;",
+    "        }",
+    "    }",
+    "    key_reads++;",
+    "    return fis_int(pressed);",
+    "}",
+    "",
+    "FIS_UNUSED static Value input(void) {",
+    "    return next_input < input_count ? inputs[next_input++] : fis_int(0);",
+    "}",
+    "",
+    "FIS_UNUSED static void print(Value value) {",
+    "    switch (value.kind) {",
+    "        case VAL_INT: printf(\"%d\\n\", value.as.i); break;",
+    "        case VAL_FLOAT: printf(\"%f\\n\", value.as.f); break;",
+    "        default: printf(\"%s\\n\", value.as.s); break;",
+    "    }",
+    "}",
+    "",
+    "static void add_key_event(const char *spec) {",
+    "    if (key_event_count == MAX_KEY_EVENTS) fatal(\"demasiados eventos de teclado\");",
+    "    KeyEvent *event = &key_events[key_event_count];",
+    "    event->to = -1;",
+    "    if (sscanf(spec, \"%d:%ld:%ld\", &event->key, &event->from, &event->to) < 2) {",
+    "        fatal(\"evento de teclado inválido (TECLA:DESDE[:HASTA])\");",
+    "    }",
+    "    key_event_count++;",
+    "}",
+    "",
+    "static void load_key_script(const char *path) {",
+    "    FILE *file = fopen(path, \"r\");",
+    "    char line[256];",
+    "    if (!file) fatal(\"no se puede abrir el guion de teclas\");",
+    "    while (fgets(line, sizeof(line), file)) {",
+    "        char *p = line;",
+    "        while (isspace((unsigned char)*p)) p++;",
+    "        if (*p != '\\0' && *p != '#') add_key_event(p);",
+    "    }",
+    "    fclose(file);",
+    "}",
+    "",
+    "static void add_input(const char *text) {",
+    "    if (input_count == MAX_INPUTS) fatal(\"demasiados valores de entrada\");",
+    "    inputs[input_count++] = strchr(text, '.') ? fis_float(atof(text)) : fis_int(atoi(text));",
+    "}",
+    "",
+    "static void dump_framebuffer(const char *path) {",
+    "    FILE *file = fopen(path, \"w\");",
+    "    int max_color = 1;",
+    "    if (!file) fatal(\"no se puede crear el archivo del framebuffer\");",
+    "    for (int y = 0; y < FB_SIZE; y++) {",
+    "        for (int x = 0; x < FB_SIZE; x++) {",
+    "            if (framebuffer[y][x] > max_color) max_color = framebuffer[y][x];",
+    "        }",
+    "    }",
+    "    fprintf(file, \"P2\\n%d %d\\n%d\\n\", FB_SIZE, FB_SIZE, max_color);",
+    "    for (int y = 0; y < FB_SIZE; y++) {",
+    "        for (int x = 0; x < FB_SIZE; x++) {",
+    "            int color = framebuffer[y][x];",
+    "            fprintf(file, \"%d%c\", color < 0 ? 0 : color, x == FB_SIZE - 1 ? '\\n' : ' ');",
+    "        }",
+    "    }",
+    "    fclose(file);",
+    "}",
+    "",
+    "// GOTO L0 en FIS-25: la máquina se detiene como al terminar main",
+    "static const char *fb_path = NULL;",
+    "",
+    "FIS_UNUSED static void halt(void) {",
+    "    if (fb_path) dump_framebuffer(fb_path);",
+    "    exit(0);",
+    "}",
+    NULL
+};
+
+// Conjunto de nombres de variables ya declaradas como globales de C
+typedef struct NameSet {
+    char **names;
+    int capacity;
+    int count;
+} NameSet;
+
+static unsigned name_hash(const char *name) {
+    unsigned hash = 2166136261u;
+    for (; *name; name++) hash = (hash ^ (unsigned char)*name) * 16777619u;
+    return hash;
+}
+
+// Devuelve 1 si el nombre es nuevo
+static int name_set_add(NameSet *set, const char *name) {
+    if (2 * (set->count + 1) > set->capacity) {
+        NameSet grown;
+        grown.capacity = set->capacity ? set->capacity * 2 : 256;
+        grown.count = 0;
+        grown.names = (char**)calloc(grown.capacity, sizeof(char*));
+        for (int i = 0; i < set->capacity; i++) {
+            if (!set->names[i]) continue;
+            unsigned slot = name_hash(set->names[i]) & (grown.capacity - 1);
+            while (grown.names[slot]) slot = (slot + 1) & (grown.capacity - 1);
+            grown.names[slot] = set->names[i];
+            grown.count++;
+        }
+        free(set->names);
+        *set = grown;
+    }
+
+    unsigned slot = name_hash(name) & (set->capacity - 1);
+    while (set->names[slot]) {
+        if (strcmp(set->names[slot], name) == 0) return 0;
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->names[slot] = strdup(name);
+    set->count++;
+    return 1;
+}
+
+static void name_set_free(NameSet *set) {
+    for (int i = 0; i < set->capacity; i++) free(set->names[i]);
+    free(set->names);
+}
+
+typedef struct CContext {
+    FILE *output;
+    int statements;
+    int temp_base;
+} CContext;
+
+// Nombre en C de una variable FIS-25. Un elemento de array (a[3]) no es un
+// identificador de C: se escribe e_a_3, con un prefijo que no usa ninguna
+// otra variable.
+static void print_c_name(FILE *out, const char *name) {
+    const char *bracket = strchr(name, '[');
+    if (bracket) {
+        fprintf(out, "e_%.*s_%d", (int)(bracket - name), name, atoi(bracket + 1));
+    } else {
+        fprintf(out, "v_%s", name);
+    }
+}
+
+static void print_operand(CContext *ctx, IRFunction *fn, Operand op) {
+    FILE *out = ctx->output;
+    char name[IR_NAME_MAX];
+
+    switch (op.kind) {
+        case OPND_VAR:
+            ir_var_name(fn, op.u.var, ctx->temp_base, name, sizeof(name));
+            print_c_name(out, name);
+            break;
+        case OPND_INT:
+            fprintf(out, "fis_int(%d)", op.u.int_value);
+            break;
+        case OPND_FLOAT:
+            // El mismo texto que lee la máquina virtual
+            fprintf(out, "fis_float(%f)", op.u.float_value);
+            break;
+        case OPND_STRING: {
+            // La máquina virtual imprime el contenido tal cual, sin
+            // interpretar secuencias de escape
+            const char *s = op.u.string_value;
+            size_t len = strlen(s);
+            fputs("fis_string(\"", out);
+            for (size_t i = 1; i + 1 < len; i++) {
+                if (s[i] == '\\' || s[i] == '"') fputc('\\', out);
+                fputc(s[i], out);
+            }
+            fputs("\")", out);
+            break;
+        }
+        default:
+            fputs("fis_int(0)", out);
+            break;
+    }
+}
+
+static const char* c_binary_op(IROp op) {
+    switch (op) {
+        case IR_ADD: return "OP_ADD";
+        case IR_SUB: return "OP_SUB";
+        case IR_MUL: return "OP_MUL";
+        case IR_DIV: return "OP_DIV";
+        case IR_MOD: return "OP_MOD";
+        case IR_EQ: return "OP_EQ";
+        case IR_NE: return "OP_NEQ";
+        case IR_LT: return "OP_LT";
+        case IR_GT: return "OP_GT";
+        case IR_LE: return "OP_LTE";
+        default: return "OP_GTE";
+    }
+}
+
+// "    dst = " antes del valor de una instrucción
+static void print_target(CContext *ctx, IRFunction *fn, Operand dst) {
+    fputs("    ", ctx->output);
+    print_operand(ctx, fn, dst);
+    fputs(" = ", ctx->output);
+}
+
+static void print_instruction(CContext *ctx, IRFunction *fn, IRInstr *instr) {
+    FILE *out = ctx->output;
+
+    switch (instr->op) {
+        case IR_VAR:
+        case IR_NOP:
+            return;
+        case IR_ASSIGN:
+            print_target(ctx, fn, instr->dst);
+            print_operand(ctx, fn, instr->src[0]);
+            fputs(";\n", out);
+            break;
+        case IR_PARAM_GET:
+            print_target(ctx, fn, instr->dst);
+            fputs("pop();\n", out);
+            break;
+        case IR_CALL:
+            for (int i = 0; i < instr->arg_count; i++) {
+                fputs("    push(", out);
+                print_operand(ctx, fn, instr->args[i]);
+                fputs(");\n", out);
+            }
+            fprintf(out, "    f_%s();\n", instr->callee->name);
+            break;
+        case IR_PIXEL:
+            fputs("    pixel(", out);
+            for (int i = 0; i < 3; i++) {
+                if (i > 0) fputs(", ", out);
+                print_operand(ctx, fn, instr->src[i]);
+            }
+            fputs(");\n", out);
+            break;
+        case IR_KEY:
+            print_target(ctx, fn, instr->dst);
+            fputs("key(", out);
+            print_operand(ctx, fn, instr->src[0]);
+            fputs(");\n", out);
+            break;
+        case IR_INPUT:
+            print_target(ctx, fn, instr->dst);
+            fputs("input();\n", out);
+            break;
+        case IR_PRINT:
+            fputs("    print(", out);
+            print_operand(ctx, fn, instr->src[0]);
+            fputs(");\n", out);
+            break;
+        case IR_AND:
+        case IR_OR:
+            print_target(ctx, fn, instr->dst);
+            fputs("fis_int(is_true(", out);
+            print_operand(ctx, fn, instr->src[0]);
+            fputs(instr->op == IR_AND ? ") && is_true(" : ") || is_true(", out);
+            print_operand(ctx, fn, instr->src[1]);
+            fputs("));\n", out);
+            break;
+        case IR_PHI:
+            fprintf(stderr, "Error interno: nodo phi en la salida C\n");
+            exit(1);
+        default:
+            print_target(ctx, fn, instr->dst);
+            fprintf(out, "%s(%s, ", instr->op >= IR_EQ ? "compare" : "arithmetic", c_binary_op(instr->op));
+            print_operand(ctx, fn, instr->src[0]);
+            fputs(", ", out);
+            print_operand(ctx, fn, instr->src[1]);
+            fputs(");\n", out);
+            break;
+    }
+    ctx->statements++;
+}
+
+static void declare_var(CContext *ctx, NameSet *declared, IRFunction *fn, Operand op) {
+    char name[IR_NAME_MAX];
+    if (op.kind != OPND_VAR) return;
+    ir_var_name(fn, op.u.var, ctx->temp_base, name, sizeof(name));
+    if (!name_set_add(declared, name)) return;
+    fputs("static Value ", ctx->output);
+    print_c_name(ctx->output, name);
+    fputs(";\n", ctx->output);
+}
+
+// Globales de C para las variables que aparecen en el código que se
+// escribe de la función (bloques alcanzables, sin las declaraciones VAR)
+static void declare_function_vars(CContext *ctx, NameSet *declared, IRFunction *fn) {
+    int *reachable = ir_reachable_blocks(fn);
+    for (int b = 0; b < fn->block_count; b++) {
+        if (!reachable[b]) continue;
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            if (instr->op == IR_VAR || instr->op == IR_NOP) continue;
+            if (ir_instr_def(instr) >= 0) declare_var(ctx, declared, fn, instr->dst);
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                declare_var(ctx, declared, fn, *ir_use_at(instr, k));
+            }
+        }
+        if (block->term == TERM_BRANCH) declare_var(ctx, declared, fn, block->cond);
+    }
+    free(reachable);
+}
+
+// Funciones a las que se llega desde main por llamadas en bloques
+// alcanzables. Las demás (expandidas en línea en todos sus usos o
+// evaluadas al compilar) no se escriben. Como build_call_graph, numera las
+// funciones en el campo 'address' de su símbolo.
+static int* reached_functions(IRProgram *program) {
+    int n = program->function_count;
+    int *reached = (int*)calloc(n + 1, sizeof(int));
+    int *work = (int*)malloc((n + 1) * sizeof(int));
+    int count = 0;
+
+    for (int i = 0; i < program->global_count; i++) {
+        if (program->globals[i]->is_function) program->globals[i]->address = -1;
+    }
+    for (int f = 0; f < n; f++) {
+        IRFunction *fn = program->functions[f];
+        if (fn->symbol) fn->symbol->address = f;
+        if (fn->name && strcmp(fn->name, "main") == 0 && !reached[f]) {
+            reached[f] = 1;
+            work[count++] = f;
+        }
+    }
+
+    while (count > 0) {
+        IRFunction *fn = program->functions[work[--count]];
+        int *reachable = ir_reachable_blocks(fn);
+        for (int b = 0; b < fn->block_count; b++) {
+            if (!reachable[b]) continue;
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i < block->count; i++) {
+                if (block->instrs[i].op != IR_CALL) continue;
+                int callee = block->instrs[i].callee->address;
+                if (callee < 0 || reached[callee]) continue;
+                reached[callee] = 1;
+                work[count++] = callee;
+            }
+        }
+        free(reachable);
+    }
+
+    free(work);
+    return reached;
+}
+
+static void print_function(CContext *ctx, IRFunction *fn) {
+    FILE *out = ctx->output;
+    int *reachable = ir_reachable_blocks(fn);
+    int *order = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    int *placed = (int*)calloc(fn->block_count + 1, sizeof(int));
+    int *labeled = (int*)calloc(fn->block_count + 1, sizeof(int));
+    int count = 0;
+
+    for (int i = 0; i < fn->layout_count; i++) {
+        int b = fn->layout[i];
+        if (reachable[b] && !placed[b]) {
+            placed[b] = 1;
+            order[count++] = b;
+        }
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        if (reachable[b] && !placed[b]) order[count++] = b;
+    }
+
+    // Solo llevan etiqueta los bloques a los que se salta
+    for (int i = 0; i < count; i++) {
+        IRBlock *block = &fn->blocks[order[i]];
+        int next = i + 1 < count ? order[i + 1] : -1;
+        if (block->term == TERM_BRANCH) labeled[block->succ[1]] = 1;
+        if ((block->term == TERM_GOTO || block->term == TERM_BRANCH) && block->succ[0] != next) {
+            labeled[block->succ[0]] = 1;
+        }
+    }
+
+    fprintf(out, "\nstatic void f_%s(void) {\n", fn->name);
+    fputs("    enter();\n", out);
+    for (int i = 0; i < count; i++) {
+        int b = order[i];
+        IRBlock *block = &fn->blocks[b];
+        int next = i + 1 < count ? order[i + 1] : -1;
+
+        if (labeled[b]) fprintf(out, "b%d:;\n", b);
+        for (int j = 0; j < block->count; j++) {
+            print_instruction(ctx, fn, &block->instrs[j]);
+        }
+
+        switch (block->term) {
+            case TERM_GOTO:
+                if (block->succ[0] != next) fprintf(out, "    goto b%d;\n", block->succ[0]);
+                break;
+            case TERM_BRANCH:
+                fputs("    if (!is_true(", out);
+                print_operand(ctx, fn, block->cond);
+                fprintf(out, ")) goto b%d;\n", block->succ[1]);
+                if (block->succ[0] != next) fprintf(out, "    goto b%d;\n", block->succ[0]);
+                break;
+            case TERM_RETURN:
+                fputs("    call_depth--;\n    return;\n", out);
+                break;
+            case TERM_HALT:
+                fputs("    halt();\n", out);
+                break;
+        }
+        ctx->statements++;
+    }
+    fputs("}\n", out);
+    ctx->temp_base += fn->temp_count;
+
+    free(labeled);
+    free(placed);
+    free(order);
+    free(reachable);
+}
+
+int ir_print_c_program(IRProgram *program, FILE *output) {
+    CContext ctx;
+    NameSet declared;
+    int has_main = 0;
+    ctx.output = output;
+    ctx.statements = 0;
+    ctx.temp_base = 0;
+    memset(&declared, 0, sizeof(declared));
+
+    fputs("/* Código C generado por el compilador FIS-25 */\n", output);
+    for (int i = 0; runtime[i]; i++) fprintf(output, "%s\n", runtime[i]);
+
+    // Las sentencias fuera de funciones quedan después del bucle final de
+    // FIS-25 y nunca se ejecutan: no se traducen, como tampoco las
+    // funciones a las que no se llega desde main
+    int *reached = reached_functions(program);
+
+    // Variables: los mismos nombres que en la salida FIS-25. Los
+    // temporales se numeran contando todas las funciones.
+    fputc('\n', output);
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        if (reached[f]) declare_function_vars(&ctx, &declared, fn);
+        ctx.temp_base += fn->temp_count;
+    }
+    ctx.temp_base = 0;
+
+    fputc('\n', output);
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        if (reached[f]) fprintf(output, "static void f_%s(void);\n", fn->name);
+    }
+    for (int f = 0; f < program->function_count; f++) {
+        IRFunction *fn = program->functions[f];
+        if (!reached[f]) {
+            ctx.temp_base += fn->temp_count;
+            continue;
+        }
+        if (strcmp(fn->name, "main") == 0) has_main = 1;
+        print_function(&ctx, fn);
+    }
+    free(reached);
+
+    fputs("\nint main(int argc, char **argv) {\n", output);
+    fputs("    for (int i = 1; i < argc; i++) {\n", output);
+    fputs("        if (strcmp(argv[i], \"--key\") == 0 && i + 1 < argc) add_key_event(argv[++i]);\n", output);
+    fputs("        else if (strcmp(argv[i], \"--keys\") == 0 && i + 1 < argc) load_key_script(argv[++i]);\n", output);
+    fputs("        else if (strcmp(argv[i], \"--input\") == 0 && i + 1 < argc) add_input(argv[++i]);\n", output);
+    fputs("        else if (strcmp(argv[i], \"--fb\") == 0 && i + 1 < argc) fb_path = argv[++i];\n", output);
+    fputs("        else {\n", output);
+    fputs("            fprintf(stderr, \"Uso: %s [--key K:DESDE[:HASTA]] [--keys ARCHIVO] [--input V] [--fb ARCHIVO]\\n\", argv[0]);\n", output);
+    fputs("            return 1;\n", output);
+    fputs("        }\n", output);
+    fputs("    }\n", output);
+    if (has_main) {
+        fputs("    f_main();\n", output);
+    } else {
+        fputs("    fatal(\"etiqueta func_main no definida\");\n", output);
+    }
+    fputs("    if (fb_path) dump_framebuffer(fb_path);\n", output);
+    fputs("    return 0;\n", output);
+    fputs("}\n", output);
+
+    name_set_free(&declared);
+    return ctx.statements;
+}
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Movimiento de código invariante fuera de los lazos. Trabaja sobre la forma
+// SSA de ssa.c: cada variable propia tiene una sola definición, así que una
+// instrucción es invariante si sus operandos se definen fuera del lazo o
+// son invariantes a su vez. Las instrucciones se copian al final del
+// preheader, de los lazos internos a los externos, y un lazo externo puede
+// volver a sacarlas.
+//
+// Las sumas y restas enteras se reasocian para separar la parte invariante:
+// x = (32 + col) - row / 2 pasa a x = col + k, con k = 32 - row / 2 calculado
+// una vez en el preheader.
+
+static int is_local(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    return kind != IRVAR_GLOBAL && kind != IRVAR_RETURN;
+}
+
+typedef struct LICM {
+    IRFunction *fn;
+    OptStats *stats;
+    int *def_block;         // Bloque que define cada variable; -1 si viene de la entrada
+    int *def_index;
+    int *uses;              // Número de lecturas de cada variable
+    int *loop_of;           // Último lazo que contiene a cada bloque
+    int *written;           // Último lazo que escribe cada global
+    int current;            // Lazo en proceso
+    int has_call;           // El lazo tiene un GOSUB: cualquier global puede cambiar
+} LICM;
+
+static int operand_invariant(LICM *m, Operand op) {
+    switch (op.kind) {
+        case OPND_NONE:
+        case OPND_INT:
+        case OPND_FLOAT:
+            return 1;
+        case OPND_VAR: {
+            int v = op.u.var;
+            if (m->fn->vars[v].type == TYPE_STRING) return 0;
+            if (!is_local(m->fn, v)) return !m->has_call && m->written[v] != m->current;
+            return m->def_block[v] < 0 || m->loop_of[m->def_block[v]] != m->current;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int is_local_operand(IRFunction *fn, Operand op) {
+    return op.kind == OPND_VAR && is_local(fn, op.u.var);
+}
+
+static int is_int(IRFunction *fn, Operand op) {
+    if (op.kind == OPND_INT) return 1;
+    if (op.kind != OPND_VAR) return 0;
+    DataType type = fn->vars[op.u.var].type;
+    return type == TYPE_INT || type == TYPE_BOOL;
+}
+
+static int is_float(IRFunction *fn, Operand op) {
+    return op.kind == OPND_FLOAT || (op.kind == OPND_VAR && fn->vars[op.u.var].type == TYPE_FLOAT);
+}
+
+// Solo se sacan operaciones sin efectos que no pueden detener la máquina:
+// el lazo puede no ejecutarse nunca, o no pasar por esa rama
+static int can_hoist(LICM *m, IRInstr *instr) {
+    switch (instr->op) {
+        case IR_ASSIGN:
+        case IR_ADD: case IR_SUB: case IR_MUL:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_GT: case IR_LE: case IR_GE:
+        case IR_AND: case IR_OR:
+            break;
+        case IR_DIV:
+        case IR_MOD:
+            if (instr->src[1].kind != OPND_INT || instr->src[1].u.int_value == 0) return 0;
+            if (instr->op == IR_MOD && is_float(m->fn, instr->src[0])) return 0;
+            break;
+        default:
+            return 0;
+    }
+
+    int def = ir_instr_def(instr);
+    if (def < 0 || !is_local(m->fn, def)) return 0;
+    for (int k = 0; k < 3; k++) {
+        if (!operand_invariant(m, instr->src[k])) return 0;
+    }
+    return 1;
+}
+
+// Agrega al final del preheader 'dst = a op b' con un temporal nuevo
+static Operand emit_invariant(LICM *m, int preheader, IROp op, Operand a, Operand b) {
+    IRFunction *fn = m->fn;
+    int var = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_INT);
+    m->def_block = (int*)realloc(m->def_block, (fn->var_count + 1) * sizeof(int));
+    m->def_index = (int*)realloc(m->def_index, (fn->var_count + 1) * sizeof(int));
+    m->written = (int*)realloc(m->written, (fn->var_count + 1) * sizeof(int));
+    m->uses = (int*)realloc(m->uses, (fn->var_count + 1) * sizeof(int));
+    m->written[var] = -1;
+    m->uses[var] = 0;
+
+    IRInstr *instr = ir_append(fn, preheader, op);
+    instr->dst = ir_var(var);
+    instr->src[0] = a;
+    instr->src[1] = b;
+    m->def_block[var] = preheader;
+    m->def_index[var] = fn->blocks[preheader].count - 1;
+    if (a.kind == OPND_VAR) m->uses[a.u.var]++;
+    if (b.kind == OPND_VAR) m->uses[b.u.var]++;
+    return ir_var(var);
+}
+
+// Posición del único operando variante de una suma o resta entera; -1 si
+// no hay exactamente uno
+static int variant_position(LICM *m, IRInstr *instr) {
+    if (instr->op != IR_ADD && instr->op != IR_SUB) return -1;
+    if (!is_int(m->fn, instr->dst) || !is_int(m->fn, instr->src[0]) || !is_int(m->fn, instr->src[1])) {
+        return -1;
+    }
+    int first = operand_invariant(m, instr->src[0]);
+    int second = operand_invariant(m, instr->src[1]);
+    if (first == second) return -1;
+    return first ? 1 : 0;
+}
+
+// d = (v ± c1) ± c2, con la suma interna usada solo aquí, pasa a d = ±v ± k
+static int reassociate(LICM *m, int preheader, IRInstr *instr) {
+    IRFunction *fn = m->fn;
+    int def = ir_instr_def(instr);
+    int inner_position = variant_position(m, instr);
+    if (def < 0 || !is_local(fn, def) || inner_position < 0) return 0;
+
+    Operand inner_operand = instr->src[inner_position];
+    Operand c2 = instr->src[1 - inner_position];
+    if (!is_local_operand(fn, inner_operand) || m->uses[inner_operand.u.var] != 1) return 0;
+    int u = inner_operand.u.var;
+    IRInstr *inner = &fn->blocks[m->def_block[u]].instrs[m->def_index[u]];
+    int v_position = variant_position(m, inner);
+    if (v_position < 0) return 0;
+    Operand v = inner->src[v_position];
+    Operand c1 = inner->src[1 - v_position];
+    // 'v' se lee ahora en la suma externa: un global variante puede
+    // cambiar entre las dos instrucciones
+    if (!is_local_operand(fn, v)) return 0;
+
+    int sign_u = (instr->op == IR_SUB && inner_position == 1) ? -1 : 1;
+    int sign_c2 = (instr->op == IR_SUB && inner_position == 0) ? -1 : 1;
+    int sign_v = sign_u * ((inner->op == IR_SUB && v_position == 1) ? -1 : 1);
+    int sign_c1 = sign_u * ((inner->op == IR_SUB && v_position == 0) ? -1 : 1);
+
+    Operand k;
+    int sign_k = 1;
+    if (c1.kind == OPND_INT && c2.kind == OPND_INT) {
+        k = ir_int((int)((unsigned)sign_c1 * (unsigned)c1.u.int_value +
+                         (unsigned)sign_c2 * (unsigned)c2.u.int_value));
+    } else if (sign_c1 == sign_c2) {
+        k = emit_invariant(m, preheader, IR_ADD, c1, c2);
+        sign_k = sign_c1;
+    } else if (sign_c1 > 0) {
+        k = emit_invariant(m, preheader, IR_SUB, c1, c2);
+    } else {
+        k = emit_invariant(m, preheader, IR_SUB, c2, c1);
+    }
+    if (sign_v < 0 && sign_k < 0) {
+        k = emit_invariant(m, preheader, IR_SUB, ir_int(0), k);
+        sign_k = 1;
+    }
+
+    if (sign_v > 0) {
+        instr->op = sign_k > 0 ? IR_ADD : IR_SUB;
+        instr->src[0] = v;
+        instr->src[1] = k;
+        if (k.kind == OPND_INT && k.u.int_value == 0) instr->op = IR_ASSIGN;
+    } else {
+        instr->op = IR_SUB;
+        instr->src[0] = k;
+        instr->src[1] = v;
+    }
+    if (instr->op == IR_ASSIGN) instr->src[1] = ir_none();
+
+    m->uses[u]--;
+    if (v.kind == OPND_VAR) m->uses[v.u.var]++;
+    if (k.kind == OPND_VAR) m->uses[k.u.var]++;
+    m->stats->reassociated++;
+    return 1;
+}
+
+static int hoist_loop(LICM *m, LoopInfo *loops, int l) {
+    IRFunction *fn = m->fn;
+    int preheader = loops->preheader[l];
+    int hoisted = 0;
+
+    m->current = l;
+    m->has_call = 0;
+    for (int i = loops->block_start[l]; i < loops->block_start[l + 1]; i++) {
+        m->loop_of[loops->blocks[i]] = l;
+    }
+    for (int i = loops->block_start[l]; i < loops->block_start[l + 1]; i++) {
+        IRBlock *block = &fn->blocks[loops->blocks[i]];
+        for (int j = 0; j < block->count; j++) {
+            IRInstr *instr = &block->instrs[j];
+            int def = ir_instr_def(instr);
+            if (instr->op == IR_CALL) m->has_call = 1;
+            if (def >= 0 && !is_local(fn, def)) m->written[def] = l;
+        }
+    }
+
+    // Los bloques van en orden posterior inverso: una cadena de
+    // invariantes sale en una sola pasada salvo que cruce una phi
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = loops->block_start[l]; i < loops->block_start[l + 1]; i++) {
+            int b = loops->blocks[i];
+            for (int j = 0; j < fn->blocks[b].count; j++) {
+                IRInstr *instr = &fn->blocks[b].instrs[j];
+                if (!can_hoist(m, instr)) {
+                    if (reassociate(m, preheader, instr)) changed = 1;
+                    continue;
+                }
+
+                IRInstr copy = *instr;
+                instr->op = IR_NOP;
+                *ir_append(fn, preheader, copy.op) = copy;
+                m->def_block[copy.dst.u.var] = preheader;
+                m->def_index[copy.dst.u.var] = fn->blocks[preheader].count - 1;
+                hoisted++;
+                changed = 1;
+            }
+        }
+    }
+    return hoisted;
+}
+
+int licm_function(IRFunction *fn, OptStats *stats) {
+    DomInfo *dom = cfg_dominators(fn);
+    LoopInfo *loops = cfg_find_loops(fn, dom);
+    LICM m;
+    int hoisted = 0;
+
+    m.fn = fn;
+    m.stats = stats;
+    m.def_block = (int*)malloc((fn->var_count + 1) * sizeof(int));
+    m.def_index = (int*)malloc((fn->var_count + 1) * sizeof(int));
+    m.uses = (int*)calloc(fn->var_count + 1, sizeof(int));
+    m.loop_of = (int*)malloc((fn->block_count + 1) * sizeof(int));
+    m.written = (int*)malloc((fn->var_count + 1) * sizeof(int));
+    for (int v = 0; v < fn->var_count; v++) m.def_block[v] = m.written[v] = -1;
+    for (int b = 0; b < fn->block_count; b++) m.loop_of[b] = -1;
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            int def = ir_instr_def(instr);
+            if (def >= 0) {
+                m.def_block[def] = b;
+                m.def_index[def] = i;
+            }
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (op->kind == OPND_VAR) m.uses[op->u.var]++;
+            }
+        }
+        if (block->term == TERM_BRANCH && block->cond.kind == OPND_VAR) m.uses[block->cond.u.var]++;
+    }
+
+    for (int l = 0; l < loops->loop_count; l++) {
+        if (loops->preheader[l] >= 0) hoisted += hoist_loop(&m, loops, l);
+    }
+
+    ir_remove_nops(fn);
+    stats->hoisted += hoisted;
+
+    free(m.def_block);
+    free(m.def_index);
+    free(m.uses);
+    free(m.loop_of);
+    free(m.written);
+    cfg_free_loops(loops);
+    cfg_free_dominators(dom);
+    return hoisted;
+}
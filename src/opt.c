@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "callgraph.h"
+#include "pool.h"
+
+// Las variables de una función FIS-25 son globales con otro nombre: una
+// llamada recursiva pisa las del llamador. Esas funciones se dejan como las
+// generó codegen, igual que las sentencias fuera de funciones.
+//
+// Las funciones se recorren por componente del grafo de llamadas, de los
+// llamados a los llamadores (Tarjan numera primero las componentes que no
+// llaman a otras pendientes): cada llamada que se expande en línea copia un
+// cuerpo ya optimizado. Después se evalúan en compilación las llamadas que
+// quedaron con argumentos constantes y, si alguna se sustituyó, la función
+// se optimiza otra vez con el resultado.
+//
+// Una componente solo lee la IR de las componentes a las que llama, así que
+// las que no dependen entre sí se optimizan en paralelo (pool.c) y el
+// resultado es el mismo con cualquier número de hilos.
+typedef struct OptimizeJob {
+    IRProgram *program;
+    CallGraph *graph;
+    int inline_limit;
+    int *order;             // Funciones de la componente c en order[start[c] .. start[c + 1])
+    int *start;
+    int *cost;
+    signed char *evaluable;
+    OptStats *stats;        // Uno por hilo
+} OptimizeJob;
+
+static void optimize_function(OptimizeJob *job, int f, OptStats *stats) {
+    IRFunction *fn = job->program->functions[f];
+    if (fn->optimized) {
+        // Cargada de la caché tal como quedó al optimizarla
+        job->cost[f] = fn->inline_cost;
+        return;
+    }
+    fn->optimized = 1;
+    job->cost[f] = -1;
+    if (!fn->name || job->graph->recursive[f]) {
+        stats->skipped++;
+        return;
+    }
+    if (job->inline_limit > 0) inline_calls(job->program, fn, job->cost, job->inline_limit, stats);
+    if (!ssa_optimize_function(fn, stats)) {
+        stats->skipped++;
+        return;
+    }
+    if (evaluate_calls(job->program, fn, job->evaluable, stats) > 0) ssa_optimize_function(fn, stats);
+    stats->functions++;
+    if (job->inline_limit > 0) job->cost[f] = fn->inline_cost = inline_cost(fn);
+}
+
+// Una componente del grafo de llamadas; sus llamados ya terminaron
+static void optimize_component(void *data, int worker, int c) {
+    OptimizeJob *job = (OptimizeJob*)data;
+    for (int k = job->start[c]; k < job->start[c + 1]; k++) {
+        int f = job->order[k];
+        optimize_function(job, f, &job->stats[worker]);
+        // Los llamadores solo leen la clasificación, desde cualquier hilo
+        consteval_classify(job->program, f, job->evaluable);
+    }
+}
+
+// Todos los campos de OptStats son contadores
+static void add_stats(OptStats *total, const OptStats *part) {
+    int *dst = (int*)total;
+    const int *src = (const int*)part;
+    for (size_t i = 0; i < sizeof(OptStats) / sizeof(int); i++) dst[i] += src[i];
+}
+
+void optimize_program(IRProgram *program, int inline_limit, int threads, OptStats *stats) {
+    CallGraph *graph = build_call_graph(program);
+    int n = program->function_count;
+    if (threads < 1) threads = 1;
+
+    OptimizeJob job;
+    job.program = program;
+    job.graph = graph;
+    job.inline_limit = inline_limit;
+    job.order = (int*)malloc((n + 1) * sizeof(int));
+    job.start = (int*)calloc(n + 2, sizeof(int));
+    job.cost = (int*)malloc((n + 1) * sizeof(int));
+    job.evaluable = (signed char*)malloc(n + 1);
+    memset(job.evaluable, -1, n + 1);
+    job.stats = (OptStats*)calloc(threads, sizeof(OptStats));
+
+    int components = 0;
+    for (int f = 0; f < n; f++) {
+        job.start[graph->scc[f] + 1]++;
+        if (graph->scc[f] >= components) components = graph->scc[f] + 1;
+    }
+    for (int c = 0; c < components; c++) job.start[c + 1] += job.start[c];
+    int *next = (int*)malloc((components + 1) * sizeof(int));
+    memcpy(next, job.start, (components + 1) * sizeof(int));
+    for (int f = 0; f < n; f++) job.order[next[graph->scc[f]]++] = f;
+
+    // Cada componente espera a las componentes a las que llama
+    int *dep_start = (int*)malloc((components + 1) * sizeof(int));
+    int *deps = (int*)malloc((graph->callee_start[n] + 1) * sizeof(int));
+    int dep_count = 0;
+    for (int c = 0; c < components; c++) {
+        dep_start[c] = dep_count;
+        for (int k = job.start[c]; k < job.start[c + 1]; k++) {
+            int f = job.order[k];
+            for (int e = graph->callee_start[f]; e < graph->callee_start[f + 1]; e++) {
+                int callee = graph->scc[graph->callees[e]];
+                if (callee != c) deps[dep_count++] = callee;
+            }
+        }
+    }
+    dep_start[components] = dep_count;
+
+    pool_run(threads, components, dep_start, deps, optimize_component, &job);
+    for (int w = 0; w < threads; w++) add_stats(stats, &job.stats[w]);
+
+    assign_variable_slots(program, stats);
+
+    free(dep_start);
+    free(deps);
+    free(next);
+    free(job.order);
+    free(job.start);
+    free(job.cost);
+    free(job.evaluable);
+    free(job.stats);
+    free_call_graph(graph);
+}
@@ -0,0 +1,117 @@
+#ifndef OPT_H
+#define OPT_H
+
+#include "ir.h"
+
+// Optimizaciones sobre la IR de cada función, entre la generación de la IR
+// y su escritura como FIS-25
+
+typedef struct OptStats {
+    int functions;          // Funciones optimizadas
+    int skipped;            // Funciones recursivas o demasiado grandes
+    int phis;               // Nodos phi insertados al construir SSA
+    int constants;          // Usos sustituidos por constantes (SCCP)
+    int branches_folded;    // Saltos condicionales resueltos en compilación
+    int range_folded;       // Saltos resueltos por el análisis de rangos
+    int copies;             // Usos sustituidos por propagación de copias
+    int hoisted;            // Instrucciones invariantes sacadas de un lazo
+    int reassociated;       // Sumas reasociadas para separar su parte invariante
+    int strength_reduced;   // Multiplicaciones por la variable de inducción
+    int idioms;             // MUL/DIV/MOD por constantes simplificadas
+    int inlined;            // Llamadas sustituidas por el cuerpo del llamado
+    int evaluated;          // Llamadas evaluadas en compilación
+    int tables;             // Funciones con tabla de resultados (--table)
+    int table_entries;      // Entradas del dominio de todas las tablas
+    int table_instructions; // Instrucciones FIS-25 que ocupan las tablas
+    int dead_instructions;  // Instrucciones eliminadas por DCE
+    int coalesced;          // Copias eliminadas al salir de SSA
+    int slotted_vars;       // Variables propias llevadas a ranuras compartidas
+    int slots;              // Ranuras distintas en todo el programa
+} OptStats;
+
+// Funciones con más variables o bloques que esto no se optimizan
+#define OPT_MAX_VARS 4096
+#define OPT_MAX_BLOCKS 4096
+
+// Crecimiento máximo por llamada expandida en línea, en instrucciones
+#define OPT_DEFAULT_INLINE_LIMIT 16
+
+// Presupuesto de una llamada evaluada en compilación: instrucciones
+// ejecutadas y profundidad de llamadas anidadas
+#define CONSTEVAL_MAX_STEPS 100000
+#define CONSTEVAL_MAX_DEPTH 256
+
+// Tabla de resultados pedida con --table=función:a..b[,c..d...], un rango
+// de enteros por parámetro
+#define TABLE_MAX_PARAMS 4
+#define TABLE_MAX_ENTRIES 4096
+
+typedef struct TableSpec {
+    const char *name;
+    int param_count;
+    int low[TABLE_MAX_PARAMS];
+    int high[TABLE_MAX_PARAMS];
+} TableSpec;
+
+// Recorre todas las funciones (opt.c). Expande en línea las llamadas cuyo
+// crecimiento no pasa de 'inline_limit'; 0 no expande ninguna. Usa hasta
+// 'threads' hilos.
+void optimize_program(IRProgram *program, int inline_limit, int threads, OptStats *stats);
+
+// SSA, propagación de constantes condicional dispersa, propagación de
+// copias y eliminación agresiva de código muerto (ssa.c). La función no
+// debe ser recursiva: sus variables se tratan como privadas.
+int ssa_optimize_function(IRFunction *fn, OptStats *stats);
+
+// Saca de cada lazo las operaciones invariantes sin efectos hacia su
+// preheader (licm.c). Requiere la forma SSA y las aristas críticas partidas.
+int licm_function(IRFunction *fn, OptStats *stats);
+
+// Resuelve los saltos que los intervalos de enteros de sus operandos
+// deciden (range.c). Requiere la forma SSA y las aristas críticas partidas;
+// el llamador quita los bloques que quedan inalcanzables. Devuelve cuántos
+// saltos resolvió.
+int range_fold_branches(IRFunction *fn, OptStats *stats);
+
+// Simplifica MUL, DIV y MOD con constantes 0, 1, -1 y 2 (strength.c)
+int rewrite_idioms(IRFunction *fn, OptStats *stats);
+
+// Convierte i * k, con i variable de inducción, en una variable de
+// inducción propia (strength.c). Requiere la forma SSA.
+int strength_reduce_function(IRFunction *fn, OptStats *stats);
+
+// Lo que crece el llamador al expandir una llamada a 'fn' ya optimizada,
+// o -1 si no se puede expandir (inline.c)
+int inline_cost(IRFunction *fn);
+
+// Expande en las llamadas de 'fn' a funciones con 0 <= cost[f] <= limit el
+// cuerpo del llamado, indexado como en program->functions (inline.c)
+int inline_calls(IRProgram *program, IRFunction *fn, const int *cost, int limit, OptStats *stats);
+
+// Sustituye las llamadas de 'fn' con argumentos constantes por su
+// resultado cuando el llamado se puede ejecutar en compilación sin efectos
+// visibles (consteval.c). 'evaluable' guarda por función si vale la pena
+// intentarlo: -1 al principio, 0 si no, 1 si sí.
+int evaluate_calls(IRProgram *program, IRFunction *fn, signed char *evaluable, OptStats *stats);
+
+// Calcula evaluable[f] con la IR final de 'f'. Después de esto las
+// evaluaciones de llamadas a 'f' solo leen el arreglo (consteval.c).
+void consteval_classify(IRProgram *program, int f, signed char *evaluable);
+
+// Ejecuta en compilación la función 'f' con argumentos constantes y deja
+// en 'result' su valor de retorno; 0 si no se pudo (consteval.c)
+int consteval_function(IRProgram *program, int f, const Operand *args, int arg_count,
+                       signed char *evaluable, Operand *result);
+
+// Antepone al cuerpo de la función una tabla de sus resultados sobre el
+// dominio pedido, con el cuerpo original para argumentos fuera de él
+// (table.c). Termina con error si la función no se puede evaluar en todo
+// el dominio.
+void tabulate_function(IRProgram *program, const TableSpec *spec, OptStats *stats);
+
+// Reparte las variables propias en ranuras _s<n> compartidas por funciones
+// que no pueden estar activas a la vez, según el grafo de llamadas (slots.c).
+// Devuelve el número de ranuras.
+int assign_variable_slots(IRProgram *program, OptStats *stats);
+
+#endif
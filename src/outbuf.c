@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "outbuf.h"
+
+#define OUT_INITIAL_CAPACITY 1024
+
+void out_init(OutBuffer *out) {
+    out->data = NULL;
+    out->length = 0;
+    out->capacity = 0;
+}
+
+// Deja lugar para 'extra' bytes más
+static char* out_reserve(OutBuffer *out, size_t extra) {
+    if (out->length + extra > out->capacity) {
+        size_t capacity = out->capacity ? out->capacity : OUT_INITIAL_CAPACITY;
+        while (out->length + extra > capacity) capacity *= 2;
+        char *data = (char*)realloc(out->data, capacity);
+        if (!data) {
+            fprintf(stderr, "Error: sin memoria para escribir el programa\n");
+            exit(1);
+        }
+        out->data = data;
+        out->capacity = capacity;
+    }
+    return out->data + out->length;
+}
+
+void out_char(OutBuffer *out, char c) {
+    *out_reserve(out, 1) = c;
+    out->length++;
+}
+
+void out_str(OutBuffer *out, const char *str) {
+    size_t length = strlen(str);
+    if (length == 0) return;
+    memcpy(out_reserve(out, length), str, length);
+    out->length += length;
+}
+
+void out_int(OutBuffer *out, int value) {
+    char digits[12];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    char *p = out_reserve(out, count + 1);
+    if (value < 0) *p++ = '-';
+    while (count > 0) *p++ = digits[--count];
+    out->length = p - out->data;
+}
+
+void out_float(OutBuffer *out, float value) {
+    // El %f más largo de un float (FLT_MAX) tiene 46 caracteres
+    char *p = out_reserve(out, 64);
+    int length = snprintf(p, 64, "%f", value);
+    if (length > 0) out->length += length < 64 ? (size_t)length : 63;
+}
+
+void out_bytes(OutBuffer *out, const void *data, size_t length) {
+    if (length == 0) return;
+    memcpy(out_reserve(out, length), data, length);
+    out->length += length;
+}
+
+void out_append(OutBuffer *out, const OutBuffer *other) {
+    out_bytes(out, other->data, other->length);
+}
+
+int out_write(const OutBuffer *out, int fd) {
+    size_t done = 0;
+    // Una tubería o una señal pueden aceptar solo una parte
+    while (done < out->length) {
+        ssize_t written = write(fd, out->data + done, out->length - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += (size_t)written;
+    }
+    return 0;
+}
+
+void out_free(OutBuffer *out) {
+    free(out->data);
+    out_init(out);
+}
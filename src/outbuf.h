@@ -0,0 +1,29 @@
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stddef.h>
+
+// Búfer de salida que crece según haga falta. El texto de todo el programa
+// se arma en memoria sin pasar por stdio ni pedir memoria por cada
+// instrucción, y se escribe al final con out_write.
+typedef struct OutBuffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+} OutBuffer;
+
+void out_init(OutBuffer *out);
+void out_char(OutBuffer *out, char c);
+void out_str(OutBuffer *out, const char *str);
+void out_int(OutBuffer *out, int value);
+void out_float(OutBuffer *out, float value);    // Como printf("%f")
+void out_bytes(OutBuffer *out, const void *data, size_t length);
+void out_append(OutBuffer *out, const OutBuffer *other);
+
+// Escribe todo el búfer en el descriptor 'fd' (normalmente con un solo
+// write). Devuelve 0, o -1 con errno si falló.
+int out_write(const OutBuffer *out, int fd);
+
+void out_free(OutBuffer *out);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// Estado de un análisis sintáctico. El parser de Bison es puro y el
+// analizador léxico de Flex es reentrante: todo lo que antes eran globales
+// (la raíz, la línea, yyin) vive aquí, así que varios hilos pueden analizar
+// programas distintos a la vez, cada uno con su propio AST (ver ast.h).
+typedef struct ParseContext {
+    void *scanner;      // yyscan_t del analizador léxico, NULL fuera de parse_program
+    int line;           // Línea actual, para los mensajes de error
+    ASTNode *root;      // Programa analizado
+} ParseContext;
+
+// Analiza el programa de 'input'. Devuelve la raíz, o NULL si Bison se
+// quedó sin memoria; los errores léxicos y sintácticos se informan con
+// compile_error (diag.h).
+ASTNode* parse_program(ParseContext *ctx, FILE *input);
+
+// Libera el analizador léxico si compile_error interrumpió parse_program
+void parse_release(ParseContext *ctx);
+
+#endif
@@ -2,29 +2,45 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include "ast.h"
 #include "symtable.h"
 #include "codegen.h"
+#include "driver.h"
+#include "diag.h"
+#include "pool.h"
 
-extern int yylex();
-extern int yylineno;
-extern FILE *yyin;
+// Máximo de opciones --table
+#define MAX_TABLE_SPECS 16
+%}
 
-void yyerror(const char *s);
+%code requires {
+#include "parse.h"
+}
 
-ASTNode *root = NULL;
-SymbolTable *global_symtable;
-%}
+%define api.pure full
+%lex-param {void *scanner}
+%parse-param {void *scanner} {ParseContext *ctx}
 
 %union {
     int ival;
     float fval;
     int bval;
-    char *sval;
+    const char *sval;
     struct ASTNode *node;
     int type;
 }
 
+%code {
+// Interfaz del analizador léxico reentrante (lex.yy.c)
+int yylex(YYSTYPE *lvalp, void *scanner);
+int yylex_init_extra(ParseContext *extra, void **scanner);
+void yyset_in(FILE *input, void *scanner);
+int yylex_destroy(void *scanner);
+
+void yyerror(void *scanner, ParseContext *ctx, const char *s);
+}
+
 %token <ival> INT_LITERAL
 %token <fval> FLOAT_LITERAL
 %token <sval> STRING_LITERAL
@@ -57,7 +73,7 @@ SymbolTable *global_symtable;
 %%
 
 program:
-    statement_list { root = $1; }
+    statement_list { ctx->root = $1; }
     ;
 
 statement_list:
@@ -236,62 +252,213 @@ factor:
     | TRUE { $$ = create_bool_literal_node(1); }
     | FALSE { $$ = create_bool_literal_node(0); }
     | IDENTIFIER { $$ = create_identifier_node($1); }
+    | IDENTIFIER '.' LENGTH { $$ = create_length_node(create_identifier_node($1)); }
     | array_access { $$ = $1; }
     | function_call { $$ = $1; }
     ;
 
 %%
 
-void yyerror(const char *s) {
-    fprintf(stderr, "Error de sintaxis en línea %d: %s\n", yylineno, s);
-    exit(1);
+void yyerror(void *scanner, ParseContext *ctx, const char *s) {
+    (void)scanner;
+    compile_error("Error de sintaxis en línea %d: %s\n", ctx->line, s);
 }
 
-int main(int argc, char **argv) {
-    if (argc != 3) {
-        fprintf(stderr, "Uso: %s <archivo_entrada.src> <archivo_salida.asm>\n", argv[0]);
-        return 1;
+ASTNode* parse_program(ParseContext *ctx, FILE *input) {
+    ctx->line = 1;
+    ctx->root = NULL;
+    if (yylex_init_extra(ctx, &ctx->scanner) != 0) {
+        fprintf(stderr, "Error: sin memoria para el analizador léxico\n");
+        exit(1);
     }
+    yyset_in(input, ctx->scanner);
+    int result = yyparse(ctx->scanner, ctx);
+    parse_release(ctx);
+    return result == 0 ? ctx->root : NULL;
+}
 
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "Error: No se puede abrir el archivo %s\n", argv[1]);
-        return 1;
+void parse_release(ParseContext *ctx) {
+    if (!ctx->scanner) return;
+    yylex_destroy(ctx->scanner);
+    ctx->scanner = NULL;
+}
+
+// Con la salida en stdout ('-') las estadísticas van a stderr
+static void print_stats(FILE *out, const CompileResult *result, EmitFormat emit) {
+    const CodeGenStats *codegen = &result->codegen;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(out, "--- Estadísticas ---\n");
+    fprintf(out, "AST: %zu nodos, %zu bytes usados (%zu bytes reservados en el arena)\n",
+            result->ast_nodes, result->ast_bytes_used, result->ast_bytes_reserved);
+    fprintf(out, "Identificadores: %zu átomos internados\n", result->atoms);
+    fprintf(out, "Plegado: %d expresiones simplificadas\n", result->folded);
+    fprintf(out, "IR: %d funciones, %d bloques básicos, %d aristas, %d instrucciones\n",
+            codegen->ir.functions, codegen->ir.blocks, codegen->ir.edges, codegen->ir.instructions);
+    fprintf(out, "Optimización: %d funciones en SSA (%d sin optimizar), %d phi, %d constantes, "
+            "%d saltos resueltos, %d copias, %d instrucciones muertas, %d copias fusionadas\n",
+            codegen->opt.functions, codegen->opt.skipped, codegen->opt.phis, codegen->opt.constants,
+            codegen->opt.branches_folded, codegen->opt.copies, codegen->opt.dead_instructions,
+            codegen->opt.coalesced);
+    fprintf(out, "Lazos: %d invariantes sacadas, %d sumas reasociadas, %d multiplicaciones reducidas, "
+            "%d operaciones simplificadas\n",
+            codegen->opt.hoisted, codegen->opt.reassociated, codegen->opt.strength_reduced,
+            codegen->opt.idioms);
+    fprintf(out, "Arrays: %d accesos con índice variable, %d saltos resueltos por rangos\n",
+            codegen->bounds_checks, codegen->opt.range_folded);
+    fprintf(out, "Llamadas: %d expandidas en línea, %d evaluadas en compilación\n",
+            codegen->opt.inlined, codegen->opt.evaluated);
+    fprintf(out, "Tablas: %d funciones, %d entradas en %d instrucciones FIS-25\n",
+            codegen->opt.tables, codegen->opt.table_entries, codegen->opt.table_instructions);
+    fprintf(out, "Ranuras: %d variables propias en %d ranuras compartidas\n",
+            codegen->opt.slotted_vars, codegen->opt.slots);
+    fprintf(out, "Caché: %d funciones reutilizadas, %d generadas\n",
+            codegen->cache_hits, codegen->cache_misses);
+    if (emit == EMIT_C) {
+        fprintf(out, "Código: %d sentencias C\n", codegen->instructions);
+    } else {
+        fprintf(out, "Código: %d instrucciones FIS-25\n", codegen->instructions);
     }
+    fprintf(out, "Temporales: pico de %d vivos por función, %d distintos para %d usos\n",
+            codegen->temps_peak_live, codegen->temps_total, codegen->temps_requested);
+    fprintf(out, "Tiempo: %.1f ms generando la IR, %.1f ms optimizando, %.1f ms escribiendo\n",
+            codegen->lower_ms, codegen->optimize_ms, codegen->print_ms);
+    if (emit != EMIT_C) {
+        double seconds = (codegen->print_ms - codegen->write_ms) / 1000.0;
+        fprintf(out, "Salida: %zu bytes, %.1f MB/s formateando, %.1f ms en write\n",
+                codegen->output_bytes,
+                seconds > 0 ? codegen->output_bytes / seconds / 1e6 : 0.0, codegen->write_ms);
+    }
+    fprintf(out, "Memoria: pico RSS %ld KB\n", usage.ru_maxrss);
+}
+
+// --table=función:a..b[,c..d...]; devuelve 0 si el texto no es válido
+static int parse_table_spec(const char *text, TableSpec *spec) {
+    const char *colon = strchr(text, ':');
+    if (!colon || colon == text) return 0;
+
+    long entries = 1;
+    const char *p = colon + 1;
+    spec->param_count = 0;
+    for (;;) {
+        char *end;
+        if (spec->param_count == TABLE_MAX_PARAMS) return 0;
+        long low = strtol(p, &end, 10);
+        if (end == p || strncmp(end, "..", 2) != 0) return 0;
+        p = end + 2;
+        long high = strtol(p, &end, 10);
+        if (end == p || high < low || high - low >= TABLE_MAX_ENTRIES) return 0;
+        entries *= high - low + 1;
+        if (entries > TABLE_MAX_ENTRIES) return 0;
+        spec->low[spec->param_count] = (int)low;
+        spec->high[spec->param_count] = (int)high;
+        spec->param_count++;
+        if (*end == '\0') break;
+        if (*end != ',') return 0;
+        p = end + 1;
+    }
+
+    char *name = (char*)malloc(colon - text + 1);
+    memcpy(name, text, colon - text);
+    name[colon - text] = '\0';
+    spec->name = name;
+    return 1;
+}
 
-    global_symtable = create_symbol_table();
-
-    printf("=== Compilando %s ===\n", argv[1]);
-    
-    if (yyparse() == 0) {
-        printf("✓ Análisis sintáctico completado\n");
-        
-        // Análisis semántico
-        printf("✓ Verificando semántica...\n");
-        semantic_analysis(root, global_symtable);
-        printf("✓ Análisis semántico completado\n");
-        
-        // Generación de código
-        printf("✓ Generando código FIS-25...\n");
-        FILE *output = fopen(argv[2], "w");
-        if (!output) {
-            fprintf(stderr, "Error: No se puede crear el archivo %s\n", argv[2]);
+int main(int argc, char **argv) {
+    int show_stats = 0;
+    CodeGenOptions codegen_options;
+    codegen_options.optimize = 1;
+    codegen_options.inline_limit = OPT_DEFAULT_INLINE_LIMIT;
+    codegen_options.emit = EMIT_FIS25;
+    TableSpec tables[MAX_TABLE_SPECS];
+    codegen_options.tables = tables;
+    codegen_options.table_count = 0;
+    codegen_options.cache_dir = NULL;
+    codegen_options.threads = 1;
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *batch_path = NULL;
+    int jobs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = 1;
+        } else if (strcmp(argv[i], "-O0") == 0) {
+            codegen_options.optimize = 0;
+        } else if (strncmp(argv[i], "--inline-limit=", 15) == 0) {
+            char *end;
+            long limit = strtol(argv[i] + 15, &end, 10);
+            if (end == argv[i] + 15 || *end != '\0' || limit < 0 || limit > 100000) {
+                fprintf(stderr, "Error: Límite de expansión en línea inválido: %s\n", argv[i] + 15);
+                return 1;
+            }
+            codegen_options.inline_limit = (int)limit;
+        } else if (strncmp(argv[i], "--table=", 8) == 0) {
+            if (codegen_options.table_count == MAX_TABLE_SPECS ||
+                !parse_table_spec(argv[i] + 8, &tables[codegen_options.table_count])) {
+                fprintf(stderr, "Error: Tabla inválida: %s (función:a..b[,c..d...], hasta %d entradas)\n",
+                        argv[i] + 8, TABLE_MAX_ENTRIES);
+                return 1;
+            }
+            codegen_options.table_count++;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            char *end;
+            long threads = strtol(argv[i] + 10, &end, 10);
+            if (end == argv[i] + 10 || *end != '\0' || threads < 0 || threads > 1024) {
+                fprintf(stderr, "Error: Número de hilos inválido: %s\n", argv[i] + 10);
+                return 1;
+            }
+            codegen_options.threads = threads == 0 ? pool_cpu_count() : (int)threads;
+        } else if (strncmp(argv[i], "--batch=", 8) == 0 && argv[i][8] != '\0') {
+            batch_path = argv[i] + 8;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            // -j N o -jN: programas que se compilan a la vez en el modo por lotes
+            const char *text = argv[i][2] != '\0' ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            char *end;
+            long count = strtol(text, &end, 10);
+            if (end == text || *end != '\0' || count < 0 || count > 1024) {
+                fprintf(stderr, "Error: Número de trabajos inválido: %s\n", text);
+                return 1;
+            }
+            jobs = count == 0 ? pool_cpu_count() : (int)count;
+        } else if (strncmp(argv[i], "--cache-dir=", 12) == 0 && argv[i][12] != '\0') {
+            codegen_options.cache_dir = argv[i] + 12;
+        } else if (strcmp(argv[i], "--emit=fis25") == 0) {
+            codegen_options.emit = EMIT_FIS25;
+        } else if (strcmp(argv[i], "--emit=c") == 0) {
+            codegen_options.emit = EMIT_C;
+        } else if (strcmp(argv[i], "--emit=bin") == 0) {
+            codegen_options.emit = EMIT_BIN;
+        } else if (strncmp(argv[i], "--emit=", 7) == 0) {
+            fprintf(stderr, "Error: Formato de salida desconocido: %s\n", argv[i] + 7);
             return 1;
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            input_path = NULL;
+            break;
+        }
+    }
+
+    int status;
+    if (batch_path && !input_path) {
+        status = compile_batch(batch_path, jobs ? jobs : pool_cpu_count(), &codegen_options, show_stats);
+    } else if (!batch_path && !jobs && input_path && output_path) {
+        CompileResult result;
+        status = compile_file(input_path, output_path, &codegen_options, 0, &result);
+        if (status == 0 && show_stats) {
+            print_stats(strcmp(output_path, "-") == 0 ? stderr : stdout, &result, codegen_options.emit);
         }
-        
-        generate_code(root, output, global_symtable);
-        fclose(output);
-        
-        printf("✓ Código generado exitosamente en %s\n", argv[2]);
-        printf("=== Compilación exitosa ===\n");
     } else {
-        fprintf(stderr, "✗ Error en la compilación\n");
-        return 1;
+        fprintf(stderr, "Uso: %s [--stats] [-O0] [--inline-limit=N] [--table=f:a..b,...] [--emit=fis25|c|bin] [--cache-dir=DIR] [--threads=N] <archivo_entrada.src> <archivo_salida|->\n", argv[0]);
+        fprintf(stderr, "     %s [opciones] --batch=LISTA [-j N]   (LISTA: una línea \"entrada salida\" por programa)\n", argv[0]);
+        status = 1;
     }
 
-    fclose(yyin);
-    free_symbol_table(global_symtable);
-    free_ast(root);
-    
-    return 0;
+    for (int t = 0; t < codegen_options.table_count; t++) free((char*)tables[t].name);
+    return status;
 }
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "pool.h"
+
+// Cola de tareas listas protegida por un único candado: las tareas de este
+// compilador (una función cada una) duran mucho más que tomar el candado.
+// Cada tarea entra una sola vez a la cola, así que basta un arreglo.
+typedef struct Pool {
+    int count;
+    int *pending;           // Dependencias sin terminar de cada tarea
+    int *dependent_start;   // Tareas que esperan a t en dependents[dependent_start[t] .. [t + 1])
+    int *dependents;
+    int *ready;             // Cola de tareas listas en ready[head .. tail)
+    int head;
+    int tail;
+    int running;
+    int finished;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    PoolTask run;
+    void *data;
+} Pool;
+
+typedef struct Worker {
+    Pool *pool;
+    int index;
+} Worker;
+
+static void work(Pool *pool, int worker) {
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        // Sin tareas listas ni en curso no queda nada que esperar
+        while (pool->head == pool->tail && pool->running > 0) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->head == pool->tail) break;
+
+        int task = pool->ready[pool->head++];
+        pool->running++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->run(pool->data, worker, task);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->running--;
+        pool->finished++;
+        int released = pool->tail;
+        for (int i = pool->dependent_start[task]; i < pool->dependent_start[task + 1]; i++) {
+            int next = pool->dependents[i];
+            if (--pool->pending[next] == 0) pool->ready[pool->tail++] = next;
+        }
+        released = pool->tail - released;
+        if (released > 1 || pool->running == 0) {
+            pthread_cond_broadcast(&pool->wake);
+        } else if (released == 1) {
+            pthread_cond_signal(&pool->wake);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void* worker_main(void *arg) {
+    Worker *worker = (Worker*)arg;
+    work(worker->pool, worker->index);
+    return NULL;
+}
+
+void pool_run(int threads, int count, const int *dep_start, const int *deps,
+              PoolTask run, void *data) {
+    if (count <= 0) return;
+    if (threads < 1) threads = 1;
+    if (threads > count) threads = count;
+
+    Pool pool;
+    pool.count = count;
+    pool.pending = (int*)calloc(count + 1, sizeof(int));
+    pool.dependent_start = (int*)calloc(count + 2, sizeof(int));
+    pool.ready = (int*)malloc((count + 1) * sizeof(int));
+    pool.head = 0;
+    pool.tail = 0;
+    pool.running = 0;
+    pool.finished = 0;
+    pool.run = run;
+    pool.data = data;
+
+    // Aristas invertidas: de cada dependencia a las tareas que la esperan
+    int edges = dep_start ? dep_start[count] : 0;
+    pool.dependents = (int*)malloc((edges + 1) * sizeof(int));
+    for (int t = 0; dep_start && t < count; t++) {
+        pool.pending[t] = dep_start[t + 1] - dep_start[t];
+        for (int i = dep_start[t]; i < dep_start[t + 1]; i++) pool.dependent_start[deps[i] + 2]++;
+    }
+    for (int t = 0; t < count; t++) pool.dependent_start[t + 2] += pool.dependent_start[t + 1];
+    for (int t = 0; dep_start && t < count; t++) {
+        for (int i = dep_start[t]; i < dep_start[t + 1]; i++) {
+            pool.dependents[pool.dependent_start[deps[i] + 1]++] = t;
+        }
+    }
+    for (int t = 0; t < count; t++) {
+        if (pool.pending[t] == 0) pool.ready[pool.tail++] = t;
+    }
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+
+    // El hilo que llama es el trabajador 0
+    pthread_t *ids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    Worker *workers = (Worker*)malloc(threads * sizeof(Worker));
+    int started = 1;
+    for (int w = 1; w < threads; w++) {
+        workers[w].pool = &pool;
+        workers[w].index = w;
+        if (pthread_create(&ids[w], NULL, worker_main, &workers[w]) != 0) break;
+        started++;
+    }
+    work(&pool, 0);
+    for (int w = 1; w < started; w++) pthread_join(ids[w], NULL);
+
+    if (pool.finished != count) {
+        fprintf(stderr, "Error interno: dependencias circulares entre tareas\n");
+        exit(1);
+    }
+
+    pthread_cond_destroy(&pool.wake);
+    pthread_mutex_destroy(&pool.lock);
+    free(workers);
+    free(ids);
+    free(pool.pending);
+    free(pool.dependent_start);
+    free(pool.dependents);
+    free(pool.ready);
+}
+
+int pool_cpu_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
@@ -0,0 +1,22 @@
+#ifndef POOL_H
+#define POOL_H
+
+// Ejecución de tareas en varios hilos. Las tareas se numeran de 0 a
+// count - 1; la tarea t empieza cuando terminaron todas las de
+// deps[dep_start[t] .. dep_start[t + 1]) (con dep_start NULL no hay
+// dependencias). 'run' recibe el número del hilo, de 0 a threads - 1, para
+// que cada hilo acumule aparte lo que no se puede compartir.
+//
+// Con un solo hilo las tareas se ejecutan en el hilo que llama, en orden
+// de número si las dependencias lo permiten. Quien use el resultado de una
+// tarea no debe depender del orden en que terminan: solo de sus
+// dependencias.
+typedef void (*PoolTask)(void *data, int worker, int task);
+
+void pool_run(int threads, int count, const int *dep_start, const int *deps,
+              PoolTask run, void *data);
+
+// Hilos disponibles en la máquina (al menos 1)
+int pool_cpu_count(void);
+
+#endif
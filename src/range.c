@@ -0,0 +1,527 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Análisis de rangos de enteros sobre la forma SSA. Cada variable propia
+// recibe un intervalo [low, high] con todos los valores que puede tomar, y
+// una comparación acota sus operandos en los bloques que domina cada lado
+// del salto (tras partir las aristas críticas, cada sucesor de un salto
+// tiene un solo predecesor). Los saltos que quedan decididos por los
+// intervalos se resuelven; entre ellos, las comprobaciones de índice de los
+// arrays que el propio lazo ya garantiza.
+//
+// Un valor que puede no ser entero (float, cadena, parámetro, global o
+// resultado de una llamada) lleva un intervalo más ancho que cualquier
+// entero y no se acota nunca: la máquina compara los float con otras reglas.
+// ADD, SUB y MUL enteros son circulares, así que un resultado que se sale
+// de 32 bits pasa al intervalo de todos los enteros.
+//
+// Para que los lazos terminen, un phi que sigue creciendo se ensancha hasta
+// el siguiente umbral (las constantes con que se compara en la función);
+// después unas pasadas descendentes recuperan la precisión perdida.
+
+#define RANGE_UNKNOWN (1LL << 40)   // Fuera del rango de int: puede no ser entero
+#define RANGE_WIDEN_AFTER 2         // Cambios de un phi antes de ensancharlo
+#define RANGE_MAX_PASSES 64         // Pasadas ascendentes antes de rendirse
+#define RANGE_NARROW_PASSES 2
+#define RANGE_MAX_DEPTH 4           // Comparaciones encadenadas al acotar un operando
+
+typedef struct Range {
+    long long low;
+    long long high;
+} Range;
+
+// Lado de un salto cuya comparación acota 'var' en los bloques que domina
+// 'target', su único sucesor por ese lado
+typedef struct RangeEdge {
+    int var;
+    int branch;
+    int target;
+    int taken;
+} RangeEdge;
+
+typedef struct RangeContext {
+    IRFunction *fn;
+    DomInfo *dom;
+    IRInstr **def;          // Definición de cada variable SSA; NULL si no tiene
+    Range *range;
+    char *known;            // 0 mientras la definición no se evaluó
+    int *updates;           // Veces que creció cada phi
+    long long *thresholds;  // Umbrales de ensanchamiento, ordenados
+    int threshold_count;
+    RangeEdge *edges;       // Agrupados por variable:
+    int *edge_start;        // los de v en edges[edge_start[v] .. edge_start[v + 1])
+} RangeContext;
+
+static Range make_range(long long low, long long high) {
+    Range r;
+    r.low = low;
+    r.high = high;
+    return r;
+}
+
+static Range unknown_range(void) {
+    return make_range(-RANGE_UNKNOWN, RANGE_UNKNOWN);
+}
+
+static int is_integer(Range r) {
+    return r.low >= INT_MIN && r.high <= INT_MAX;
+}
+
+// Resultado entero de 32 bits: si puede desbordar, da la vuelta
+static Range integer_range(long long low, long long high) {
+    if (low < INT_MIN || high > INT_MAX) return make_range(INT_MIN, INT_MAX);
+    return make_range(low, high);
+}
+
+static Range hull(Range a, Range b) {
+    return make_range(a.low < b.low ? a.low : b.low, a.high > b.high ? a.high : b.high);
+}
+
+static int is_local(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    return kind != IRVAR_GLOBAL && kind != IRVAR_RETURN;
+}
+
+static int is_comparison(IROp op) {
+    return op == IR_EQ || op == IR_NE || op == IR_LT || op == IR_GT || op == IR_LE || op == IR_GE;
+}
+
+// 'b op a' equivale a 'a swapped(op) b'
+static IROp swapped(IROp op) {
+    switch (op) {
+        case IR_LT: return IR_GT;
+        case IR_GT: return IR_LT;
+        case IR_LE: return IR_GE;
+        case IR_GE: return IR_LE;
+        default: return op;
+    }
+}
+
+static IROp negated(IROp op) {
+    switch (op) {
+        case IR_EQ: return IR_NE;
+        case IR_NE: return IR_EQ;
+        case IR_LT: return IR_GE;
+        case IR_GT: return IR_LE;
+        case IR_LE: return IR_GT;
+        default: return IR_LT;
+    }
+}
+
+// 1 o 0 si la comparación vale siempre eso; -1 si depende de los valores
+static int compare_ranges(IROp op, Range a, Range b) {
+    if (!is_integer(a) || !is_integer(b)) return -1;
+    switch (op) {
+        case IR_LT:
+            if (a.high < b.low) return 1;
+            if (a.low >= b.high) return 0;
+            return -1;
+        case IR_LE:
+            if (a.high <= b.low) return 1;
+            if (a.low > b.high) return 0;
+            return -1;
+        case IR_GT:
+            return compare_ranges(IR_LT, b, a);
+        case IR_GE:
+            return compare_ranges(IR_LE, b, a);
+        case IR_EQ:
+            if (a.low == a.high && b.low == b.high && a.low == b.low) return 1;
+            if (a.high < b.low || b.high < a.low) return 0;
+            return -1;
+        case IR_NE: {
+            int equal = compare_ranges(IR_EQ, a, b);
+            return equal < 0 ? -1 : !equal;
+        }
+        default:
+            return -1;
+    }
+}
+
+static Range arithmetic_range(IROp op, Range a, Range b) {
+    if (!is_integer(a) || !is_integer(b)) return unknown_range();
+
+    switch (op) {
+        case IR_ADD:
+            return integer_range(a.low + b.low, a.high + b.high);
+        case IR_SUB:
+            return integer_range(a.low - b.high, a.high - b.low);
+        case IR_MUL: {
+            long long p[4] = { a.low * b.low, a.low * b.high, a.high * b.low, a.high * b.high };
+            long long low = p[0], high = p[0];
+            for (int i = 1; i < 4; i++) {
+                if (p[i] < low) low = p[i];
+                if (p[i] > high) high = p[i];
+            }
+            return integer_range(low, high);
+        }
+        case IR_DIV: {
+            // Solo entre una constante; la división trunca hacia cero
+            if (b.low != b.high || b.low == 0) break;
+            long long c = b.low;
+            if (c == -1) return a.low == INT_MIN ? make_range(INT_MIN, INT_MAX) : make_range(-a.high, -a.low);
+            if (c > 0) return make_range(a.low / c, a.high / c);
+            return make_range(a.high / c, a.low / c);
+        }
+        case IR_MOD: {
+            // El resto tiene el signo del dividendo y es menor que |c|
+            if (b.low != b.high || b.low == 0) break;
+            if (b.low == -1) return make_range(0, 0);
+            long long m = (b.low < 0 ? -b.low : b.low) - 1;
+            if (a.low >= 0) return make_range(0, a.high < m ? a.high : m);
+            if (a.high <= 0) return make_range(a.low > -m ? a.low : -m, 0);
+            return make_range(-m, m);
+        }
+        default:
+            break;
+    }
+    return make_range(INT_MIN, INT_MAX);
+}
+
+static int operand_range(RangeContext *rc, Operand op, int block, int depth, Range *r);
+
+// Acota 'r' con la comparación del salto 'branch' cuando se sigue su lado
+// 'taken'
+static void refine_edge(RangeContext *rc, int branch, int taken, int var, int depth, Range *r) {
+    IRInstr *cmp = rc->def[rc->fn->blocks[branch].cond.u.var];
+    IROp op = cmp->op;
+    Operand other = cmp->src[1];
+    if (!(cmp->src[0].kind == OPND_VAR && cmp->src[0].u.var == var)) {
+        other = cmp->src[0];
+        op = swapped(op);
+    }
+    if (!taken) op = negated(op);
+
+    Range o;
+    if (!operand_range(rc, other, branch, depth + 1, &o) || !is_integer(o)) return;
+    switch (op) {
+        case IR_LT:
+            if (o.high - 1 < r->high) r->high = o.high - 1;
+            break;
+        case IR_LE:
+            if (o.high < r->high) r->high = o.high;
+            break;
+        case IR_GT:
+            if (o.low + 1 > r->low) r->low = o.low + 1;
+            break;
+        case IR_GE:
+            if (o.low > r->low) r->low = o.low;
+            break;
+        case IR_EQ:
+            if (o.low > r->low) r->low = o.low;
+            if (o.high < r->high) r->high = o.high;
+            break;
+        default:
+            if (o.low == o.high && r->low == o.low) r->low++;
+            if (o.low == o.high && r->high == o.low) r->high--;
+            break;
+    }
+}
+
+// Acota 'r', el intervalo de 'var', con los lados de salto que dominan 'block'
+static void refine(RangeContext *rc, int var, int block, int depth, Range *r) {
+    if (!is_integer(*r) || depth > RANGE_MAX_DEPTH) return;
+
+    for (int e = rc->edge_start[var]; e < rc->edge_start[var + 1]; e++) {
+        RangeEdge *edge = &rc->edges[e];
+        if (cfg_dominates(rc->dom, edge->target, block)) {
+            refine_edge(rc, edge->branch, edge->taken, var, depth, r);
+        }
+    }
+}
+
+// Intervalo del operando en 'block'; 0 si todavía no tiene valor o si los
+// saltos que llevan hasta ahí se contradicen
+static int operand_range(RangeContext *rc, Operand op, int block, int depth, Range *r) {
+    switch (op.kind) {
+        case OPND_INT:
+            *r = make_range(op.u.int_value, op.u.int_value);
+            return 1;
+        case OPND_VAR: {
+            int v = op.u.var;
+            if (!rc->def[v]) {
+                *r = unknown_range();
+                return 1;
+            }
+            if (!rc->known[v]) return 0;
+            *r = rc->range[v];
+            refine(rc, v, block, depth, r);
+            return r->low <= r->high;
+        }
+        default:
+            *r = unknown_range();
+            return 1;
+    }
+}
+
+static int eval_instr(RangeContext *rc, int b, IRInstr *instr, Range *out) {
+    Range x, y;
+
+    switch (instr->op) {
+        case IR_ASSIGN:
+            return operand_range(rc, instr->src[0], b, 0, out);
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+            if (!operand_range(rc, instr->src[0], b, 0, &x) || !operand_range(rc, instr->src[1], b, 0, &y)) {
+                return 0;
+            }
+            *out = arithmetic_range(instr->op, x, y);
+            return 1;
+        case IR_EQ:
+        case IR_NE:
+        case IR_LT:
+        case IR_GT:
+        case IR_LE:
+        case IR_GE: {
+            if (!operand_range(rc, instr->src[0], b, 0, &x) || !operand_range(rc, instr->src[1], b, 0, &y)) {
+                return 0;
+            }
+            int decided = compare_ranges(instr->op, x, y);
+            *out = decided < 0 ? make_range(0, 1) : make_range(decided, decided);
+            return 1;
+        }
+        case IR_AND:
+        case IR_OR:
+            *out = make_range(0, 1);
+            return 1;
+        case IR_KEY:
+            *out = make_range(INT_MIN, INT_MAX);
+            return 1;
+        case IR_PHI: {
+            int any = 0;
+            for (int j = 0; j < instr->arg_count; j++) {
+                Range arg;
+                if (!operand_range(rc, instr->args[j], instr->arg_blocks[j], 0, &arg)) continue;
+                *out = any ? hull(*out, arg) : arg;
+                any = 1;
+            }
+            return any;
+        }
+        default:
+            *out = unknown_range();
+            return 1;
+    }
+}
+
+// --- Umbrales de ensanchamiento ---
+
+static int compare_long(const void *a, const void *b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void collect_thresholds(RangeContext *rc) {
+    IRFunction *fn = rc->fn;
+    int capacity = 16;
+    rc->thresholds = (long long*)malloc(capacity * sizeof(long long));
+    rc->threshold_count = 0;
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            if (!is_comparison(instr->op)) continue;
+            for (int k = 0; k < 2; k++) {
+                if (instr->src[k].kind != OPND_INT) continue;
+                if (rc->threshold_count + 3 > capacity) {
+                    capacity *= 2;
+                    rc->thresholds = (long long*)realloc(rc->thresholds, capacity * sizeof(long long));
+                }
+                for (int d = -1; d <= 1; d++) {
+                    rc->thresholds[rc->threshold_count++] = (long long)instr->src[k].u.int_value + d;
+                }
+            }
+        }
+    }
+    qsort(rc->thresholds, rc->threshold_count, sizeof(long long), compare_long);
+}
+
+static Range widen(RangeContext *rc, Range old, Range r) {
+    if (!is_integer(r)) return r;
+    if (r.low < old.low) {
+        long long low = INT_MIN;
+        for (int i = rc->threshold_count - 1; i >= 0; i--) {
+            if (rc->thresholds[i] <= r.low && rc->thresholds[i] >= INT_MIN) {
+                low = rc->thresholds[i];
+                break;
+            }
+        }
+        r.low = low;
+    }
+    if (r.high > old.high) {
+        long long high = INT_MAX;
+        for (int i = 0; i < rc->threshold_count; i++) {
+            if (rc->thresholds[i] >= r.high && rc->thresholds[i] <= INT_MAX) {
+                high = rc->thresholds[i];
+                break;
+            }
+        }
+        r.high = high;
+    }
+    return r;
+}
+
+static int compare_edges(const void *a, const void *b) {
+    const RangeEdge *x = (const RangeEdge*)a, *y = (const RangeEdge*)b;
+    return x->var - y->var;
+}
+
+// Lados de los saltos sobre una comparación con una variable propia
+static void collect_edges(RangeContext *rc) {
+    IRFunction *fn = rc->fn;
+    int count = 0;
+    rc->edges = (RangeEdge*)malloc((4 * fn->block_count + 1) * sizeof(RangeEdge));
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        if (rc->dom->rpo_index[b] < 0 || block->term != TERM_BRANCH || block->succ[0] == block->succ[1] ||
+            block->cond.kind != OPND_VAR || !rc->def[block->cond.u.var]) {
+            continue;
+        }
+        IRInstr *cmp = rc->def[block->cond.u.var];
+        if (!is_comparison(cmp->op)) continue;
+        for (int k = 0; k < 2; k++) {
+            Operand op = cmp->src[k];
+            if (op.kind != OPND_VAR || !rc->def[op.u.var]) continue;
+            if (k == 1 && cmp->src[0].kind == OPND_VAR && cmp->src[0].u.var == op.u.var) continue;
+            for (int s = 0; s < 2; s++) {
+                if (fn->blocks[block->succ[s]].pred_count != 1) continue;
+                RangeEdge *edge = &rc->edges[count++];
+                edge->var = op.u.var;
+                edge->branch = b;
+                edge->target = block->succ[s];
+                edge->taken = s == 0;
+            }
+        }
+    }
+    qsort(rc->edges, count, sizeof(RangeEdge), compare_edges);
+
+    rc->edge_start = (int*)calloc(fn->var_count + 2, sizeof(int));
+    for (int e = 0; e < count; e++) rc->edge_start[rc->edges[e].var + 1]++;
+    for (int v = 0; v < fn->var_count; v++) rc->edge_start[v + 1] += rc->edge_start[v];
+}
+
+// 1 o 0 si el salto de 'b' va siempre por ese lado; -1 si no se sabe
+static int branch_decision(RangeContext *rc, int b) {
+    IRBlock *block = &rc->fn->blocks[b];
+    Range r;
+    if (!operand_range(rc, block->cond, b, 0, &r)) return -1;
+    if (is_integer(r) && (r.low > 0 || r.high < 0)) return 1;
+    if (r.low == 0 && r.high == 0) return 0;
+
+    // La comparación, con sus operandos acotados en el propio salto
+    if (block->cond.kind != OPND_VAR || !rc->def[block->cond.u.var]) return -1;
+    IRInstr *cmp = rc->def[block->cond.u.var];
+    Range x, y;
+    if (!is_comparison(cmp->op) || !operand_range(rc, cmp->src[0], b, 0, &x) ||
+        !operand_range(rc, cmp->src[1], b, 0, &y)) {
+        return -1;
+    }
+    return compare_ranges(cmp->op, x, y);
+}
+
+int range_fold_branches(IRFunction *fn, OptStats *stats) {
+    RangeContext rc;
+    memset(&rc, 0, sizeof(rc));
+    rc.fn = fn;
+    rc.dom = cfg_dominators(fn);
+    rc.def = (IRInstr**)calloc(fn->var_count + 1, sizeof(IRInstr*));
+    rc.range = (Range*)malloc((fn->var_count + 1) * sizeof(Range));
+    rc.known = (char*)calloc(fn->var_count + 1, 1);
+    rc.updates = (int*)calloc(fn->var_count + 1, sizeof(int));
+    collect_thresholds(&rc);
+
+    for (int i = 0; i < rc.dom->rpo_count; i++) {
+        int b = rc.dom->rpo[i];
+        IRBlock *block = &fn->blocks[b];
+        for (int j = 0; j < block->count; j++) {
+            int def = ir_instr_def(&block->instrs[j]);
+            if (def < 0 || !is_local(fn, def)) continue;
+            rc.def[def] = &block->instrs[j];
+        }
+    }
+    collect_edges(&rc);
+
+    // Pasadas ascendentes en orden posterior inverso, ensanchando los phi
+    int stable = 0;
+    for (int pass = 0; pass < RANGE_MAX_PASSES && !stable; pass++) {
+        stable = 1;
+        for (int i = 0; i < rc.dom->rpo_count; i++) {
+            int b = rc.dom->rpo[i];
+            IRBlock *block = &fn->blocks[b];
+            for (int j = 0; j < block->count; j++) {
+                IRInstr *instr = &block->instrs[j];
+                int v = ir_instr_def(instr);
+                Range r;
+                if (v < 0 || rc.def[v] != instr || !eval_instr(&rc, b, instr, &r)) continue;
+                if (!rc.known[v]) {
+                    rc.known[v] = 1;
+                    rc.range[v] = r;
+                    stable = 0;
+                    continue;
+                }
+
+                Range old = rc.range[v];
+                Range joined = hull(old, r);
+                if (joined.low == old.low && joined.high == old.high) continue;
+                if (instr->op == IR_PHI && ++rc.updates[v] > RANGE_WIDEN_AFTER) {
+                    joined = widen(&rc, old, joined);
+                }
+                rc.range[v] = joined;
+                stable = 0;
+            }
+        }
+    }
+
+    int folded = 0;
+    if (stable) {
+        // Pasadas descendentes: cada intervalo se recalcula desde sus operandos
+        for (int pass = 0; pass < RANGE_NARROW_PASSES; pass++) {
+            for (int i = 0; i < rc.dom->rpo_count; i++) {
+                int b = rc.dom->rpo[i];
+                IRBlock *block = &fn->blocks[b];
+                for (int j = 0; j < block->count; j++) {
+                    IRInstr *instr = &block->instrs[j];
+                    int v = ir_instr_def(instr);
+                    Range r;
+                    if (v < 0 || rc.def[v] != instr || !rc.known[v] || !eval_instr(&rc, b, instr, &r)) continue;
+                    if (r.low > rc.range[v].low) rc.range[v].low = r.low;
+                    if (r.high < rc.range[v].high) rc.range[v].high = r.high;
+                    if (rc.range[v].low > rc.range[v].high) rc.range[v] = r;
+                }
+            }
+        }
+
+        // Se decide todo antes de cambiar el CFG: los acotamientos leen los saltos
+        int *decision = (int*)malloc((fn->block_count + 1) * sizeof(int));
+        for (int b = 0; b < fn->block_count; b++) {
+            decision[b] = -1;
+            if (rc.dom->rpo_index[b] >= 0 && fn->blocks[b].term == TERM_BRANCH) {
+                decision[b] = branch_decision(&rc, b);
+            }
+        }
+        for (int b = 0; b < fn->block_count; b++) {
+            if (decision[b] < 0) continue;
+            IRBlock *block = &fn->blocks[b];
+            ir_set_goto(fn, b, decision[b] ? block->succ[0] : block->succ[1]);
+            folded++;
+        }
+        stats->range_folded += folded;
+        free(decision);
+    }
+
+    cfg_free_dominators(rc.dom);
+    free(rc.def);
+    free(rc.range);
+    free(rc.known);
+    free(rc.updates);
+    free(rc.thresholds);
+    free(rc.edges);
+    free(rc.edge_start);
+    return folded;
+}
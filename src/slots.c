@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "cfg.h"
+#include "callgraph.h"
+
+// Ranuras compartidas para las variables propias de las funciones. En
+// FIS-25 cada VAR es un nombre global, así que la tabla de variables de la
+// máquina crece con el programa entero. Dos funciones que nunca están
+// activas a la vez pueden usar los mismos nombres: a cada función se le da
+// un marco de ranuras que empieza después de los marcos de todas las que
+// pueden llamarla, como una pila calculada en compilación.
+//
+// No se comparten las variables de funciones recursivas (una llamada pisa
+// las del llamador por diseño) ni las que se leen antes de escribirse, que
+// conservan el valor de la llamada anterior.
+
+// Variables propias de la función que pueden ir en ranuras; devuelve cuántas
+static int shareable_vars(IRFunction *fn, int *shared) {
+    int *unassigned = cfg_unassigned_reads(fn);
+    int count = 0;
+
+    for (int v = 0; v < fn->var_count; v++) shared[v] = 0;
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            if (instr->dst.kind == OPND_VAR) shared[instr->dst.u.var] = 1;
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (op->kind == OPND_VAR) shared[op->u.var] = 1;
+            }
+        }
+        if (block->term == TERM_BRANCH && block->cond.kind == OPND_VAR) shared[block->cond.u.var] = 1;
+    }
+    for (int v = 0; v < fn->var_count; v++) {
+        IRVarKind kind = fn->vars[v].kind;
+        if (kind == IRVAR_GLOBAL || kind == IRVAR_RETURN || unassigned[v]) shared[v] = 0;
+        count += shared[v];
+    }
+
+    free(unassigned);
+    return count;
+}
+
+int assign_variable_slots(IRProgram *program, OptStats *stats) {
+    // El grafo se vuelve a construir: la expansión en línea quitó llamadas
+    CallGraph *graph = build_call_graph(program);
+    int n = program->function_count;
+    int *order = (int*)malloc((n + 1) * sizeof(int));
+    int *start = (int*)calloc(n + 2, sizeof(int));
+    int *offset = (int*)calloc(n + 1, sizeof(int));
+    int *size = (int*)calloc(n + 1, sizeof(int));
+    int slots = 0;
+
+    // Tarjan numera una componente después de todas las que llama: de
+    // mayor a menor número se visitan los llamadores antes que los llamados
+    for (int f = 0; f < n; f++) start[n - graph->scc[f]]++;
+    for (int c = 0; c <= n; c++) start[c + 1] += start[c];
+    for (int f = 0; f < n; f++) order[start[n - 1 - graph->scc[f]]++] = f;
+
+    for (int k = 0; k < n; ) {
+        // Todas las funciones de una componente empiezan en el mismo lugar
+        int end = k, frame = 0;
+        while (end < n && graph->scc[order[end]] == graph->scc[order[k]]) {
+            if (offset[order[end]] > frame) frame = offset[order[end]];
+            end++;
+        }
+
+        for (int j = k; j < end; j++) {
+            int f = order[j];
+            IRFunction *fn = program->functions[f];
+            offset[f] = frame;
+            if (graph->recursive[f]) continue;
+
+            int *shared = (int*)malloc((fn->var_count + 1) * sizeof(int));
+            for (int v = 0; v < fn->var_count; v++) fn->vars[v].slot = -1;
+            size[f] = shareable_vars(fn, shared);
+            int next = frame;
+            for (int v = 0; v < fn->var_count; v++) {
+                if (shared[v]) fn->vars[v].slot = next++;
+            }
+            stats->slotted_vars += size[f];
+            if (next > slots) slots = next;
+            free(shared);
+        }
+
+        // Los marcos de los llamados van encima del de cada llamador
+        for (int j = k; j < end; j++) {
+            int f = order[j];
+            for (int e = graph->callee_start[f]; e < graph->callee_start[f + 1]; e++) {
+                int g = graph->callees[e];
+                if (graph->scc[g] == graph->scc[f]) continue;
+                if (offset[f] + size[f] > offset[g]) offset[g] = offset[f] + size[f];
+            }
+        }
+        k = end;
+    }
+
+    stats->slots += slots;
+
+    free(order);
+    free(start);
+    free(offset);
+    free(size);
+    free_call_graph(graph);
+    return slots;
+}
@@ -0,0 +1,1261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Optimización de una función en forma SSA:
+// 1. construcción (phi en la frontera de dominancia iterada, semipodada)
+// 2. propagación de constantes condicional dispersa (Wegman-Zadeck)
+// 3. propagación de copias y eliminación de phi triviales, y saltos
+//    resueltos por el análisis de rangos (range.c)
+// 4. movimiento de código invariante fuera de los lazos (licm.c) y
+//    reducción de fuerza (strength.c)
+// 5. eliminación agresiva de código muerto con dependencias de control
+// 6. salida de SSA: copias en los predecesores y fusión de variables que
+//    no interfieren, para no multiplicar las variables FIS-25
+//
+// Solo los parámetros, locales y temporales entran en SSA. Los globales y
+// los ret_<función> pueden cambiar en cualquier llamada y se tratan como
+// memoria.
+
+enum { LAT_TOP, LAT_CONST, LAT_BOTTOM };
+
+typedef struct SSAContext {
+    IRFunction *fn;
+    OptStats *stats;
+    DomInfo *dom;
+
+    int original_count;     // Variables anteriores a la construcción
+    int *current;           // Versión vigente de cada variable original
+    int *undo;              // Pares (variable, versión anterior)
+    int undo_count;
+    int undo_capacity;
+
+    int *def_block;         // Definición de cada variable SSA; -1 si viene de la entrada
+    int *def_index;
+
+    // Usos de cada variable: (bloque, instrucción); -1 es el terminador
+    int *use_start;
+    int *use_block;
+    int *use_index;
+} SSAContext;
+
+static int is_local(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    return kind != IRVAR_GLOBAL && kind != IRVAR_RETURN;
+}
+
+static int is_local_operand(IRFunction *fn, Operand op) {
+    return op.kind == OPND_VAR && is_local(fn, op.u.var);
+}
+
+static int is_immediate(Operand op) {
+    return op.kind == OPND_INT || op.kind == OPND_FLOAT || op.kind == OPND_STRING;
+}
+
+static int has_side_effects(IRFunction *fn, IRInstr *instr) {
+    switch (instr->op) {
+        case IR_CALL:
+        case IR_PIXEL:
+        case IR_KEY:
+        case IR_INPUT:
+        case IR_PRINT:
+        case IR_PARAM_GET:
+            return 1;
+        default: {
+            int def = ir_instr_def(instr);
+            return def >= 0 && !is_local(fn, def);
+        }
+    }
+}
+
+// --- Preparación del CFG ---
+
+// La entrada no debe tener predecesores: los phi no tendrían de dónde
+// tomar el valor inicial
+static void ensure_entry_without_preds(IRFunction *fn) {
+    ir_compute_preds(fn);
+    if (fn->blocks[fn->entry].pred_count == 0) return;
+
+    int entry = ir_new_block(fn);
+    ir_set_goto(fn, entry, fn->entry);
+    fn->entry = entry;
+    ir_place_block(fn, entry);
+    memmove(&fn->layout[1], &fn->layout[0], (fn->layout_count - 1) * sizeof(int));
+    fn->layout[0] = entry;
+    ir_compute_preds(fn);
+}
+
+static void strip_declarations(IRFunction *fn) {
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            if (block->instrs[i].op == IR_VAR) block->instrs[i].op = IR_NOP;
+        }
+    }
+    ir_remove_nops(fn);
+}
+
+// Quita de cada phi los argumentos de bloques que ya no son predecesores
+static void prune_phis(IRFunction *fn) {
+    ir_compute_preds(fn);
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *phi = &block->instrs[i];
+            if (phi->op != IR_PHI) continue;
+
+            int kept = 0;
+            for (int j = 0; j < phi->arg_count; j++) {
+                int is_pred = 0;
+                for (int p = 0; p < block->pred_count; p++) {
+                    if (block->preds[p] == phi->arg_blocks[j]) is_pred = 1;
+                }
+                if (is_pred) {
+                    phi->args[kept] = phi->args[j];
+                    phi->arg_blocks[kept] = phi->arg_blocks[j];
+                    kept++;
+                }
+            }
+            phi->arg_count = kept;
+        }
+    }
+}
+
+// --- Construcción de SSA ---
+
+static void int_list_add(int **items, int *count, int *capacity, int value) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 4;
+        *items = (int*)realloc(*items, *capacity * sizeof(int));
+    }
+    (*items)[(*count)++] = value;
+}
+
+static void insert_phis(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    DomInfo *dom = ctx->dom;
+    int n = fn->block_count;
+    int vars = ctx->original_count;
+
+    // Fronteras de dominancia
+    int **df = (int**)calloc(n, sizeof(int*));
+    int *df_count = (int*)calloc(n, sizeof(int));
+    int *df_capacity = (int*)calloc(n, sizeof(int));
+    for (int b = 0; b < n; b++) {
+        IRBlock *block = &fn->blocks[b];
+        if (dom->rpo_index[b] < 0 || block->pred_count < 2) continue;
+        for (int p = 0; p < block->pred_count; p++) {
+            int runner = block->preds[p];
+            if (dom->rpo_index[runner] < 0) continue;
+            while (runner != dom->idom[b]) {
+                if (df_count[runner] == 0 || df[runner][df_count[runner] - 1] != b) {
+                    int_list_add(&df[runner], &df_count[runner], &df_capacity[runner], b);
+                }
+                runner = dom->idom[runner];
+            }
+        }
+    }
+
+    // Variables usadas antes de definirse en algún bloque (SSA semipodada)
+    // y bloques que definen cada variable
+    char *nonlocal = (char*)calloc(vars + 1, 1);
+    int *stamp = (int*)malloc((vars + 1) * sizeof(int));
+    int **def_blocks = (int**)calloc(vars + 1, sizeof(int*));
+    int *def_count = (int*)calloc(vars + 1, sizeof(int));
+    int *def_capacity = (int*)calloc(vars + 1, sizeof(int));
+    for (int v = 0; v < vars; v++) stamp[v] = -1;
+
+    for (int i = 0; i < dom->rpo_count; i++) {
+        int b = dom->rpo[i];
+        IRBlock *block = &fn->blocks[b];
+        for (int j = 0; j < block->count; j++) {
+            IRInstr *instr = &block->instrs[j];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (is_local_operand(fn, *op) && stamp[op->u.var] != b) nonlocal[op->u.var] = 1;
+            }
+            int def = ir_instr_def(instr);
+            if (def >= 0 && is_local(fn, def) && stamp[def] != b) {
+                stamp[def] = b;
+                int_list_add(&def_blocks[def], &def_count[def], &def_capacity[def], b);
+            }
+        }
+        if (block->term == TERM_BRANCH && is_local_operand(fn, block->cond) &&
+            stamp[block->cond.u.var] != b) {
+            nonlocal[block->cond.u.var] = 1;
+        }
+    }
+
+    // Frontera de dominancia iterada de los bloques que definen cada variable
+    int *has_phi = (int*)malloc(n * sizeof(int));
+    int *queued = (int*)malloc(n * sizeof(int));
+    int *work = (int*)malloc((n + 1) * sizeof(int));
+    for (int b = 0; b < n; b++) has_phi[b] = queued[b] = -1;
+
+    for (int v = 0; v < vars; v++) {
+        if (!nonlocal[v] || def_count[v] == 0) continue;
+
+        int top = 0;
+        for (int i = 0; i < def_count[v]; i++) {
+            work[top++] = def_blocks[v][i];
+            queued[def_blocks[v][i]] = v;
+        }
+        while (top > 0) {
+            int x = work[--top];
+            for (int i = 0; i < df_count[x]; i++) {
+                int y = df[x][i];
+                if (has_phi[y] == v) continue;
+                has_phi[y] = v;
+
+                IRBlock *block = &fn->blocks[y];
+                IRInstr *phi = ir_insert(fn, y, 0, IR_PHI);
+                phi->dst = ir_var(v);
+                phi->arg_count = block->pred_count;
+                phi->args = (Operand*)malloc(block->pred_count * sizeof(Operand));
+                phi->arg_blocks = (int*)malloc(block->pred_count * sizeof(int));
+                for (int p = 0; p < block->pred_count; p++) {
+                    phi->args[p] = ir_var(v);
+                    phi->arg_blocks[p] = block->preds[p];
+                }
+                ctx->stats->phis++;
+
+                if (queued[y] != v) {
+                    queued[y] = v;
+                    work[top++] = y;
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < n; b++) free(df[b]);
+    for (int v = 0; v < vars; v++) free(def_blocks[v]);
+    free(df);
+    free(df_count);
+    free(df_capacity);
+    free(nonlocal);
+    free(stamp);
+    free(def_blocks);
+    free(def_count);
+    free(def_capacity);
+    free(has_phi);
+    free(queued);
+    free(work);
+}
+
+static int new_version(SSAContext *ctx, int original) {
+    IRVar source = ctx->fn->vars[original];
+    int version = ir_add_var(ctx->fn, IRVAR_TEMP, source.name, source.symbol, source.type);
+    ctx->fn->vars[version].origin = original;
+    return version;
+}
+
+static void rename_block(SSAContext *ctx, int b) {
+    IRFunction *fn = ctx->fn;
+    int mark = ctx->undo_count;
+
+    for (int i = 0; i < fn->blocks[b].count; i++) {
+        IRInstr *instr = &fn->blocks[b].instrs[i];
+        if (instr->op != IR_PHI) {
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (is_local_operand(fn, *op)) op->u.var = ctx->current[op->u.var];
+            }
+        }
+
+        int def = ir_instr_def(instr);
+        if (def >= 0 && is_local(fn, def)) {
+            int version = new_version(ctx, def);
+            if (ctx->undo_count + 2 > ctx->undo_capacity) {
+                ctx->undo_capacity = ctx->undo_capacity ? ctx->undo_capacity * 2 : 64;
+                ctx->undo = (int*)realloc(ctx->undo, ctx->undo_capacity * sizeof(int));
+            }
+            ctx->undo[ctx->undo_count++] = def;
+            ctx->undo[ctx->undo_count++] = ctx->current[def];
+            ctx->current[def] = version;
+            instr->dst.u.var = version;
+        }
+    }
+
+    IRBlock *block = &fn->blocks[b];
+    if (block->term == TERM_BRANCH && is_local_operand(fn, block->cond)) {
+        block->cond.u.var = ctx->current[block->cond.u.var];
+    }
+
+    for (int s = 0; s < ir_successor_count(block); s++) {
+        IRBlock *succ = &fn->blocks[block->succ[s]];
+        for (int i = 0; i < succ->count; i++) {
+            IRInstr *phi = &succ->instrs[i];
+            if (phi->op != IR_PHI) continue;
+            int original = fn->vars[phi->dst.u.var].origin;
+            for (int j = 0; j < phi->arg_count; j++) {
+                if (phi->arg_blocks[j] == b) phi->args[j] = ir_var(ctx->current[original]);
+            }
+        }
+    }
+
+    DomInfo *dom = ctx->dom;
+    for (int c = dom->child_start[b]; c < dom->child_start[b + 1]; c++) {
+        rename_block(ctx, dom->children[c]);
+    }
+
+    while (ctx->undo_count > mark) {
+        int previous = ctx->undo[--ctx->undo_count];
+        int var = ctx->undo[--ctx->undo_count];
+        ctx->current[var] = previous;
+    }
+}
+
+static void build_ssa(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+
+    ctx->original_count = fn->var_count;
+    ctx->current = (int*)malloc((fn->var_count + 1) * sizeof(int));
+    // La IR puede venir de una pasada SSA anterior (evaluate_calls vuelve a
+    // optimizar): sus versiones pasan a ser variables originales de esta
+    for (int v = 0; v < fn->var_count; v++) {
+        ctx->current[v] = v;
+        fn->vars[v].origin = v;
+    }
+
+    insert_phis(ctx);
+    rename_block(ctx, fn->entry);
+}
+
+// Posición de la definición y lista de usos de cada variable
+static void index_defs_and_uses(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    int vars = fn->var_count;
+
+    free(ctx->def_block);
+    free(ctx->def_index);
+    free(ctx->use_start);
+    free(ctx->use_block);
+    free(ctx->use_index);
+
+    ctx->def_block = (int*)malloc((vars + 1) * sizeof(int));
+    ctx->def_index = (int*)malloc((vars + 1) * sizeof(int));
+    ctx->use_start = (int*)calloc(vars + 2, sizeof(int));
+    for (int v = 0; v < vars; v++) ctx->def_block[v] = ctx->def_index[v] = -1;
+
+    for (int pass = 0; pass < 2; pass++) {
+        int *fill = NULL;
+        if (pass == 1) {
+            for (int v = 0; v < vars; v++) ctx->use_start[v + 1] += ctx->use_start[v];
+            ctx->use_block = (int*)malloc((ctx->use_start[vars] + 1) * sizeof(int));
+            ctx->use_index = (int*)malloc((ctx->use_start[vars] + 1) * sizeof(int));
+            fill = (int*)malloc((vars + 1) * sizeof(int));
+            memcpy(fill, ctx->use_start, vars * sizeof(int));
+        }
+
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i <= block->count; i++) {
+                if (i == block->count) {
+                    if (block->term != TERM_BRANCH || block->cond.kind != OPND_VAR) continue;
+                    int v = block->cond.u.var;
+                    if (pass == 0) {
+                        ctx->use_start[v + 1]++;
+                    } else {
+                        ctx->use_block[fill[v]] = b;
+                        ctx->use_index[fill[v]++] = -1;
+                    }
+                    continue;
+                }
+
+                IRInstr *instr = &block->instrs[i];
+                if (pass == 0) {
+                    int def = ir_instr_def(instr);
+                    if (def >= 0) {
+                        ctx->def_block[def] = b;
+                        ctx->def_index[def] = i;
+                    }
+                }
+                for (int k = 0; k < ir_use_count(instr); k++) {
+                    Operand *op = ir_use_at(instr, k);
+                    if (op->kind != OPND_VAR) continue;
+                    int v = op->u.var;
+                    if (pass == 0) {
+                        ctx->use_start[v + 1]++;
+                    } else {
+                        ctx->use_block[fill[v]] = b;
+                        ctx->use_index[fill[v]++] = i;
+                    }
+                }
+            }
+        }
+        free(fill);
+    }
+}
+
+// --- Propagación de constantes condicional dispersa ---
+
+typedef struct SCCP {
+    SSAContext *ctx;
+    char *state;
+    int *value;
+    char *exec;             // exec[2 * bloque + i]: la arista hacia succ[i] es ejecutable
+    char *visited;
+    int *flow;              // Pares (origen, destino) de aristas por procesar
+    int flow_count;
+    int flow_capacity;
+    int *ssa_work;
+    int ssa_count;
+    int ssa_capacity;
+} SCCP;
+
+static int edge_slot(IRFunction *fn, int from, int to) {
+    return fn->blocks[from].succ[0] == to ? 0 : 1;
+}
+
+static int edge_executable(SCCP *s, int from, int to) {
+    return s->exec[2 * from + edge_slot(s->ctx->fn, from, to)];
+}
+
+static void push_edge(SCCP *s, int from, int to) {
+    if (from >= 0 && edge_executable(s, from, to)) return;
+    if (s->flow_count + 2 > s->flow_capacity) {
+        s->flow_capacity = s->flow_capacity ? s->flow_capacity * 2 : 64;
+        s->flow = (int*)realloc(s->flow, s->flow_capacity * sizeof(int));
+    }
+    s->flow[s->flow_count++] = from;
+    s->flow[s->flow_count++] = to;
+}
+
+static int lattice_of(SCCP *s, Operand op, int *value) {
+    switch (op.kind) {
+        case OPND_INT:
+            *value = op.u.int_value;
+            return LAT_CONST;
+        case OPND_VAR:
+            *value = s->value[op.u.var];
+            return s->state[op.u.var];
+        default:
+            return LAT_BOTTOM;
+    }
+}
+
+static void lower_lattice(SCCP *s, int var, int state, int value) {
+    if (state == LAT_TOP || s->state[var] == LAT_BOTTOM) return;
+    if (s->state[var] == LAT_CONST) {
+        if (state == LAT_CONST && value == s->value[var]) return;
+        state = LAT_BOTTOM;
+    }
+    s->state[var] = (char)state;
+    s->value[var] = value;
+
+    if (s->ssa_count == s->ssa_capacity) {
+        s->ssa_capacity = s->ssa_capacity ? s->ssa_capacity * 2 : 64;
+        s->ssa_work = (int*)realloc(s->ssa_work, s->ssa_capacity * sizeof(int));
+    }
+    s->ssa_work[s->ssa_count++] = var;
+}
+
+static void sccp_eval_instr(SCCP *s, int b, int i) {
+    IRFunction *fn = s->ctx->fn;
+    IRInstr *instr = &fn->blocks[b].instrs[i];
+    int def = ir_instr_def(instr);
+    if (def < 0 || !is_local(fn, def)) return;
+
+    int state = LAT_BOTTOM, value = 0;
+    switch (instr->op) {
+        case IR_PHI:
+            state = LAT_TOP;
+            for (int j = 0; j < instr->arg_count && state != LAT_BOTTOM; j++) {
+                if (!edge_executable(s, instr->arg_blocks[j], b)) continue;
+                int arg_value;
+                int arg_state = lattice_of(s, instr->args[j], &arg_value);
+                if (arg_state == LAT_TOP) continue;
+                if (arg_state == LAT_BOTTOM || (state == LAT_CONST && arg_value != value)) {
+                    state = LAT_BOTTOM;
+                } else {
+                    state = LAT_CONST;
+                    value = arg_value;
+                }
+            }
+            break;
+
+        case IR_ASSIGN:
+            state = lattice_of(s, instr->src[0], &value);
+            break;
+
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_GT: case IR_LE: case IR_GE:
+        case IR_AND: case IR_OR: {
+            int a, c;
+            int state_a = lattice_of(s, instr->src[0], &a);
+            int state_c = lattice_of(s, instr->src[1], &c);
+            if (state_a == LAT_BOTTOM || state_c == LAT_BOTTOM) {
+                state = LAT_BOTTOM;
+            } else if (state_a == LAT_TOP || state_c == LAT_TOP) {
+                state = LAT_TOP;
+            } else {
+                state = ir_fold_binary(instr->op, a, c, &value) ? LAT_CONST : LAT_BOTTOM;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    lower_lattice(s, def, state, value);
+}
+
+static void sccp_eval_term(SCCP *s, int b) {
+    IRBlock *block = &s->ctx->fn->blocks[b];
+    int value;
+
+    switch (block->term) {
+        case TERM_GOTO:
+            push_edge(s, b, block->succ[0]);
+            break;
+        case TERM_BRANCH:
+            switch (lattice_of(s, block->cond, &value)) {
+                case LAT_TOP:
+                    break;
+                case LAT_CONST:
+                    push_edge(s, b, value != 0 ? block->succ[0] : block->succ[1]);
+                    break;
+                default:
+                    push_edge(s, b, block->succ[0]);
+                    push_edge(s, b, block->succ[1]);
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void run_sccp(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    SCCP s;
+    memset(&s, 0, sizeof(s));
+    s.ctx = ctx;
+    s.state = (char*)malloc(fn->var_count + 1);
+    s.value = (int*)calloc(fn->var_count + 1, sizeof(int));
+    s.exec = (char*)calloc(2 * fn->block_count + 2, 1);
+    s.visited = (char*)calloc(fn->block_count + 1, 1);
+
+    // Lo que no se define dentro de la función (globales, valores de
+    // entrada) es desconocido
+    for (int v = 0; v < fn->var_count; v++) {
+        s.state[v] = (is_local(fn, v) && ctx->def_block[v] >= 0) ? LAT_TOP : LAT_BOTTOM;
+    }
+
+    push_edge(&s, -1, fn->entry);
+    while (s.flow_count > 0 || s.ssa_count > 0) {
+        while (s.flow_count > 0) {
+            int to = s.flow[--s.flow_count];
+            int from = s.flow[--s.flow_count];
+            if (from >= 0) {
+                int slot = edge_slot(fn, from, to);
+                if (s.exec[2 * from + slot]) continue;
+                s.exec[2 * from + slot] = 1;
+            }
+
+            IRBlock *block = &fn->blocks[to];
+            if (!s.visited[to]) {
+                s.visited[to] = 1;
+                for (int i = 0; i < block->count; i++) sccp_eval_instr(&s, to, i);
+                sccp_eval_term(&s, to);
+            } else {
+                for (int i = 0; i < block->count; i++) {
+                    if (block->instrs[i].op == IR_PHI) sccp_eval_instr(&s, to, i);
+                }
+            }
+        }
+
+        while (s.ssa_count > 0) {
+            int v = s.ssa_work[--s.ssa_count];
+            for (int u = ctx->use_start[v]; u < ctx->use_start[v + 1]; u++) {
+                int b = ctx->use_block[u];
+                if (!s.visited[b]) continue;
+                if (ctx->use_index[u] < 0) {
+                    sccp_eval_term(&s, b);
+                } else {
+                    sccp_eval_instr(&s, b, ctx->use_index[u]);
+                }
+            }
+        }
+    }
+
+    // Sustituye las constantes y resuelve los saltos
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        if (!s.visited[b]) continue;
+
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (op->kind == OPND_VAR && s.state[op->u.var] == LAT_CONST) {
+                    *op = ir_int(s.value[op->u.var]);
+                    ctx->stats->constants++;
+                }
+            }
+        }
+        if (block->term == TERM_BRANCH) {
+            if (block->cond.kind == OPND_VAR && s.state[block->cond.u.var] == LAT_CONST) {
+                block->cond = ir_int(s.value[block->cond.u.var]);
+                ctx->stats->constants++;
+            }
+            if (block->cond.kind == OPND_INT) {
+                ir_set_goto(fn, b, block->cond.u.int_value != 0 ? block->succ[0] : block->succ[1]);
+                ctx->stats->branches_folded++;
+            }
+        }
+    }
+
+    cfg_remove_unreachable(fn);
+    prune_phis(fn);
+
+    free(s.state);
+    free(s.value);
+    free(s.exec);
+    free(s.visited);
+    free(s.flow);
+    free(s.ssa_work);
+}
+
+// --- Propagación de copias ---
+
+static Operand resolve_copy(Operand *value_of, Operand op) {
+    while (op.kind == OPND_VAR && value_of[op.u.var].kind != OPND_NONE) {
+        op = value_of[op.u.var];
+    }
+    return op;
+}
+
+static void propagate_copies(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    Operand *value_of = (Operand*)malloc((fn->var_count + 1) * sizeof(Operand));
+    for (int v = 0; v < fn->var_count; v++) value_of[v] = ir_none();
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i < block->count; i++) {
+                IRInstr *instr = &block->instrs[i];
+                int def = ir_instr_def(instr);
+                if (def < 0 || !is_local(fn, def) || value_of[def].kind != OPND_NONE) continue;
+
+                if (instr->op == IR_ASSIGN) {
+                    Operand src = resolve_copy(value_of, instr->src[0]);
+                    if (is_immediate(src) || is_local_operand(fn, src)) {
+                        value_of[def] = src;
+                        changed = 1;
+                    }
+                } else if (instr->op == IR_PHI) {
+                    // phi(x, x, ..., propio) = x
+                    Operand same = ir_none();
+                    int trivial = 1;
+                    for (int j = 0; j < instr->arg_count && trivial; j++) {
+                        Operand arg = resolve_copy(value_of, instr->args[j]);
+                        if (arg.kind == OPND_VAR && arg.u.var == def) continue;
+                        if (same.kind == OPND_NONE) {
+                            same = arg;
+                        } else if (!ir_operand_equal(same, arg)) {
+                            trivial = 0;
+                        }
+                    }
+                    if (trivial && same.kind != OPND_NONE) {
+                        value_of[def] = same;
+                        changed = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                Operand resolved = resolve_copy(value_of, *op);
+                if (!ir_operand_equal(resolved, *op)) {
+                    *op = resolved;
+                    ctx->stats->copies++;
+                }
+            }
+        }
+        if (block->term == TERM_BRANCH) {
+            Operand resolved = resolve_copy(value_of, block->cond);
+            if (!ir_operand_equal(resolved, block->cond)) {
+                block->cond = resolved;
+                ctx->stats->copies++;
+            }
+        }
+    }
+
+    free(value_of);
+}
+
+// --- Eliminación agresiva de código muerto ---
+
+typedef struct ADCE {
+    SSAContext *ctx;
+    int *ipdom;
+    int *offset;            // Índice de la primera instrucción de cada bloque en 'live'
+    char *live;
+    char *term_live;
+    char *block_live;
+    int **cd;               // Bloques cuyo salto controla si se ejecuta cada bloque
+    int *cd_count;
+    int *cd_capacity;
+    int *work;              // Pares (bloque, instrucción)
+    int work_count;
+    int work_capacity;
+} ADCE;
+
+static void mark_term(ADCE *a, int b);
+
+static void mark_block(ADCE *a, int b) {
+    if (a->block_live[b]) return;
+    a->block_live[b] = 1;
+    for (int i = 0; i < a->cd_count[b]; i++) mark_term(a, a->cd[b][i]);
+}
+
+static void mark_instr(ADCE *a, int b, int i) {
+    if (a->live[a->offset[b] + i]) return;
+    a->live[a->offset[b] + i] = 1;
+    if (a->work_count + 2 > a->work_capacity) {
+        a->work_capacity = a->work_capacity ? a->work_capacity * 2 : 64;
+        a->work = (int*)realloc(a->work, a->work_capacity * sizeof(int));
+    }
+    a->work[a->work_count++] = b;
+    a->work[a->work_count++] = i;
+    mark_block(a, b);
+}
+
+static void mark_def(ADCE *a, Operand op) {
+    if (op.kind != OPND_VAR) return;
+    int b = a->ctx->def_block[op.u.var];
+    if (b >= 0) mark_instr(a, b, a->ctx->def_index[op.u.var]);
+}
+
+static void mark_term(ADCE *a, int b) {
+    if (a->term_live[b]) return;
+    a->term_live[b] = 1;
+    mark_block(a, b);
+    IRBlock *block = &a->ctx->fn->blocks[b];
+    if (block->term == TERM_BRANCH) mark_def(a, block->cond);
+}
+
+// Postdominador más cercano con algo vivo; -1 si no hay
+static int live_postdominator(ADCE *a, int b) {
+    int n = a->ctx->fn->block_count;
+    int t = a->ipdom[b];
+    while (t >= 0 && t < n && !a->block_live[t]) t = a->ipdom[t];
+    return (t >= 0 && t < n) ? t : -1;
+}
+
+static int has_live_phi(ADCE *a, int b) {
+    IRBlock *block = &a->ctx->fn->blocks[b];
+    for (int i = 0; i < block->count; i++) {
+        if (block->instrs[i].op == IR_PHI && a->live[a->offset[b] + i]) return 1;
+    }
+    return 0;
+}
+
+static void eliminate_dead_code(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    int n = fn->block_count;
+    int *reachable = ir_reachable_blocks(fn);
+    ADCE a;
+    memset(&a, 0, sizeof(a));
+    a.ctx = ctx;
+    a.ipdom = cfg_postdominators(fn);
+
+    a.offset = (int*)malloc((n + 1) * sizeof(int));
+    a.offset[0] = 0;
+    for (int b = 0; b < n; b++) a.offset[b + 1] = a.offset[b] + fn->blocks[b].count;
+    a.live = (char*)calloc(a.offset[n] + 1, 1);
+    a.term_live = (char*)calloc(n + 1, 1);
+    a.block_live = (char*)calloc(n + 1, 1);
+    a.cd = (int**)calloc(n + 1, sizeof(int*));
+    a.cd_count = (int*)calloc(n + 1, sizeof(int));
+    a.cd_capacity = (int*)calloc(n + 1, sizeof(int));
+
+    // Dependencias de control: los bloques entre un salto y su postdominador
+    for (int b = 0; b < n; b++) {
+        IRBlock *block = &fn->blocks[b];
+        if (!reachable[b] || block->term != TERM_BRANCH) continue;
+        for (int s = 0; s < 2; s++) {
+            int runner = block->succ[s];
+            while (runner >= 0 && runner < n && runner != a.ipdom[b]) {
+                int_list_add(&a.cd[runner], &a.cd_count[runner], &a.cd_capacity[runner], b);
+                runner = a.ipdom[runner];
+            }
+        }
+    }
+
+    // Raíces: efectos visibles, retornos, paradas y bucles sin salida
+    for (int b = 0; b < n; b++) {
+        if (!reachable[b]) continue;
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            if (has_side_effects(fn, &block->instrs[i])) mark_instr(&a, b, i);
+        }
+        if (block->term == TERM_RETURN || block->term == TERM_HALT || a.ipdom[b] < 0) mark_term(&a, b);
+    }
+
+    int changed = 1;
+    while (changed) {
+        while (a.work_count > 0) {
+            int i = a.work[--a.work_count];
+            int b = a.work[--a.work_count];
+            IRInstr *instr = &fn->blocks[b].instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) mark_def(&a, *ir_use_at(instr, k));
+            if (instr->op == IR_PHI) {
+                for (int j = 0; j < instr->arg_count; j++) mark_block(&a, instr->arg_blocks[j]);
+            }
+        }
+
+        // Un salto muerto se reemplaza por un GOTO a su postdominador vivo;
+        // si no lo hay, o tiene phi vivos, el salto se conserva
+        changed = 0;
+        for (int b = 0; b < n; b++) {
+            if (!reachable[b] || fn->blocks[b].term != TERM_BRANCH || a.term_live[b]) continue;
+            int target = live_postdominator(&a, b);
+            if (target < 0 || has_live_phi(&a, target)) {
+                mark_term(&a, b);
+                changed = 1;
+            }
+        }
+        if (a.work_count > 0) changed = 1;
+    }
+
+    for (int b = 0; b < n; b++) {
+        if (!reachable[b]) continue;
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            if (!a.live[a.offset[b] + i] && block->instrs[i].op != IR_NOP) {
+                block->instrs[i].op = IR_NOP;
+                ctx->stats->dead_instructions++;
+            }
+        }
+        if (block->term == TERM_BRANCH && !a.term_live[b]) {
+            ir_set_goto(fn, b, live_postdominator(&a, b));
+            ctx->stats->dead_instructions++;
+        }
+    }
+
+    ir_remove_nops(fn);
+    cfg_remove_unreachable(fn);
+    prune_phis(fn);
+
+    for (int b = 0; b < n; b++) free(a.cd[b]);
+    free(a.cd);
+    free(a.cd_count);
+    free(a.cd_capacity);
+    free(a.offset);
+    free(a.live);
+    free(a.term_live);
+    free(a.block_live);
+    free(a.work);
+    free(a.ipdom);
+    free(reachable);
+}
+
+// --- Salida de SSA ---
+
+// Emite una copia paralela dst[i] = src[i] como secuencia de ASSIGN,
+// rompiendo ciclos con un temporal
+static void emit_parallel_copy(IRFunction *fn, int block, int at_start, int *dst, Operand *src, int count) {
+    int position = 0;
+    char *done = (char*)calloc(count + 1, 1);
+    int remaining = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (src[i].kind == OPND_VAR && src[i].u.var == dst[i]) {
+            done[i] = 1;
+        } else {
+            remaining++;
+        }
+    }
+
+    while (remaining > 0) {
+        int progress = 0;
+        for (int i = 0; i < count; i++) {
+            if (done[i]) continue;
+            int blocked = 0;
+            for (int j = 0; j < count && !blocked; j++) {
+                if (j != i && !done[j] && src[j].kind == OPND_VAR && src[j].u.var == dst[i]) blocked = 1;
+            }
+            if (blocked) continue;
+
+            IRInstr *copy = at_start ? ir_insert(fn, block, position++, IR_ASSIGN)
+                                     : ir_append(fn, block, IR_ASSIGN);
+            copy->dst = ir_var(dst[i]);
+            copy->src[0] = src[i];
+            done[i] = 1;
+            remaining--;
+            progress = 1;
+        }
+
+        if (!progress) {
+            // Ciclo: el valor de un destino se guarda antes de sobrescribirlo
+            int i = 0;
+            while (done[i]) i++;
+            int temp = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, fn->vars[dst[i]].type);
+            IRInstr *save = at_start ? ir_insert(fn, block, position++, IR_ASSIGN)
+                                     : ir_append(fn, block, IR_ASSIGN);
+            save->dst = ir_var(temp);
+            save->src[0] = ir_var(dst[i]);
+            for (int j = 0; j < count; j++) {
+                if (!done[j] && src[j].kind == OPND_VAR && src[j].u.var == dst[i]) src[j] = ir_var(temp);
+            }
+        }
+    }
+
+    free(done);
+}
+
+static void eliminate_phis(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    int original_blocks = fn->block_count;
+
+    ir_compute_preds(fn);
+    for (int b = 0; b < original_blocks; b++) {
+        int phi_count = 0;
+        for (int i = 0; i < fn->blocks[b].count; i++) {
+            if (fn->blocks[b].instrs[i].op == IR_PHI) phi_count++;
+        }
+        if (phi_count == 0) continue;
+
+        int *dst = (int*)malloc(phi_count * sizeof(int));
+        Operand *src = (Operand*)malloc(phi_count * sizeof(Operand));
+        int pred_count = fn->blocks[b].pred_count;
+        int *preds = (int*)malloc((pred_count + 1) * sizeof(int));
+        memcpy(preds, fn->blocks[b].preds, pred_count * sizeof(int));
+
+        for (int p = 0; p < pred_count; p++) {
+            int pred = preds[p];
+            int count = 0;
+            for (int i = 0; i < fn->blocks[b].count; i++) {
+                IRInstr *phi = &fn->blocks[b].instrs[i];
+                if (phi->op != IR_PHI) continue;
+                for (int j = 0; j < phi->arg_count; j++) {
+                    if (phi->arg_blocks[j] == pred) {
+                        dst[count] = phi->dst.u.var;
+                        src[count] = phi->args[j];
+                        count++;
+                        break;
+                    }
+                }
+            }
+
+            // Con las aristas críticas partidas, o el predecesor tiene un solo
+            // sucesor o el bloque tiene un solo predecesor
+            if (ir_successor_count(&fn->blocks[pred]) == 1) {
+                emit_parallel_copy(fn, pred, 0, dst, src, count);
+            } else {
+                emit_parallel_copy(fn, b, 1, dst, src, count);
+            }
+        }
+
+        for (int i = 0; i < fn->blocks[b].count; i++) {
+            if (fn->blocks[b].instrs[i].op == IR_PHI) fn->blocks[b].instrs[i].op = IR_NOP;
+        }
+
+        free(dst);
+        free(src);
+        free(preds);
+    }
+
+    ir_remove_nops(fn);
+}
+
+// Conjuntos de bits sobre las variables de la función
+typedef uint64_t Word;
+#define WORD_BITS 64
+#define BIT_TEST(set, i) (((set)[(i) / WORD_BITS] >> ((i) % WORD_BITS)) & 1)
+#define BIT_SET(set, i) ((set)[(i) / WORD_BITS] |= (Word)1 << ((i) % WORD_BITS))
+#define BIT_CLEAR(set, i) ((set)[(i) / WORD_BITS] &= ~((Word)1 << ((i) % WORD_BITS)))
+
+static int find_root(int *parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+static int interferes(Word *matrix, int words, int a, int b) {
+    return BIT_TEST(&matrix[(size_t)a * words], b);
+}
+
+static void add_interference(Word *matrix, int words, int a, int b) {
+    BIT_SET(&matrix[(size_t)a * words], b);
+    BIT_SET(&matrix[(size_t)b * words], a);
+}
+
+// Une dos clases si no interfieren y no juntan dos variables con nombre
+static int try_coalesce(int *parent, int *named, Word *matrix, int words, int x, int y) {
+    int a = find_root(parent, x);
+    int b = find_root(parent, y);
+    if (a == b) return 1;
+    if (interferes(matrix, words, a, b)) return 0;
+    if (named[a] >= 0 && named[b] >= 0) return 0;
+
+    parent[b] = a;
+    if (named[a] < 0) named[a] = named[b];
+    Word *row_a = &matrix[(size_t)a * words];
+    Word *row_b = &matrix[(size_t)b * words];
+    for (int w = 0; w < words; w++) {
+        Word bits = row_b[w];
+        row_a[w] |= bits;
+        while (bits) {
+            int v = w * WORD_BITS + __builtin_ctzll(bits);
+            BIT_SET(&matrix[(size_t)v * words], a);
+            bits &= bits - 1;
+        }
+    }
+    return 1;
+}
+
+static void coalesce_variables(SSAContext *ctx) {
+    IRFunction *fn = ctx->fn;
+    int vars = fn->var_count;
+    int words = (vars + WORD_BITS - 1) / WORD_BITS;
+    int n = fn->block_count;
+
+    // Vida de las variables (análisis hacia atrás sobre los bloques)
+    Word *live_in = (Word*)calloc((size_t)n * words + 1, sizeof(Word));
+    Word *live_out = (Word*)calloc((size_t)n * words + 1, sizeof(Word));
+    Word *use = (Word*)calloc((size_t)n * words + 1, sizeof(Word));
+    Word *def = (Word*)calloc((size_t)n * words + 1, sizeof(Word));
+    DomInfo *dom = cfg_dominators(fn);
+
+    for (int b = 0; b < n; b++) {
+        IRBlock *block = &fn->blocks[b];
+        Word *u = &use[(size_t)b * words];
+        Word *d = &def[(size_t)b * words];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (is_local_operand(fn, *op) && !BIT_TEST(d, op->u.var)) BIT_SET(u, op->u.var);
+            }
+            int v = ir_instr_def(instr);
+            if (v >= 0 && is_local(fn, v)) BIT_SET(d, v);
+        }
+        if (block->term == TERM_BRANCH && is_local_operand(fn, block->cond) &&
+            !BIT_TEST(d, block->cond.u.var)) {
+            BIT_SET(u, block->cond.u.var);
+        }
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = dom->rpo_count - 1; i >= 0; i--) {
+            int b = dom->rpo[i];
+            IRBlock *block = &fn->blocks[b];
+            Word *out = &live_out[(size_t)b * words];
+            Word *in = &live_in[(size_t)b * words];
+            for (int s = 0; s < ir_successor_count(block); s++) {
+                Word *succ_in = &live_in[(size_t)block->succ[s] * words];
+                for (int w = 0; w < words; w++) out[w] |= succ_in[w];
+            }
+            for (int w = 0; w < words; w++) {
+                Word value = use[(size_t)b * words + w] | (out[w] & ~def[(size_t)b * words + w]);
+                if (value != in[w]) {
+                    in[w] = value;
+                    changed = 1;
+                }
+            }
+        }
+    }
+
+    // Grafo de interferencia
+    Word *matrix = (Word*)calloc((size_t)vars * words + 1, sizeof(Word));
+    Word *live = (Word*)malloc((words + 1) * sizeof(Word));
+    for (int i = 0; i < dom->rpo_count; i++) {
+        int b = dom->rpo[i];
+        IRBlock *block = &fn->blocks[b];
+        memcpy(live, &live_out[(size_t)b * words], words * sizeof(Word));
+        if (block->term == TERM_BRANCH && is_local_operand(fn, block->cond)) {
+            BIT_SET(live, block->cond.u.var);
+        }
+
+        for (int j = block->count - 1; j >= 0; j--) {
+            IRInstr *instr = &block->instrs[j];
+            int d = ir_instr_def(instr);
+            if (d >= 0 && is_local(fn, d)) {
+                int copy_src = (instr->op == IR_ASSIGN && is_local_operand(fn, instr->src[0]))
+                               ? instr->src[0].u.var : -1;
+                for (int w = 0; w < words; w++) {
+                    Word bits = live[w];
+                    while (bits) {
+                        int v = w * WORD_BITS + __builtin_ctzll(bits);
+                        if (v != d && v != copy_src) add_interference(matrix, words, d, v);
+                        bits &= bits - 1;
+                    }
+                }
+                BIT_CLEAR(live, d);
+            }
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (is_local_operand(fn, *op)) BIT_SET(live, op->u.var);
+            }
+        }
+    }
+
+    // Los valores vivos al entrar a la función existen todos a la vez
+    Word *entry_in = &live_in[(size_t)fn->entry * words];
+    for (int x = 0; x < vars; x++) {
+        if (!BIT_TEST(entry_in, x)) continue;
+        for (int y = x + 1; y < vars; y++) {
+            if (BIT_TEST(entry_in, y)) add_interference(matrix, words, x, y);
+        }
+    }
+
+    int *parent = (int*)malloc((vars + 1) * sizeof(int));
+    int *named = (int*)malloc((vars + 1) * sizeof(int));
+    for (int v = 0; v < vars; v++) {
+        parent[v] = v;
+        IRVarKind kind = fn->vars[v].kind;
+        named[v] = (kind == IRVAR_LOCAL || kind == IRVAR_PARAM) ? v : -1;
+    }
+
+    // Primero las copias, después cada versión con su variable original
+    for (int i = 0; i < dom->rpo_count; i++) {
+        IRBlock *block = &fn->blocks[dom->rpo[i]];
+        for (int j = 0; j < block->count; j++) {
+            IRInstr *instr = &block->instrs[j];
+            if (instr->op != IR_ASSIGN || !is_local_operand(fn, instr->src[0])) continue;
+            if (!is_local(fn, instr->dst.u.var)) continue;
+            try_coalesce(parent, named, matrix, words, instr->dst.u.var, instr->src[0].u.var);
+        }
+    }
+    for (int v = 0; v < vars; v++) {
+        int origin = fn->vars[v].origin;
+        if (origin != v && is_local(fn, v)) {
+            try_coalesce(parent, named, matrix, words, origin, v);
+        }
+    }
+
+    // Representante de cada clase: la variable con nombre, si no una
+    // variable original, si no la raíz
+    int *rep = (int*)malloc((vars + 1) * sizeof(int));
+    for (int v = 0; v < vars; v++) rep[v] = -1;
+    for (int v = 0; v < vars; v++) {
+        if (!is_local(fn, v)) continue;
+        int root = find_root(parent, v);
+        if (named[root] >= 0) {
+            rep[root] = named[root];
+        } else if (rep[root] < 0 || (fn->vars[v].origin == v && fn->vars[rep[root]].origin != rep[root])) {
+            rep[root] = v;
+        }
+    }
+
+    // Dos locales de ámbitos distintos pueden llamarse igual; si sus clases
+    // no se unieron, la segunda pasa a un temporal
+    for (int x = 0; x < vars; x++) {
+        if (parent[x] != x || named[x] < 0) continue;
+        for (int y = 0; y < x; y++) {
+            if (parent[y] == y && named[y] >= 0 && rep[y] >= 0 &&
+                fn->vars[rep[y]].name == fn->vars[rep[x]].name) {
+                rep[x] = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, fn->vars[rep[x]].type);
+                break;
+            }
+        }
+    }
+
+    for (int b = 0; b < n; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            for (int k = 0; k < ir_use_count(instr); k++) {
+                Operand *op = ir_use_at(instr, k);
+                if (is_local_operand(fn, *op)) op->u.var = rep[find_root(parent, op->u.var)];
+            }
+            if (instr->dst.kind == OPND_VAR && is_local(fn, instr->dst.u.var)) {
+                instr->dst.u.var = rep[find_root(parent, instr->dst.u.var)];
+            }
+            if (instr->op == IR_ASSIGN && instr->src[0].kind == OPND_VAR &&
+                instr->src[0].u.var == instr->dst.u.var) {
+                instr->op = IR_NOP;
+                ctx->stats->coalesced++;
+            }
+        }
+        if (block->term == TERM_BRANCH && is_local_operand(fn, block->cond)) {
+            block->cond.u.var = rep[find_root(parent, block->cond.u.var)];
+        }
+    }
+    ir_remove_nops(fn);
+
+    free(rep);
+    free(parent);
+    free(named);
+    free(matrix);
+    free(live);
+    free(live_in);
+    free(live_out);
+    free(use);
+    free(def);
+    cfg_free_dominators(dom);
+}
+
+// Declara al principio de la función cada variable propia que se usa y
+// numera los temporales que quedaron
+static void declare_variables(IRFunction *fn) {
+    ensure_entry_without_preds(fn);
+    ir_declare_locals(fn);
+}
+
+int ssa_optimize_function(IRFunction *fn, OptStats *stats) {
+    if (fn->var_count > OPT_MAX_VARS || fn->block_count > OPT_MAX_BLOCKS) return 0;
+
+    SSAContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.fn = fn;
+    ctx.stats = stats;
+
+    strip_declarations(fn);
+    cfg_remove_unreachable(fn);
+    ensure_entry_without_preds(fn);
+    cfg_split_critical_edges(fn);
+
+    ctx.dom = cfg_dominators(fn);
+    build_ssa(&ctx);
+    cfg_free_dominators(ctx.dom);
+    ctx.dom = NULL;
+
+    index_defs_and_uses(&ctx);
+    run_sccp(&ctx);
+    rewrite_idioms(fn, stats);
+    propagate_copies(&ctx);
+    if (range_fold_branches(fn, stats) > 0) {
+        cfg_remove_unreachable(fn);
+        prune_phis(fn);
+    }
+    licm_function(fn, stats);
+    strength_reduce_function(fn, stats);
+
+    index_defs_and_uses(&ctx);
+    eliminate_dead_code(&ctx);
+
+    eliminate_phis(&ctx);
+    coalesce_variables(&ctx);
+    cfg_simplify(fn);
+    declare_variables(fn);
+
+    free(ctx.current);
+    free(ctx.undo);
+    free(ctx.def_block);
+    free(ctx.def_index);
+    free(ctx.use_start);
+    free(ctx.use_block);
+    free(ctx.use_index);
+    return 1;
+}
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "cfg.h"
+
+// Reducción de fuerza sobre la forma SSA de ssa.c.
+//
+// FIS-25 no tiene desplazamientos ni operaciones de bits, así que DIV y MOD
+// entre potencias de dos no tienen una secuencia más barata; lo que sí se
+// reescribe es la multiplicación (3 ciclos contra 1 de ADD) y las
+// identidades con 0, 1 y -1. Dentro de los lazos, i * k con i variable de
+// inducción pasa a ser una variable de inducción propia que se incrementa
+// en el bloque del salto de regreso.
+
+static int is_local(IRFunction *fn, int var) {
+    IRVarKind kind = fn->vars[var].kind;
+    return kind != IRVAR_GLOBAL && kind != IRVAR_RETURN;
+}
+
+static int is_int(IRFunction *fn, Operand op) {
+    if (op.kind == OPND_INT) return 1;
+    if (op.kind != OPND_VAR) return 0;
+    DataType type = fn->vars[op.u.var].type;
+    return type == TYPE_INT || type == TYPE_BOOL;
+}
+
+static int is_constant(Operand op, int value) {
+    return op.kind == OPND_INT && op.u.int_value == value;
+}
+
+static void set_assign(IRInstr *instr, Operand value) {
+    instr->op = IR_ASSIGN;
+    instr->src[0] = value;
+    instr->src[1] = ir_none();
+}
+
+static void set_binary(IRInstr *instr, IROp op, Operand a, Operand b) {
+    instr->op = op;
+    instr->src[0] = a;
+    instr->src[1] = b;
+}
+
+// Reescribe una instrucción MUL/DIV/MOD con un operando constante
+static int rewrite_idiom(IRFunction *fn, IRInstr *instr) {
+    Operand a = instr->src[0], b = instr->src[1];
+    int ints = is_int(fn, a) && is_int(fn, b);
+
+    switch (instr->op) {
+        case IR_MUL:
+            if (b.kind == OPND_INT && a.kind != OPND_INT) {
+                Operand t = a; a = b; b = t;
+            }
+            // a es la constante, si la hay
+            if (is_constant(a, 1)) {
+                set_assign(instr, b);
+            } else if (is_constant(a, 2)) {
+                set_binary(instr, IR_ADD, b, b);
+            } else if (ints && is_constant(a, 0)) {
+                set_assign(instr, ir_int(0));
+            } else if (ints && is_constant(a, -1)) {
+                set_binary(instr, IR_SUB, ir_int(0), b);
+            } else {
+                return 0;
+            }
+            return 1;
+
+        case IR_DIV:
+            if (is_constant(b, 1)) {
+                set_assign(instr, a);
+            } else if (ints && is_constant(b, -1)) {
+                set_binary(instr, IR_SUB, ir_int(0), a);
+            } else {
+                return 0;
+            }
+            return 1;
+
+        case IR_MOD:
+            if (ints && (is_constant(b, 1) || is_constant(b, -1))) {
+                set_assign(instr, ir_int(0));
+                return 1;
+            }
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+int rewrite_idioms(IRFunction *fn, OptStats *stats) {
+    int rewritten = 0;
+
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            IRInstr *instr = &block->instrs[i];
+            int def = ir_instr_def(instr);
+            if (def >= 0 && is_local(fn, def) && rewrite_idiom(fn, instr)) rewritten++;
+        }
+    }
+
+    stats->idioms += rewritten;
+    return rewritten;
+}
+
+// Variable de inducción básica: i = phi(inicio, i + paso) en la cabecera
+typedef struct Induction {
+    int var;
+    Operand init;
+    int step;
+    int next;           // Variable con i + paso
+} Induction;
+
+// Multiplicación ya reducida dentro del lazo: var * factor = reduced
+typedef struct Reduced {
+    int var;
+    int factor;
+    int reduced;
+} Reduced;
+
+// Reconoce 'next = i + c', 'next = c + i' o 'next = i - c'
+static int find_step(IRFunction *fn, int *def_block, int *def_index, int next, int var, int *step) {
+    if (def_block[next] < 0) return 0;
+    IRInstr *update = &fn->blocks[def_block[next]].instrs[def_index[next]];
+    Operand a = update->src[0], b = update->src[1];
+
+    if (update->op == IR_ADD && a.kind == OPND_VAR && a.u.var == var && b.kind == OPND_INT) {
+        *step = b.u.int_value;
+    } else if (update->op == IR_ADD && b.kind == OPND_VAR && b.u.var == var && a.kind == OPND_INT) {
+        *step = a.u.int_value;
+    } else if (update->op == IR_SUB && a.kind == OPND_VAR && a.u.var == var && b.kind == OPND_INT) {
+        *step = (int)(0u - (unsigned)b.u.int_value);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int reduce_loop(IRFunction *fn, const DomInfo *dom, const LoopInfo *loops, int l,
+                       int *def_block, int *def_index, char *in_loop) {
+    int header = loops->header[l];
+    int preheader = loops->preheader[l];
+    IRBlock *head = &fn->blocks[header];
+    if (preheader < 0 || head->pred_count != 2) return 0;
+
+    int latch = head->preds[0] == preheader ? head->preds[1] : head->preds[0];
+    if (ir_successor_count(&fn->blocks[latch]) != 1) return 0;
+
+    for (int i = loops->block_start[l]; i < loops->block_start[l + 1]; i++) {
+        in_loop[loops->blocks[i]] = 1;
+    }
+
+    // Variables de inducción básicas
+    Induction *ivs = (Induction*)malloc((head->count + 1) * sizeof(Induction));
+    int iv_count = 0;
+    for (int i = 0; i < head->count; i++) {
+        IRInstr *phi = &head->instrs[i];
+        if (phi->op != IR_PHI || phi->arg_count != 2 || !is_int(fn, phi->dst)) continue;
+
+        Operand init = ir_none(), next = ir_none();
+        for (int j = 0; j < 2; j++) {
+            if (phi->arg_blocks[j] == preheader) init = phi->args[j];
+            else next = phi->args[j];
+        }
+        int step;
+        if (next.kind != OPND_VAR || def_block[next.u.var] < 0 || !in_loop[def_block[next.u.var]] ||
+            !find_step(fn, def_block, def_index, next.u.var, phi->dst.u.var, &step)) {
+            continue;
+        }
+        if (init.kind != OPND_INT && init.kind != OPND_VAR) continue;
+        ivs[iv_count].var = phi->dst.u.var;
+        ivs[iv_count].init = init;
+        ivs[iv_count].step = step;
+        ivs[iv_count].next = next.u.var;
+        iv_count++;
+    }
+
+    // Multiplicaciones i * k en bloques que se ejecutan en cada vuelta
+    Reduced *reduced = (Reduced*)malloc((fn->var_count + 1) * sizeof(Reduced));
+    int reduced_count = 0;
+    int count = 0;
+    int original_vars = fn->var_count;
+    int *replace = (int*)malloc((original_vars + 1) * sizeof(int));
+    for (int v = 0; v < original_vars; v++) replace[v] = -1;
+
+    for (int i = loops->block_start[l]; i < loops->block_start[l + 1] && iv_count > 0; i++) {
+        int b = loops->blocks[i];
+        if (!cfg_dominates(dom, b, latch)) continue;
+
+        for (int j = 0; j < fn->blocks[b].count; j++) {
+            IRInstr *instr = &fn->blocks[b].instrs[j];
+            int def = ir_instr_def(instr);
+            if (instr->op != IR_MUL || def < 0 || !is_local(fn, def) || !is_int(fn, instr->dst)) continue;
+
+            Operand a = instr->src[0], c = instr->src[1];
+            if (a.kind == OPND_INT) {
+                Operand t = a; a = c; c = t;
+            }
+            if (a.kind != OPND_VAR || c.kind != OPND_INT) continue;
+
+            int iv = -1;
+            for (int k = 0; k < iv_count; k++) {
+                if (ivs[k].var == a.u.var) iv = k;
+            }
+            if (iv < 0) continue;
+
+            int found = -1;
+            for (int k = 0; k < reduced_count; k++) {
+                if (reduced[k].var == a.u.var && reduced[k].factor == c.u.int_value) found = k;
+            }
+
+            if (found < 0) {
+                int factor = c.u.int_value;
+                int s = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_INT);
+                int s_next = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_INT);
+
+                Operand start;
+                if (ivs[iv].init.kind == OPND_INT) {
+                    ir_fold_binary(IR_MUL, ivs[iv].init.u.int_value, factor, &start.u.int_value);
+                    start.kind = OPND_INT;
+                } else {
+                    start = ir_var(ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_INT));
+                    IRInstr *init = ir_append(fn, preheader, IR_MUL);
+                    init->dst = start;
+                    init->src[0] = ivs[iv].init;
+                    init->src[1] = ir_int(factor);
+                }
+
+                // El incremento va junto al de i si este se ejecuta en cada
+                // vuelta; si no, al final del bloque del salto de regreso
+                int increment;
+                ir_fold_binary(IR_MUL, ivs[iv].step, factor, &increment);
+                int update_block = def_block[ivs[iv].next];
+                IRInstr *update;
+                if (cfg_dominates(dom, update_block, latch)) {
+                    int position = 0;
+                    while (ir_instr_def(&fn->blocks[update_block].instrs[position]) != ivs[iv].next) position++;
+                    update = ir_insert(fn, update_block, position + 1, IR_ADD);
+                    if (update_block == b && position < j) j++;
+                } else {
+                    update = ir_append(fn, latch, IR_ADD);
+                }
+                update->dst = ir_var(s_next);
+                update->src[0] = ir_var(s);
+                update->src[1] = ir_int(increment);
+
+                IRInstr *phi = ir_insert(fn, header, 0, IR_PHI);
+                phi->dst = ir_var(s);
+                phi->arg_count = 2;
+                phi->args = (Operand*)malloc(2 * sizeof(Operand));
+                phi->arg_blocks = (int*)malloc(2 * sizeof(int));
+                phi->args[0] = start;
+                phi->arg_blocks[0] = preheader;
+                phi->args[1] = ir_var(s_next);
+                phi->arg_blocks[1] = latch;
+
+                // Las inserciones movieron las instrucciones del bloque
+                if (b == header) j++;
+                instr = &fn->blocks[b].instrs[j];
+
+                reduced[reduced_count].var = a.u.var;
+                reduced[reduced_count].factor = factor;
+                reduced[reduced_count].reduced = s;
+                found = reduced_count++;
+            }
+
+            replace[def] = reduced[found].reduced;
+            instr->op = IR_NOP;
+            count++;
+        }
+    }
+
+    if (count > 0) {
+        // Los usos fuera del lazo verían el valor de otra vuelta: en ese
+        // caso se conserva una copia en lugar de la multiplicación
+        int *outside = (int*)calloc(original_vars + 1, sizeof(int));
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i < block->count; i++) {
+                IRInstr *instr = &block->instrs[i];
+                for (int k = 0; k < ir_use_count(instr); k++) {
+                    Operand *op = ir_use_at(instr, k);
+                    if (op->kind != OPND_VAR || op->u.var >= original_vars || replace[op->u.var] < 0) continue;
+                    if (in_loop[b]) {
+                        op->u.var = replace[op->u.var];
+                    } else {
+                        outside[op->u.var] = 1;
+                    }
+                }
+            }
+            if (block->term == TERM_BRANCH && block->cond.kind == OPND_VAR &&
+                block->cond.u.var < original_vars && replace[block->cond.u.var] >= 0) {
+                if (in_loop[b]) {
+                    block->cond.u.var = replace[block->cond.u.var];
+                } else {
+                    outside[block->cond.u.var] = 1;
+                }
+            }
+        }
+
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i < block->count; i++) {
+                IRInstr *instr = &block->instrs[i];
+                if (instr->op == IR_NOP && instr->dst.kind == OPND_VAR &&
+                    instr->dst.u.var < original_vars && outside[instr->dst.u.var]) {
+                    set_assign(instr, ir_var(replace[instr->dst.u.var]));
+                    outside[instr->dst.u.var] = 0;
+                }
+            }
+        }
+        free(outside);
+    }
+
+    for (int i = loops->block_start[l]; i < loops->block_start[l + 1]; i++) {
+        in_loop[loops->blocks[i]] = 0;
+    }
+    free(ivs);
+    free(reduced);
+    free(replace);
+    return count;
+}
+
+int strength_reduce_function(IRFunction *fn, OptStats *stats) {
+    DomInfo *dom = cfg_dominators(fn);
+    LoopInfo *loops = cfg_find_loops(fn, dom);
+    char *in_loop = (char*)calloc(fn->block_count + 1, 1);
+    int reduced = 0;
+
+    for (int l = 0; l < loops->loop_count; l++) {
+        int *def_block = (int*)malloc((fn->var_count + 1) * sizeof(int));
+        int *def_index = (int*)malloc((fn->var_count + 1) * sizeof(int));
+        for (int v = 0; v < fn->var_count; v++) def_block[v] = def_index[v] = -1;
+        for (int b = 0; b < fn->block_count; b++) {
+            IRBlock *block = &fn->blocks[b];
+            for (int i = 0; i < block->count; i++) {
+                int def = ir_instr_def(&block->instrs[i]);
+                if (def >= 0) {
+                    def_block[def] = b;
+                    def_index[def] = i;
+                }
+            }
+        }
+
+        reduced += reduce_loop(fn, dom, loops, l, def_block, def_index, in_loop);
+        free(def_block);
+        free(def_index);
+    }
+
+    ir_remove_nops(fn);
+    stats->strength_reduced += reduced;
+
+    free(in_loop);
+    cfg_free_loops(loops);
+    cfg_free_dominators(dom);
+    return reduced;
+}
@@ -2,13 +2,53 @@
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "diag.h"
+#include "intern.h"
 
-static unsigned int hash(char *str) {
-    unsigned int hash = 5381;
-    int c;
-    while ((c = *str++))
-        hash = ((hash << 5) + hash) + c;
-    return hash % MAX_SYMBOLS;
+#define SYMTABLE_INITIAL_CAPACITY 64
+#define SYMTABLE_INITIAL_ENTRIES 64
+#define SYMTABLE_INITIAL_SCOPES 8
+
+static void* xrealloc(void *ptr, size_t size) {
+    void *result = realloc(ptr, size);
+    if (!result) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para la tabla de símbolos\n");
+        exit(1);
+    }
+    return result;
+}
+
+static void grow_slots(SymbolTable *table) {
+    size_t new_capacity = table->capacity * 2;
+    SymbolSlot *new_slots = (SymbolSlot*)xrealloc(NULL, new_capacity * sizeof(SymbolSlot));
+    memset(new_slots, 0, new_capacity * sizeof(SymbolSlot));
+
+    // Los nombres sin símbolo visible se descartan al rehacer la tabla
+    size_t used = 0;
+    for (size_t i = 0; i < table->capacity; i++) {
+        SymbolSlot *slot = &table->slots[i];
+        if (!slot->name || !slot->symbol) continue;
+        size_t index = atom_hash(slot->name) & (new_capacity - 1);
+        while (new_slots[index].name) {
+            index = (index + 1) & (new_capacity - 1);
+        }
+        new_slots[index] = *slot;
+        used++;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    table->slots_used = used;
+}
+
+// Devuelve la entrada del átomo, o la entrada vacía donde debería insertarse
+static SymbolSlot* find_slot(SymbolTable *table, const char *name) {
+    size_t index = atom_hash(name) & (table->capacity - 1);
+    while (table->slots[index].name && table->slots[index].name != name) {
+        index = (index + 1) & (table->capacity - 1);
+    }
+    return &table->slots[index];
 }
 
 SymbolTable* create_symbol_table() {
@@ -18,114 +58,167 @@ SymbolTable* create_symbol_table() {
         exit(1);
     }
     
-    for (int i = 0; i < MAX_SYMBOLS; i++) {
-        table->symbols[i] = NULL;
-    }
+    table->capacity = SYMTABLE_INITIAL_CAPACITY;
+    table->slots = (SymbolSlot*)xrealloc(NULL, table->capacity * sizeof(SymbolSlot));
+    memset(table->slots, 0, table->capacity * sizeof(SymbolSlot));
+    table->slots_used = 0;
+
+    table->entry_capacity = SYMTABLE_INITIAL_ENTRIES;
+    table->entries = (Symbol**)xrealloc(NULL, table->entry_capacity * sizeof(Symbol*));
+    table->entry_count = 0;
+
+    table->scope_capacity = SYMTABLE_INITIAL_SCOPES;
+    table->scope_starts = (size_t*)xrealloc(NULL, table->scope_capacity * sizeof(size_t));
+    table->scope_starts[0] = 0;
     table->scope_level = 0;
-    table->parent = NULL;
+
+    arena_init(&table->arena);
     
     return table;
 }
 
-SymbolTable* enter_scope(SymbolTable *current) {
-    SymbolTable *new_table = create_symbol_table();
-    new_table->scope_level = current->scope_level + 1;
-    new_table->parent = current;
-    return new_table;
+void enter_scope(SymbolTable *table) {
+    table->scope_level++;
+    if ((size_t)table->scope_level >= table->scope_capacity) {
+        table->scope_capacity *= 2;
+        table->scope_starts = (size_t*)xrealloc(table->scope_starts,
+                                                table->scope_capacity * sizeof(size_t));
+    }
+    table->scope_starts[table->scope_level] = table->entry_count;
 }
 
-SymbolTable* exit_scope(SymbolTable *current) {
-    SymbolTable *parent = current->parent;
-    // No liberamos la tabla aquí para mantener los símbolos durante la generación de código
-    return parent;
+void exit_scope(SymbolTable *table) {
+    // Los símbolos siguen en el arena para la generación de código; solo dejan de ser visibles
+    size_t start = table->scope_starts[table->scope_level];
+    while (table->entry_count > start) {
+        Symbol *symbol = table->entries[--table->entry_count];
+        find_slot(table, symbol->name)->symbol = symbol->shadowed;
+    }
+    table->scope_level--;
 }
 
-Symbol* add_symbol(SymbolTable *table, char *name, DataType type) {
-    unsigned int index = hash(name);
-    
+Symbol* add_symbol(SymbolTable *table, const char *name, DataType type) {
     // Verificar si ya existe en el scope actual
     Symbol *existing = lookup_symbol_current_scope(table, name);
     if (existing) {
-        fprintf(stderr, "Error semántico: Variable '%s' ya declarada en este ámbito\n", name);
-        exit(1);
+        compile_error("Error semántico: Variable '%s' ya declarada en este ámbito\n", name);
+    }
+
+    if ((table->slots_used + 1) * 2 > table->capacity) {
+        grow_slots(table);
+    }
+    SymbolSlot *slot = find_slot(table, name);
+    if (!slot->name) {
+        slot->name = name;
+        table->slots_used++;
     }
     
-    Symbol *symbol = (Symbol*)malloc(sizeof(Symbol));
-    symbol->name = strdup(name);
+    Symbol *symbol = (Symbol*)arena_alloc(&table->arena, sizeof(Symbol));
+    symbol->name = name;
     symbol->type = type;
     symbol->is_array = 0;
+    symbol->array_size = 0;
+    symbol->elements = NULL;
     symbol->is_function = 0;
+    symbol->return_type = TYPE_VOID;
     symbol->address = 0;
-    symbol->next = table->symbols[index];
-    table->symbols[index] = symbol;
+    symbol->scope_level = table->scope_level;
+    symbol->shadowed = slot->symbol;
+    slot->symbol = symbol;
+
+    if (table->entry_count == table->entry_capacity) {
+        table->entry_capacity *= 2;
+        table->entries = (Symbol**)xrealloc(table->entries,
+                                            table->entry_capacity * sizeof(Symbol*));
+    }
+    table->entries[table->entry_count++] = symbol;
     
     return symbol;
 }
 
-Symbol* add_array_symbol(SymbolTable *table, char *name, DataType element_type, int size) {
+Symbol* add_array_symbol(SymbolTable *table, const char *name, DataType element_type, int size) {
     Symbol *symbol = add_symbol(table, name, element_type);
     symbol->is_array = 1;
     symbol->array_size = size;
+
+    // FIS-25 no tiene memoria indexada: cada elemento es una variable propia,
+    // fuera de la tabla, llamada a[0], a[1]... El lexer no acepta corchetes
+    // en un identificador, así que ninguna variable del programa se llama
+    // igual que un elemento.
+    if (size <= 0) return symbol;
+    symbol->elements = (Symbol*)arena_alloc(&table->arena, size * sizeof(Symbol));
+
+    // El nombre del último elemento es el más largo
+    size_t capacity = (size_t)snprintf(NULL, 0, "%s[%d]", name, size - 1) + 1;
+    char *element_name = (char*)xrealloc(NULL, capacity);
+    for (int i = 0; i < size; i++) {
+        snprintf(element_name, capacity, "%s[%d]", name, i);
+        Symbol *element = &symbol->elements[i];
+        *element = *symbol;
+        element->name = intern(element_name);
+        element->is_array = 0;
+        element->array_size = 0;
+        element->elements = NULL;
+        element->shadowed = NULL;
+    }
+    free(element_name);
     return symbol;
 }
 
-Symbol* add_function_symbol(SymbolTable *table, char *name, DataType return_type) {
+Symbol* add_function_symbol(SymbolTable *table, const char *name, DataType return_type) {
     Symbol *symbol = add_symbol(table, name, return_type);
     symbol->is_function = 1;
     symbol->return_type = return_type;
     return symbol;
 }
 
-Symbol* lookup_symbol_current_scope(SymbolTable *table, char *name) {
-    unsigned int index = hash(name);
-    Symbol *symbol = table->symbols[index];
-    
-    while (symbol) {
-        if (strcmp(symbol->name, name) == 0) {
-            return symbol;
-        }
-        symbol = symbol->next;
+Symbol* lookup_symbol_current_scope(SymbolTable *table, const char *name) {
+    Symbol *symbol = lookup_symbol(table, name);
+    if (symbol && symbol->scope_level == table->scope_level) {
+        return symbol;
     }
-    
     return NULL;
 }
 
-Symbol* lookup_symbol(SymbolTable *table, char *name) {
-    SymbolTable *current = table;
-    
-    while (current) {
-        Symbol *symbol = lookup_symbol_current_scope(current, name);
-        if (symbol) {
-            return symbol;
-        }
-        current = current->parent;
-    }
-    
-    return NULL;
+Symbol* lookup_symbol(SymbolTable *table, const char *name) {
+    return find_slot(table, name)->symbol;
 }
 
 void free_symbol_table(SymbolTable *table) {
     if (!table) return;
     
-    for (int i = 0; i < MAX_SYMBOLS; i++) {
-        Symbol *symbol = table->symbols[i];
-        while (symbol) {
-            Symbol *next = symbol->next;
-            free(symbol->name);
-            free(symbol);
-            symbol = next;
-        }
-    }
-    
+    free(table->slots);
+    free(table->entries);
+    free(table->scope_starts);
+    arena_release(&table->arena);
     free(table);
 }
 
 // Análisis semántico
 static void analyze_statement(ASTNode *node, SymbolTable *table);
+static DataType compute_expression_type(ASTNode *expr, SymbolTable *table);
 
+// Resuelve los nombres de la expresión y guarda su tipo en el nodo
 DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
     if (!expr) return TYPE_VOID;
-    
+
+    DataType type = compute_expression_type(expr, table);
+    expr->data_type = type;
+    return type;
+}
+
+static Symbol* resolve_variable(SymbolTable *table, const char *name) {
+    Symbol *sym = lookup_symbol(table, name);
+    if (!sym) {
+        compile_error("Error semántico: Variable '%s' no declarada\n", name);
+    }
+    if (sym->is_array) {
+        compile_error("Error semántico: '%s' es un array; se usa con un índice\n", name);
+    }
+    return sym;
+}
+
+static DataType compute_expression_type(ASTNode *expr, SymbolTable *table) {    
     switch (expr->type) {
         case NODE_INT_LITERAL:
             return TYPE_INT;
@@ -137,31 +230,25 @@ DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
             return TYPE_STRING;
             
         case NODE_IDENTIFIER: {
-            Symbol *sym = lookup_symbol(table, expr->data.identifier);
-            if (!sym) {
-                fprintf(stderr, "Error semántico: Variable '%s' no declarada\n", 
-                        expr->data.identifier);
-                exit(1);
-            }
+            Symbol *sym = resolve_variable(table, expr->data.identifier.name);
+            expr->data.identifier.symbol = sym;
             return sym->type;
         }
         
         case NODE_ARRAY_ACCESS: {
             Symbol *sym = lookup_symbol(table, expr->data.array_access.array_name);
             if (!sym) {
-                fprintf(stderr, "Error semántico: Array '%s' no declarado\n", 
-                        expr->data.array_access.array_name);
-                exit(1);
+                compile_error("Error semántico: Array '%s' no declarado\n",
+                              expr->data.array_access.array_name);
             }
             if (!sym->is_array) {
-                fprintf(stderr, "Error semántico: '%s' no es un array\n", 
-                        expr->data.array_access.array_name);
-                exit(1);
+                compile_error("Error semántico: '%s' no es un array\n",
+                              expr->data.array_access.array_name);
             }
+            expr->data.array_access.symbol = sym;
             DataType index_type = check_expression_type(expr->data.array_access.index, table);
             if (index_type != TYPE_INT) {
-                fprintf(stderr, "Error semántico: Índice de array debe ser entero\n");
-                exit(1);
+                compile_error("Error semántico: Índice de array debe ser entero\n");
             }
             return sym->type;
         }
@@ -178,8 +265,7 @@ DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
                 case OP_MOD:
                     if (!((left_type == TYPE_INT || left_type == TYPE_FLOAT) &&
                           (right_type == TYPE_INT || right_type == TYPE_FLOAT))) {
-                        fprintf(stderr, "Error semántico: Operaciones aritméticas solo permitidas entre int y float\n");
-                        exit(1);
+                        compile_error("Error semántico: Operaciones aritméticas solo permitidas entre int y float\n");
                     }
                     return (left_type == TYPE_FLOAT || right_type == TYPE_FLOAT) ? 
                            TYPE_FLOAT : TYPE_INT;
@@ -188,8 +274,7 @@ DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
                     if (left_type != right_type &&
                         !((left_type == TYPE_INT && right_type == TYPE_FLOAT) ||
                           (left_type == TYPE_FLOAT && right_type == TYPE_INT))) {
-                        fprintf(stderr, "Error semántico: Comparación de igualdad entre tipos incompatibles\n");
-                        exit(1);
+                        compile_error("Error semántico: Comparación de igualdad entre tipos incompatibles\n");
                     }
                     return TYPE_BOOL;
                 case OP_LT:
@@ -198,15 +283,13 @@ DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
                 case OP_GE:
                     if (!((left_type == TYPE_INT || left_type == TYPE_FLOAT) &&
                           (right_type == TYPE_INT || right_type == TYPE_FLOAT))) {
-                        fprintf(stderr, "Error semántico: Comparaciones relacionales solo permitidas entre int y float\n");
-                        exit(1);
+                        compile_error("Error semántico: Comparaciones relacionales solo permitidas entre int y float\n");
                     }
                     return TYPE_BOOL;
                 case OP_AND:
                 case OP_OR:
                     if (left_type != TYPE_BOOL || right_type != TYPE_BOOL) {
-                        fprintf(stderr, "Error semántico: Operadores lógicos requieren operandos booleanos\n");
-                        exit(1);
+                        compile_error("Error semántico: Operadores lógicos requieren operandos booleanos\n");
                     }
                     return TYPE_BOOL;
                 default:
@@ -217,15 +300,37 @@ DataType check_expression_type(ASTNode *expr, SymbolTable *table) {
         case NODE_UNOP:
             return check_expression_type(expr->data.unop.operand, table);
         
-        case NODE_LENGTH:
+        case NODE_LENGTH: {
+            // a.length o a[i].length: el tamaño se conoce en compilación
+            ASTNode *array = expr->data.length.array;
+            if (array->type == NODE_ARRAY_ACCESS) {
+                check_expression_type(array, table);
+                return TYPE_INT;
+            }
+            Symbol *sym = lookup_symbol(table, array->data.identifier.name);
+            if (!sym || !sym->is_array) {
+                compile_error("Error semántico: '%s' no es un array\n", array->data.identifier.name);
+            }
+            array->data.identifier.symbol = sym;
             return TYPE_INT;
+        }
             
         case NODE_FUNCTION_CALL: {
             Symbol *sym = lookup_symbol(table, expr->data.function_call.func_name);
             if (!sym) {
-                fprintf(stderr, "Error semántico: Función '%s' no declarada\n", 
-                        expr->data.function_call.func_name);
-                exit(1);
+                compile_error("Error semántico: Función '%s' no declarada\n",
+                              expr->data.function_call.func_name);
+            }
+            if (!sym->is_function) {
+                compile_error("Error semántico: '%s' no es una función\n",
+                              expr->data.function_call.func_name);
+            }
+            expr->data.function_call.symbol = sym;
+
+            ASTNode *arg = expr->data.function_call.arguments;
+            while (arg) {
+                check_expression_type(arg->data.argument.expression, table);
+                arg = arg->data.argument.next;
             }
             return sym->return_type;
         }
@@ -245,7 +350,7 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
             break;
             
         case NODE_DECLARATION: {
-            add_symbol(table, 
+            node->data.declaration.symbol = add_symbol(table, 
                       node->data.declaration.var_name, 
                       node->data.declaration.var_type);
             if (node->data.declaration.init_value) {
@@ -253,8 +358,7 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
                     node->data.declaration.init_value, table);
                 if (init_type != node->data.declaration.var_type && 
                     !(init_type == TYPE_INT && node->data.declaration.var_type == TYPE_FLOAT)) {
-                    fprintf(stderr, "Error semántico: Tipo incompatible en inicialización\n");
-                    exit(1);
+                    compile_error("Error semántico: Tipo incompatible en inicialización\n");
                 }
             }
             break;
@@ -264,10 +368,15 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
             int size = 0;
             ASTNode *elem = node->data.array_decl.elements;
             while (elem) {
+                DataType elem_type = check_expression_type(elem->data.argument.expression, table);
+                DataType array_type = node->data.array_decl.element_type;
+                if (elem_type != array_type && !(elem_type == TYPE_INT && array_type == TYPE_FLOAT)) {
+                    compile_error("Error semántico: Tipo incompatible en inicialización\n");
+                }
                 size++;
                 elem = elem->data.argument.next;
             }
-            add_array_symbol(table, 
+            node->data.array_decl.symbol = add_array_symbol(table, 
                            node->data.array_decl.array_name, 
                            node->data.array_decl.element_type,
                            size);
@@ -275,25 +384,29 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
         }
         
         case NODE_ASSIGNMENT: {
-            Symbol *sym = lookup_symbol(table, node->data.assignment.var_name);
-            if (!sym) {
-                fprintf(stderr, "Error semántico: Variable '%s' no declarada\n", 
-                        node->data.assignment.var_name);
-                exit(1);
-            }
+            Symbol *sym = resolve_variable(table, node->data.assignment.var_name);
+            node->data.assignment.symbol = sym;
             DataType value_type = check_expression_type(node->data.assignment.value, table);
             if (value_type != sym->type && 
                 !(value_type == TYPE_INT && sym->type == TYPE_FLOAT)) {
-                fprintf(stderr, "Error semántico: Tipo incompatible en asignación\n");
-                exit(1);
+                compile_error("Error semántico: Tipo incompatible en asignación\n");
+            }
+            break;
+        }
+        
+        case NODE_ARRAY_ASSIGNMENT: {
+            DataType elem_type = check_expression_type(node->data.array_assign.array_access, table);
+            DataType value_type = check_expression_type(node->data.array_assign.value, table);
+            if (value_type != elem_type && 
+                !(value_type == TYPE_INT && elem_type == TYPE_FLOAT)) {
+                compile_error("Error semántico: Tipo incompatible en asignación\n");
             }
             break;
         }
         
         case NODE_IF:
             if (check_expression_type(node->data.if_stmt.condition, table) != TYPE_BOOL) {
-                fprintf(stderr, "Error semántico: La condición del if debe ser de tipo bool\n");
-                exit(1);
+                compile_error("Error semántico: La condición del if debe ser de tipo bool\n");
             }
             analyze_statement(node->data.if_stmt.then_branch, table);
             analyze_statement(node->data.if_stmt.else_branch, table);
@@ -301,8 +414,7 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
             
         case NODE_WHILE:
             if (check_expression_type(node->data.while_stmt.condition, table) != TYPE_BOOL) {
-                fprintf(stderr, "Error semántico: La condición del while debe ser de tipo bool\n");
-                exit(1);
+                compile_error("Error semántico: La condición del while debe ser de tipo bool\n");
             }
             analyze_statement(node->data.while_stmt.body, table);
             break;
@@ -310,29 +422,29 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
         case NODE_FOR:
             analyze_statement(node->data.for_stmt.init, table);
             if (check_expression_type(node->data.for_stmt.condition, table) != TYPE_BOOL) {
-                fprintf(stderr, "Error semántico: La condición del for debe ser de tipo bool\n");
-                exit(1);
+                compile_error("Error semántico: La condición del for debe ser de tipo bool\n");
             }
             analyze_statement(node->data.for_stmt.increment, table);
             analyze_statement(node->data.for_stmt.body, table);
             break;
             
         case NODE_FUNCTION_DEF: {
-            add_function_symbol(table, 
+            node->data.function_def.symbol = add_function_symbol(table, 
                               node->data.function_def.func_name,
                               node->data.function_def.return_type);
-            SymbolTable *func_scope = enter_scope(table);
+            enter_scope(table);
             
             // Añadir parámetros al scope de la función
             ASTNode *param = node->data.function_def.parameters;
             while (param) {
-                add_symbol(func_scope, 
+                param->data.parameter.symbol = add_symbol(table, 
                           param->data.parameter.param_name,
                           param->data.parameter.param_type);
                 param = param->data.parameter.next;
             }
             
-            analyze_statement(node->data.function_def.body, func_scope);
+            analyze_statement(node->data.function_def.body, table);
+            exit_scope(table);
             break;
         }
         
@@ -342,10 +454,23 @@ static void analyze_statement(ASTNode *node, SymbolTable *table) {
             check_expression_type(node->data.pixel.color, table);
             break;
             
+        case NODE_KEY:
+            check_expression_type(node->data.key.key_code, table);
+            node->data.key.dest_symbol = resolve_variable(table, node->data.key.dest_var);
+            break;
+            
+        case NODE_INPUT:
+            node->data.input.symbol = resolve_variable(table, node->data.input.input_var);
+            break;
+            
         case NODE_PRINT:
             check_expression_type(node->data.print.expression, table);
             break;
             
+        case NODE_FUNCTION_CALL:
+            check_expression_type(node, table);
+            break;
+            
         case NODE_RETURN:
             check_expression_type(node->data.return_stmt.return_value, table);
             break;
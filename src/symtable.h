@@ -3,36 +3,61 @@
 
 #include "ast.h"
 
-#define MAX_SYMBOLS 1000
+#include <stddef.h>
+#include "arena.h"
 
 typedef struct Symbol {
-    char *name;
+    const char *name;   // Átomo (intern.h)
     DataType type;
     int is_array;
     int array_size;
+    struct Symbol *elements;  // Arrays: un símbolo por elemento, <array>[<i>]
     int is_function;
     DataType return_type;
     int address;  // Para generación de código
-    struct Symbol *next;
+    int scope_level;
+    struct Symbol *shadowed;  // Símbolo del mismo nombre en un ámbito exterior
 } Symbol;
 
+// Entrada de la tabla hash: átomo -> símbolo visible más interno
+typedef struct SymbolSlot {
+    const char *name;
+    Symbol *symbol;
+} SymbolSlot;
+
+// Tabla única para todos los ámbitos. Los símbolos visibles se apilan en
+// orden de inserción ('entries'); cada ámbito recuerda dónde empieza en la
+// pila, así que salir de él cuesta O(símbolos del ámbito). Al terminar el
+// análisis solo quedan los globales, en el orden en que se declararon.
+// Los símbolos viven en el arena de la tabla hasta free_symbol_table.
 typedef struct SymbolTable {
-    Symbol *symbols[MAX_SYMBOLS];
+    SymbolSlot *slots;
+    size_t capacity;
+    size_t slots_used;
+
+    Symbol **entries;
+    size_t entry_count;
+    size_t entry_capacity;
+
+    size_t *scope_starts;
+    size_t scope_capacity;
     int scope_level;
-    struct SymbolTable *parent;
+
+    Arena arena;
 } SymbolTable;
 
 // Funciones de la tabla de símbolos
+// Los nombres deben ser átomos de intern.h: la búsqueda compara punteros.
 SymbolTable* create_symbol_table();
-SymbolTable* enter_scope(SymbolTable *current);
-SymbolTable* exit_scope(SymbolTable *current);
+void enter_scope(SymbolTable *table);
+void exit_scope(SymbolTable *table);
 
-Symbol* add_symbol(SymbolTable *table, char *name, DataType type);
-Symbol* add_array_symbol(SymbolTable *table, char *name, DataType element_type, int size);
-Symbol* add_function_symbol(SymbolTable *table, char *name, DataType return_type);
+Symbol* add_symbol(SymbolTable *table, const char *name, DataType type);
+Symbol* add_array_symbol(SymbolTable *table, const char *name, DataType element_type, int size);
+Symbol* add_function_symbol(SymbolTable *table, const char *name, DataType return_type);
 
-Symbol* lookup_symbol(SymbolTable *table, char *name);
-Symbol* lookup_symbol_current_scope(SymbolTable *table, char *name);
+Symbol* lookup_symbol(SymbolTable *table, const char *name);
+Symbol* lookup_symbol_current_scope(SymbolTable *table, const char *name);
 
 void free_symbol_table(SymbolTable *table);
 
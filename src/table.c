@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opt.h"
+#include "diag.h"
+
+// Tablas de resultados para funciones int sin efectos sobre un dominio
+// pequeño de argumentos enteros, pedidas con --table. FIS-25 no tiene
+// memoria indexada: la tabla se escribe al principio de la propia función
+// como una búsqueda binaria sobre el índice de los argumentos, con un
+// RETURN por cada tramo de resultados iguales. Si algún argumento queda
+// fuera del dominio se ejecuta el cuerpo original.
+
+typedef struct TableBuilder {
+    IRFunction *fn;
+    int ret;                // ret_<función>
+    int index;              // Temporal con el índice de los argumentos
+    int cond;               // Temporal de las comparaciones
+    const int *starts;      // Primer índice de cada tramo
+    const int *values;      // Resultado de cada tramo
+    int *order;             // Bloques nuevos en orden de salida
+    int order_count;
+} TableBuilder;
+
+static int new_block(TableBuilder *tb) {
+    int block = ir_new_block(tb->fn);
+    tb->order[tb->order_count++] = block;
+    return block;
+}
+
+static void emit_binary(IRFunction *fn, int block, IROp op, Operand a, Operand b, int dst) {
+    IRInstr *instr = ir_append(fn, block, op);
+    instr->src[0] = a;
+    instr->src[1] = b;
+    instr->dst = ir_var(dst);
+}
+
+// Búsqueda binaria sobre los tramos [low, high]; devuelve su primer bloque
+static int build_search(TableBuilder *tb, int low, int high) {
+    int block = new_block(tb);
+    if (low == high) {
+        IRInstr *instr = ir_append(tb->fn, block, IR_ASSIGN);
+        instr->src[0] = ir_int(tb->values[low]);
+        instr->dst = ir_var(tb->ret);
+        ir_set_return(tb->fn, block);
+        return block;
+    }
+
+    int mid = (low + high + 1) / 2;
+    emit_binary(tb->fn, block, IR_LT, ir_var(tb->index), ir_int(tb->starts[mid]), tb->cond);
+    int below = build_search(tb, low, mid - 1);
+    int above = build_search(tb, mid, high);
+    ir_set_branch(tb->fn, block, ir_var(tb->cond), below, above);
+    return block;
+}
+
+static void table_error(const TableSpec *spec, const char *reason) {
+    compile_error("Error: No se puede tabular %s: %s\n", spec->name, reason);
+}
+
+void tabulate_function(IRProgram *program, const TableSpec *spec, OptStats *stats) {
+    int f = 0;
+    while (f < program->function_count &&
+           (!program->functions[f]->name || strcmp(program->functions[f]->name, spec->name) != 0)) {
+        f++;
+    }
+    if (f == program->function_count) table_error(spec, "la función no existe");
+    IRFunction *fn = program->functions[f];
+    if (fn->return_type != TYPE_INT && fn->return_type != TYPE_BOOL) {
+        table_error(spec, "solo se tabulan funciones que devuelven int o bool");
+    }
+
+    // El j-ésimo PARAM_GET saca el parámetro count-1-j
+    IRBlock *entry = &fn->blocks[fn->entry];
+    int params[TABLE_MAX_PARAMS];
+    int count = 0, last = -1;
+    for (int i = 0; i < entry->count; i++) {
+        if (entry->instrs[i].op != IR_PARAM_GET) continue;
+        if (count == spec->param_count) table_error(spec, "el dominio no tiene un rango por parámetro");
+        params[count++] = entry->instrs[i].dst.u.var;
+        last = i;
+    }
+    if (count != spec->param_count) table_error(spec, "el dominio no tiene un rango por parámetro");
+
+    // Resultados en orden de índice: el primer parámetro es el más significativo
+    int entries = 1;
+    for (int p = 0; p < count; p++) entries *= spec->high[p] - spec->low[p] + 1;
+    int *starts = (int*)malloc((entries + 1) * sizeof(int));
+    int *values = (int*)malloc((entries + 1) * sizeof(int));
+    signed char *evaluable = (signed char*)malloc(program->function_count + 1);
+    memset(evaluable, -1, program->function_count + 1);
+    Operand args[TABLE_MAX_PARAMS];
+    const char *failure = NULL;
+    int runs = 0;
+    for (int index = 0; index < entries && !failure; index++) {
+        int rest = index;
+        for (int p = count - 1; p >= 0; p--) {
+            int width = spec->high[p] - spec->low[p] + 1;
+            args[p] = ir_int(spec->low[p] + rest % width);
+            rest /= width;
+        }
+        Operand result;
+        if (!consteval_function(program, f, args, count, evaluable, &result)) {
+            failure = "no se pudo evaluar en compilación en todo el dominio";
+        } else if (result.kind != OPND_INT) {
+            failure = "algún resultado no es entero";
+        } else if (runs == 0 || values[runs - 1] != result.u.int_value) {
+            starts[runs] = index;
+            values[runs++] = result.u.int_value;
+        }
+    }
+    free(evaluable);
+    if (failure) {
+        // En el modo por lotes el error no termina el proceso
+        free(starts);
+        free(values);
+        table_error(spec, failure);
+    }
+
+    TableBuilder tb;
+    tb.fn = fn;
+    tb.ret = -1;
+    for (int v = 0; v < fn->var_count; v++) {
+        if (fn->vars[v].kind == IRVAR_RETURN && fn->vars[v].symbol == fn->symbol) tb.ret = v;
+    }
+    if (tb.ret < 0) tb.ret = ir_add_var(fn, IRVAR_RETURN, fn->name, fn->symbol, fn->return_type);
+    tb.index = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_INT);
+    tb.cond = ir_add_var(fn, IRVAR_TEMP, NULL, NULL, TYPE_BOOL);
+    tb.starts = starts;
+    tb.values = values;
+    tb.order = (int*)malloc((4 * count + 2 * runs + 2) * sizeof(int));
+    tb.order_count = 0;
+    int first_block = fn->block_count;
+
+    // Lo que seguía a los PARAM_GET pasa a un bloque nuevo: el cuerpo original
+    int body = ir_new_block(fn);
+    entry = &fn->blocks[fn->entry];
+    for (int i = last + 1; i < entry->count; i++) {
+        *ir_append(fn, body, entry->instrs[i].op) = entry->instrs[i];
+        entry = &fn->blocks[fn->entry];
+    }
+    IRBlock *body_block = &fn->blocks[body];
+    body_block->term = entry->term;
+    body_block->cond = entry->cond;
+    body_block->succ[0] = entry->succ[0];
+    body_block->succ[1] = entry->succ[1];
+    entry->count = last + 1;
+
+    // Cada argumento dentro de su rango; si no, el cuerpo original
+    int previous = fn->entry;
+    for (int p = 0; p < count; p++) {
+        Operand param = ir_var(params[count - 1 - p]);
+        int low = new_block(&tb);
+        int high = new_block(&tb);
+        if (previous == fn->entry) ir_set_goto(fn, previous, low);
+        else ir_set_branch(fn, previous, ir_var(tb.cond), low, body);
+        emit_binary(fn, low, IR_GE, param, ir_int(spec->low[p]), tb.cond);
+        ir_set_branch(fn, low, ir_var(tb.cond), high, body);
+        emit_binary(fn, high, IR_LE, param, ir_int(spec->high[p]), tb.cond);
+        previous = high;
+    }
+
+    int index_block = new_block(&tb);
+    ir_set_branch(fn, previous, ir_var(tb.cond), index_block, body);
+    for (int p = 0; p < count; p++) {
+        Operand param = ir_var(params[count - 1 - p]);
+        if (p == 0) {
+            emit_binary(fn, index_block, IR_SUB, param, ir_int(spec->low[p]), tb.index);
+            continue;
+        }
+        emit_binary(fn, index_block, IR_MUL, ir_var(tb.index), ir_int(spec->high[p] - spec->low[p] + 1), tb.index);
+        emit_binary(fn, index_block, IR_ADD, ir_var(tb.index), param, tb.index);
+        if (spec->low[p] != 0) {
+            emit_binary(fn, index_block, IR_SUB, ir_var(tb.index), ir_int(spec->low[p]), tb.index);
+        }
+    }
+    ir_set_goto(fn, index_block, build_search(&tb, 0, runs - 1));
+
+    // Orden de salida: entrada, tabla, cuerpo original y el resto como estaba
+    int capacity = fn->layout_count + tb.order_count + 2;
+    int *layout = (int*)malloc(capacity * sizeof(int));
+    int n = 0;
+    layout[n++] = fn->entry;
+    for (int i = 0; i < tb.order_count; i++) layout[n++] = tb.order[i];
+    layout[n++] = body;
+    for (int i = 0; i < fn->layout_count; i++) {
+        if (fn->layout[i] != fn->entry) layout[n++] = fn->layout[i];
+    }
+    free(fn->layout);
+    fn->layout = layout;
+    fn->layout_count = n;
+    fn->layout_capacity = capacity;
+
+    // Los temporales nuevos se declaran con los demás
+    for (int b = 0; b < fn->block_count; b++) {
+        IRBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            if (block->instrs[i].op == IR_VAR) block->instrs[i].op = IR_NOP;
+        }
+    }
+    ir_remove_nops(fn);
+    ir_declare_locals(fn);
+
+    int instructions = 0;
+    for (int b = first_block; b < fn->block_count; b++) {
+        if (b != body) instructions += fn->blocks[b].count + 1;
+    }
+    stats->tables++;
+    stats->table_entries += entries;
+    stats->table_instructions += instructions;
+
+    free(tb.order);
+    free(starts);
+    free(values);
+}
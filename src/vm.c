@@ -0,0 +1,1088 @@
+// Máquina virtual de referencia FIS-25
+// Ejecuta el código generado por el compilador (.asm o --emit=bin) sin el
+// simulador gráfico: cuenta instrucciones y ciclos por opcode y por
+// etiqueta, guarda el framebuffer de 64x64 y lee las teclas y entradas de
+// un guion.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "bytecode.h"
+
+#define FB_SIZE 64
+#define CALL_STACK_MAX 4096
+#define PARAM_STACK_MAX 65536
+#define MAX_KEY_EVENTS 256
+#define MAX_INPUTS 256
+#define MAX_OPERANDS 4
+
+typedef enum {
+    OPC_VAR,
+    OPC_ASSIGN,
+    OPC_ADD,
+    OPC_SUB,
+    OPC_MUL,
+    OPC_DIV,
+    OPC_MOD,
+    OPC_EQ,
+    OPC_NEQ,
+    OPC_LT,
+    OPC_GT,
+    OPC_LTE,
+    OPC_GTE,
+    OPC_AND,
+    OPC_OR,
+    OPC_LABEL,
+    OPC_GOTO,
+    OPC_IFFALSE,
+    OPC_GOSUB,
+    OPC_RETURN,
+    OPC_PARAM,
+    OPC_PARAM_GET,
+    OPC_PIXEL,
+    OPC_KEY,
+    OPC_INPUT,
+    OPC_PRINT,
+    OPC_HALT,
+    OPC_COUNT
+} Opcode;
+
+_Static_assert((int)OPC_COUNT == (int)BC_OPCODE_COUNT, "el formato binario usa los mismos opcodes");
+
+static const char *opcode_names[OPC_COUNT] = { BC_OPCODE_NAMES };
+
+static const char *opcode_operands[OPC_COUNT] = { BC_OPCODE_OPERANDS };
+
+// Costo estimado en ciclos de cada opcode
+static const int opcode_cycles[OPC_COUNT] = {
+    1, 1, 1, 1, 3, 10, 10,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    0, 1, 1, 2, 2, 1, 1,
+    4, 2, 2, 4, 0
+};
+
+typedef enum {
+    VAL_INT,
+    VAL_FLOAT,
+    VAL_STRING
+} ValueKind;
+
+typedef struct Value {
+    ValueKind kind;
+    union {
+        int i;
+        double f;
+        const char *s;
+    } as;
+} Value;
+
+typedef enum {
+    OPND_VAR,
+    OPND_CONST,
+    OPND_TARGET
+} OperandKind;
+
+typedef struct Operand {
+    OperandKind kind;
+    int index;      // Variable, o instrucción destino de un salto
+    Value value;    // Constante inmediata
+} Operand;
+
+typedef struct Instr {
+    Opcode op;
+    int line;
+    int label;      // Índice de etiqueta (solo LABEL)
+    Operand args[MAX_OPERANDS];
+} Instr;
+
+typedef struct Variable {
+    char *name;
+    Value value;
+    int declared;
+} Variable;
+
+typedef struct LabelInfo {
+    char *name;
+    int target;
+    long hits;
+} LabelInfo;
+
+// Nombre -> índice en vars o labels, para cargar el texto sin recorrer
+// todas las variables en cada operando. Los nombres son los de Variable y
+// LabelInfo.
+typedef struct NameSlot {
+    const char *name;       // NULL si está vacío
+    int index;
+} NameSlot;
+
+typedef struct NameIndex {
+    NameSlot *slots;
+    int capacity;
+    int count;
+} NameIndex;
+
+typedef struct KeyEvent {
+    int key;
+    long from;
+    long to;
+} KeyEvent;
+
+typedef struct VM {
+    Instr *code;
+    int code_len;
+    int code_cap;
+
+    Variable *vars;
+    int var_count;
+    int var_cap;
+    NameIndex var_index;
+
+    LabelInfo *labels;
+    int label_count;
+    int label_cap;
+    NameIndex label_index;
+
+    int call_stack[CALL_STACK_MAX];
+    int call_depth;
+    Value param_stack[PARAM_STACK_MAX];
+    int param_depth;
+
+    int framebuffer[FB_SIZE][FB_SIZE];
+
+    KeyEvent key_events[MAX_KEY_EVENTS];
+    int key_event_count;
+    long key_reads;
+
+    Value inputs[MAX_INPUTS];
+    int input_count;
+    int next_input;
+
+    long op_counts[OPC_COUNT];
+    long executed;
+    long cycles;
+    long pixels_out_of_range;
+} VM;
+
+static void fatal(const char *message, int line) {
+    if (line > 0) {
+        fprintf(stderr, "Error en la línea %d: %s\n", line, message);
+    } else {
+        fprintf(stderr, "Error: %s\n", message);
+    }
+    exit(1);
+}
+
+static void* xrealloc(void *ptr, size_t size) {
+    void *result = realloc(ptr, size);
+    if (!result) fatal("memoria insuficiente", 0);
+    return result;
+}
+
+// --- Carga del programa ---
+
+static uint32_t hash_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (; *name; name++) hash = (hash ^ (unsigned char)*name) * 16777619u;
+    return hash;
+}
+
+static NameSlot* name_slot(NameIndex *index, const char *name) {
+    int mask = index->capacity - 1;
+    int slot = (int)(hash_name(name) & (uint32_t)mask);
+    while (index->slots[slot].name && strcmp(index->slots[slot].name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &index->slots[slot];
+}
+
+// Casilla del nombre: ocupada si ya está, vacía donde agregarlo si no
+static NameSlot* name_lookup(NameIndex *index, const char *name) {
+    if ((index->count + 1) * 2 > index->capacity) {
+        NameSlot *old_slots = index->slots;
+        int old_capacity = index->capacity;
+        index->capacity = old_capacity ? old_capacity * 2 : 256;
+        index->slots = (NameSlot*)calloc(index->capacity, sizeof(NameSlot));
+        if (!index->slots) fatal("memoria insuficiente", 0);
+        for (int i = 0; i < old_capacity; i++) {
+            if (old_slots[i].name) *name_slot(index, old_slots[i].name) = old_slots[i];
+        }
+        free(old_slots);
+    }
+    return name_slot(index, name);
+}
+
+static int find_or_add_var(VM *vm, const char *name) {
+    NameSlot *slot = name_lookup(&vm->var_index, name);
+    if (slot->name) return slot->index;
+    if (vm->var_count == vm->var_cap) {
+        vm->var_cap = vm->var_cap ? vm->var_cap * 2 : 64;
+        vm->vars = (Variable*)xrealloc(vm->vars, vm->var_cap * sizeof(Variable));
+    }
+    Variable *var = &vm->vars[vm->var_count];
+    var->name = strdup(name);
+    var->value.kind = VAL_INT;
+    var->value.as.i = 0;
+    var->declared = 0;
+    slot->name = var->name;
+    slot->index = vm->var_count;
+    vm->var_index.count++;
+    return vm->var_count++;
+}
+
+static int find_or_add_label(VM *vm, const char *name) {
+    NameSlot *slot = name_lookup(&vm->label_index, name);
+    if (slot->name) return slot->index;
+    if (vm->label_count == vm->label_cap) {
+        vm->label_cap = vm->label_cap ? vm->label_cap * 2 : 64;
+        vm->labels = (LabelInfo*)xrealloc(vm->labels, vm->label_cap * sizeof(LabelInfo));
+    }
+    LabelInfo *label = &vm->labels[vm->label_count];
+    label->name = strdup(name);
+    label->target = -1;
+    label->hits = 0;
+    slot->name = label->name;
+    slot->index = vm->label_count;
+    vm->label_index.count++;
+    return vm->label_count++;
+}
+
+// Separa una línea en palabras; las cadenas entre comillas son una sola palabra
+static int tokenize(char *line, char **tokens, int max_tokens) {
+    int count = 0;
+    char *p = line;
+    while (*p && count < max_tokens) {
+        while (*p && isspace((unsigned char)*p)) p++;
+        if (!*p || *p == ';') break;
+        tokens[count++] = p;
+        if (*p == '"') {
+            p++;
+            while (*p && *p != '"') {
+                if (*p == '\\' && p[1]) p++;
+                p++;
+            }
+            if (*p) p++;
+        } else {
+            while (*p && !isspace((unsigned char)*p)) p++;
+        }
+        if (*p) *p++ = '\0';
+    }
+    return count;
+}
+
+static int is_number(const char *token) {
+    const char *p = token;
+    if (*p == '-') p++;
+    if (!isdigit((unsigned char)*p)) return 0;
+    while (isdigit((unsigned char)*p) || *p == '.') p++;
+    return *p == '\0';
+}
+
+static Operand parse_value(VM *vm, const char *token) {
+    Operand operand;
+    memset(&operand, 0, sizeof(operand));
+    if (token[0] == '"') {
+        size_t len = strlen(token);
+        char *str = strdup(token + 1);
+        if (len >= 2 && token[len - 1] == '"') str[len - 2] = '\0';
+        operand.kind = OPND_CONST;
+        operand.value.kind = VAL_STRING;
+        operand.value.as.s = str;
+    } else if (is_number(token)) {
+        operand.kind = OPND_CONST;
+        if (strchr(token, '.')) {
+            operand.value.kind = VAL_FLOAT;
+            operand.value.as.f = atof(token);
+        } else {
+            operand.value.kind = VAL_INT;
+            operand.value.as.i = atoi(token);
+        }
+    } else {
+        operand.kind = OPND_VAR;
+        operand.index = find_or_add_var(vm, token);
+    }
+    return operand;
+}
+
+static Operand parse_target(VM *vm, const char *token) {
+    Operand operand;
+    memset(&operand, 0, sizeof(operand));
+    operand.kind = OPND_TARGET;
+    operand.index = find_or_add_label(vm, token);
+    return operand;
+}
+
+static Opcode parse_opcode(const char *token, int line) {
+    for (int op = 0; op < OPC_COUNT; op++) {
+        if (strcmp(opcode_names[op], token) == 0) return (Opcode)op;
+    }
+    char message[128];
+    snprintf(message, sizeof(message), "instrucción desconocida '%s'", token);
+    fatal(message, line);
+    return OPC_HALT;
+}
+
+static void expect_args(int count, int expected, int line) {
+    if (count != expected) fatal("número de operandos incorrecto", line);
+}
+
+static void parse_line(VM *vm, char *text, int line) {
+    char *tokens[8];
+    int count = tokenize(text, tokens, 8);
+    if (count == 0) return;
+
+    Instr instr;
+    memset(&instr, 0, sizeof(instr));
+    instr.op = parse_opcode(tokens[0], line);
+    instr.line = line;
+    instr.label = -1;
+    int nargs = count - 1;
+
+    switch (instr.op) {
+        case OPC_VAR:
+        case OPC_PARAM_GET:
+        case OPC_INPUT:
+            expect_args(nargs, 1, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            if (instr.args[0].kind != OPND_VAR) fatal("se esperaba una variable", line);
+            break;
+        case OPC_ASSIGN:
+            expect_args(nargs, 2, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            instr.args[1] = parse_value(vm, tokens[2]);
+            if (instr.args[1].kind != OPND_VAR) fatal("se esperaba una variable", line);
+            break;
+        case OPC_ADD: case OPC_SUB: case OPC_MUL: case OPC_DIV: case OPC_MOD:
+        case OPC_EQ: case OPC_NEQ: case OPC_LT: case OPC_GT: case OPC_LTE: case OPC_GTE:
+        case OPC_AND: case OPC_OR:
+            expect_args(nargs, 3, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            instr.args[1] = parse_value(vm, tokens[2]);
+            instr.args[2] = parse_value(vm, tokens[3]);
+            if (instr.args[2].kind != OPND_VAR) fatal("se esperaba una variable", line);
+            break;
+        case OPC_LABEL: {
+            expect_args(nargs, 1, line);
+            int label = find_or_add_label(vm, tokens[1]);
+            if (vm->labels[label].target >= 0) fatal("etiqueta duplicada", line);
+            vm->labels[label].target = vm->code_len;
+            instr.label = label;
+            break;
+        }
+        case OPC_GOTO:
+        case OPC_GOSUB:
+            expect_args(nargs, 1, line);
+            instr.args[0] = parse_target(vm, tokens[1]);
+            break;
+        case OPC_IFFALSE:
+            expect_args(nargs, 3, line);
+            if (strcmp(tokens[2], "GOTO") != 0) fatal("se esperaba IFFALSE x GOTO etiqueta", line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            instr.args[1] = parse_target(vm, tokens[3]);
+            break;
+        case OPC_RETURN:
+        case OPC_HALT:
+            expect_args(nargs, 0, line);
+            break;
+        case OPC_PARAM:
+        case OPC_PRINT:
+            expect_args(nargs, 1, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            break;
+        case OPC_PIXEL:
+            expect_args(nargs, 3, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            instr.args[1] = parse_value(vm, tokens[2]);
+            instr.args[2] = parse_value(vm, tokens[3]);
+            break;
+        case OPC_KEY:
+            expect_args(nargs, 2, line);
+            instr.args[0] = parse_value(vm, tokens[1]);
+            instr.args[1] = parse_value(vm, tokens[2]);
+            if (instr.args[1].kind != OPND_VAR) fatal("se esperaba una variable", line);
+            break;
+        default:
+            break;
+    }
+
+    if (vm->code_len == vm->code_cap) {
+        vm->code_cap = vm->code_cap ? vm->code_cap * 2 : 256;
+        vm->code = (Instr*)xrealloc(vm->code, vm->code_cap * sizeof(Instr));
+    }
+    vm->code[vm->code_len++] = instr;
+}
+
+// Resuelve los saltos a etiquetas del texto
+static void link_labels(VM *vm) {
+    for (int i = 0; i < vm->label_count; i++) {
+        if (vm->labels[i].target < 0) {
+            fprintf(stderr, "Error: etiqueta '%s' no definida\n", vm->labels[i].name);
+            exit(1);
+        }
+    }
+
+    for (int pc = 0; pc < vm->code_len; pc++) {
+        Instr *instr = &vm->code[pc];
+        for (int a = 0; a < MAX_OPERANDS; a++) {
+            if (instr->args[a].kind == OPND_TARGET) {
+                instr->args[a].index = vm->labels[instr->args[a].index].target;
+            }
+        }
+    }
+}
+
+// Convierte el bucle final 'LABEL L / GOTO L' en HALT
+static void mark_halts(VM *vm) {
+    for (int pc = 0; pc < vm->code_len; pc++) {
+        Instr *instr = &vm->code[pc];
+        if (instr->op == OPC_GOTO) {
+            int target = instr->args[0].index;
+            int only_labels = target <= pc;
+            for (int j = target; j < pc && only_labels; j++) {
+                only_labels = vm->code[j].op == OPC_LABEL;
+            }
+            if (only_labels) instr->op = OPC_HALT;
+        }
+    }
+}
+
+static char* read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: No se puede abrir el archivo %s\n", path);
+        exit(1);
+    }
+
+    // Sin fseek/ftell para que también se pueda leer de una tubería
+    size_t capacity = 1 << 16;
+    size_t length = 0;
+    char *data = (char*)xrealloc(NULL, capacity + 1);
+    size_t read;
+    while ((read = fread(data + length, 1, capacity - length, file)) > 0) {
+        length += read;
+        if (length == capacity) {
+            capacity *= 2;
+            data = (char*)xrealloc(data, capacity + 1);
+        }
+    }
+    if (ferror(file)) {
+        fprintf(stderr, "Error: No se puede leer el archivo %s\n", path);
+        exit(1);
+    }
+    fclose(file);
+    data[length] = '\0';
+    *size = length;
+    return data;
+}
+
+static void load_text(VM *vm, char *text) {
+    int line = 0;
+    while (*text) {
+        char *eol = strchr(text, '\n');
+        if (eol) *eol = '\0';
+        line++;
+        parse_line(vm, text, line);
+        if (!eol) break;
+        text = eol + 1;
+    }
+
+    link_labels(vm);
+}
+
+static uint64_t get_uint(const unsigned char *p, int width) {
+    uint64_t value = 0;
+    for (int i = width - 1; i >= 0; i--) value = value << 8 | p[i];
+    return value;
+}
+
+static void invalid_binary(void) {
+    fatal("archivo binario inválido", 0);
+}
+
+// Siguiente nombre del conjunto de nombres, que termina en '\0'
+static char* next_name(char **names, const char *end) {
+    char *name = *names;
+    char *nul = name < end ? memchr(name, '\0', (size_t)(end - name)) : NULL;
+    if (!nul) invalid_binary();
+    *names = nul + 1;
+    return name;
+}
+
+// Formato binario (bytecode.h). Los nombres y las cadenas apuntan al
+// archivo, que queda en memoria. Las instrucciones no tienen línea: los
+// errores de ejecución dan su número, que es la línea de fis25vm --disasm.
+static void load_binary(VM *vm, char *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    if (size < BC_HEADER_SIZE || get_uint(bytes + 4, 4) != BC_VERSION) invalid_binary();
+    uint64_t code_len = get_uint(bytes + 8, 4);
+    uint64_t var_count = get_uint(bytes + 12, 4);
+    uint64_t constant_count = get_uint(bytes + 16, 4);
+    uint64_t label_count = get_uint(bytes + 20, 4);
+    uint64_t code_size = get_uint(bytes + 24, 4);
+    uint64_t names_size = get_uint(bytes + 28, 4);
+    int widths[128] = { 0 };
+    widths['v'] = widths['x'] = bytes[32];
+    widths['t'] = bytes[33];
+    widths['l'] = bytes[34];
+    if (code_len > BC_MAX_INDEX || var_count + constant_count > BC_MAX_INDEX ||
+        label_count > BC_MAX_INDEX || bytes[35] != 0) {
+        invalid_binary();
+    }
+    for (int w = 32; w < 35; w++) {
+        if (bytes[w] < 1 || bytes[w] > 4) invalid_binary();
+    }
+    // Cada instrucción ocupa al menos un byte y cada nombre al menos uno
+    if (BC_HEADER_SIZE + constant_count * BC_CONSTANT_SIZE + code_size + names_size != size ||
+        code_len > code_size || var_count + label_count > names_size) {
+        invalid_binary();
+    }
+    const unsigned char *constants = bytes + BC_HEADER_SIZE;
+    const unsigned char *code = constants + constant_count * BC_CONSTANT_SIZE;
+    const unsigned char *code_end = code + code_size;
+    char *names = data + (size - names_size);
+    char *names_end = data + size;
+
+    vm->var_count = vm->var_cap = (int)var_count;
+    vm->vars = (Variable*)xrealloc(NULL, (var_count + 1) * sizeof(Variable));
+    for (int v = 0; v < vm->var_count; v++) {
+        Variable *var = &vm->vars[v];
+        var->name = next_name(&names, names_end);
+        var->value.kind = VAL_INT;
+        var->value.as.i = 0;
+        var->declared = 0;
+    }
+
+    vm->label_count = vm->label_cap = (int)label_count;
+    vm->labels = (LabelInfo*)xrealloc(NULL, (label_count + 1) * sizeof(LabelInfo));
+    for (int l = 0; l < vm->label_count; l++) {
+        LabelInfo *label = &vm->labels[l];
+        label->name = next_name(&names, names_end);
+        label->target = -1;
+        label->hits = 0;
+    }
+
+    Value *values = (Value*)xrealloc(NULL, (constant_count + 1) * sizeof(Value));
+    for (uint64_t k = 0; k < constant_count; k++) {
+        const unsigned char *constant = constants + k * BC_CONSTANT_SIZE;
+        uint64_t bits = get_uint(constant + 1, 8);
+        switch (constant[0]) {
+            case BC_CONST_INT:
+                values[k].kind = VAL_INT;
+                values[k].as.i = (int)(int64_t)bits;
+                break;
+            case BC_CONST_FLOAT:
+                values[k].kind = VAL_FLOAT;
+                memcpy(&values[k].as.f, &bits, sizeof(double));
+                break;
+            case BC_CONST_STRING: {
+                if (bits >= names_size) invalid_binary();
+                char *string = data + (size - names_size) + bits;
+                values[k].kind = VAL_STRING;
+                values[k].as.s = next_name(&string, names_end);
+                break;
+            }
+            default:
+                invalid_binary();
+        }
+    }
+
+    vm->code_len = vm->code_cap = (int)code_len;
+    vm->code = (Instr*)xrealloc(NULL, (code_len + 1) * sizeof(Instr));
+    const unsigned char *p = code;
+    for (int pc = 0; pc < vm->code_len; pc++) {
+        Instr *instr = &vm->code[pc];
+        memset(instr, 0, sizeof(*instr));
+        if (p == code_end || *p >= OPC_COUNT) invalid_binary();
+        instr->op = (Opcode)*p++;
+        instr->line = pc + 1;
+        instr->label = -1;
+
+        const char *kinds = opcode_operands[instr->op];
+        for (int a = 0; kinds[a]; a++) {
+            int width = widths[(unsigned char)kinds[a]];
+            if (code_end - p < width) invalid_binary();
+            uint64_t value = get_uint(p, width);
+            p += width;
+            Operand *operand = &instr->args[a];
+            switch (kinds[a]) {
+                case 'v':
+                    if (value >= var_count) invalid_binary();
+                    operand->kind = OPND_VAR;
+                    operand->index = (int)value;
+                    break;
+                case 'x':
+                    if (value >= var_count + constant_count) invalid_binary();
+                    if (value < var_count) {
+                        operand->kind = OPND_VAR;
+                        operand->index = (int)value;
+                    } else {
+                        operand->kind = OPND_CONST;
+                        operand->value = values[value - var_count];
+                    }
+                    break;
+                case 't':
+                    if (value >= code_len) invalid_binary();
+                    operand->kind = OPND_TARGET;
+                    operand->index = (int)value;
+                    break;
+                default:
+                    // La etiqueta se define aquí, una sola vez
+                    if (value >= label_count || vm->labels[value].target >= 0) invalid_binary();
+                    vm->labels[value].target = pc;
+                    instr->label = (int)value;
+                    break;
+            }
+        }
+    }
+    free(values);
+    if (p != code_end) invalid_binary();
+
+    // Todas las etiquetas están definidas y los saltos van a una
+    // instrucción LABEL, como en el texto
+    for (int l = 0; l < vm->label_count; l++) {
+        if (vm->labels[l].target < 0) invalid_binary();
+    }
+    for (int pc = 0; pc < vm->code_len; pc++) {
+        for (int a = 0; a < MAX_OPERANDS; a++) {
+            const Operand *operand = &vm->code[pc].args[a];
+            if (operand->kind == OPND_TARGET && vm->code[operand->index].op != OPC_LABEL) invalid_binary();
+        }
+    }
+}
+
+static void load_program(VM *vm, const char *path) {
+    size_t size;
+    char *data = read_file(path, &size);
+    if (size >= 4 && memcmp(data, BC_MAGIC, 4) == 0) {
+        load_binary(vm, data, size);
+    } else {
+        load_text(vm, data);
+        free(data);
+    }
+}
+
+// Escribe el programa cargado en la sintaxis de texto, una instrucción por
+// línea (sin comentarios ni líneas en blanco)
+static void disassemble(VM *vm, FILE *out) {
+    for (int pc = 0; pc < vm->code_len; pc++) {
+        const Instr *instr = &vm->code[pc];
+        const char *kinds = opcode_operands[instr->op];
+        fputs(opcode_names[instr->op], out);
+        for (int a = 0; kinds[a]; a++) {
+            const Operand *operand = &instr->args[a];
+            if (kinds[a] == 'l') {
+                fprintf(out, " %s", vm->labels[instr->label].name);
+            } else if (kinds[a] == 't') {
+                if (instr->op == OPC_IFFALSE) fputs(" GOTO", out);
+                fprintf(out, " %s", vm->labels[vm->code[operand->index].label].name);
+            } else if (operand->kind == OPND_VAR) {
+                fprintf(out, " %s", vm->vars[operand->index].name);
+            } else {
+                switch (operand->value.kind) {
+                    case VAL_INT: fprintf(out, " %d", operand->value.as.i); break;
+                    case VAL_FLOAT: fprintf(out, " %f", operand->value.as.f); break;
+                    case VAL_STRING: fprintf(out, " \"%s\"", operand->value.as.s); break;
+                }
+            }
+        }
+        fputc('\n', out);
+    }
+}
+
+// --- Ejecución ---
+
+static Value* var_ref(VM *vm, const Instr *instr, int index) {
+    Variable *var = &vm->vars[index];
+    if (!var->declared) {
+        char message[256];
+        snprintf(message, sizeof(message), "variable '%s' usada sin VAR", var->name);
+        fatal(message, instr->line);
+    }
+    return &var->value;
+}
+
+static Value read_operand(VM *vm, const Instr *instr, int a) {
+    const Operand *operand = &instr->args[a];
+    if (operand->kind == OPND_CONST) return operand->value;
+    return *var_ref(vm, instr, operand->index);
+}
+
+static void write_operand(VM *vm, const Instr *instr, int a, Value value) {
+    *var_ref(vm, instr, instr->args[a].index) = value;
+}
+
+static double as_float(Value value) {
+    return value.kind == VAL_FLOAT ? value.as.f : (double)value.as.i;
+}
+
+static int as_int(const Instr *instr, Value value) {
+    if (value.kind == VAL_STRING) fatal("se esperaba un número", instr->line);
+    return value.kind == VAL_FLOAT ? (int)value.as.f : value.as.i;
+}
+
+static int is_true(Value value) {
+    if (value.kind == VAL_FLOAT) return value.as.f != 0.0;
+    if (value.kind == VAL_STRING) return value.as.s[0] != '\0';
+    return value.as.i != 0;
+}
+
+static Value make_int(int i) {
+    Value value;
+    value.kind = VAL_INT;
+    value.as.i = i;
+    return value;
+}
+
+static Value make_float(double f) {
+    Value value;
+    value.kind = VAL_FLOAT;
+    value.as.f = f;
+    return value;
+}
+
+static Value arithmetic(const Instr *instr, Value a, Value b) {
+    if (a.kind == VAL_STRING || b.kind == VAL_STRING) {
+        fatal("operación aritmética sobre una cadena", instr->line);
+    }
+    if (a.kind == VAL_FLOAT || b.kind == VAL_FLOAT) {
+        double x = as_float(a), y = as_float(b);
+        switch (instr->op) {
+            case OPC_ADD: return make_float(x + y);
+            case OPC_SUB: return make_float(x - y);
+            case OPC_MUL: return make_float(x * y);
+            case OPC_DIV:
+                if (y == 0.0) fatal("división entre cero", instr->line);
+                return make_float(x / y);
+            default:
+                fatal("MOD requiere operandos enteros", instr->line);
+        }
+    }
+
+    int x = a.as.i, y = b.as.i;
+    switch (instr->op) {
+        case OPC_ADD: return make_int((int)((unsigned)x + (unsigned)y));
+        case OPC_SUB: return make_int((int)((unsigned)x - (unsigned)y));
+        case OPC_MUL: return make_int((int)((unsigned)x * (unsigned)y));
+        case OPC_DIV:
+            if (y == 0) fatal("división entre cero", instr->line);
+            return make_int(y == -1 ? (int)(0u - (unsigned)x) : x / y);
+        case OPC_MOD:
+            if (y == 0) fatal("división entre cero", instr->line);
+            return make_int(y == -1 ? 0 : x % y);
+        default:
+            return make_int(0);
+    }
+}
+
+static Value compare(const Instr *instr, Value a, Value b) {
+    int result;
+    if (a.kind == VAL_STRING || b.kind == VAL_STRING) {
+        if (a.kind != b.kind) fatal("comparación entre cadena y número", instr->line);
+        int cmp = strcmp(a.as.s, b.as.s);
+        switch (instr->op) {
+            case OPC_EQ: result = cmp == 0; break;
+            case OPC_NEQ: result = cmp != 0; break;
+            default: fatal("comparación relacional sobre cadenas", instr->line); return a;
+        }
+        return make_int(result);
+    }
+
+    double x = as_float(a), y = as_float(b);
+    switch (instr->op) {
+        case OPC_EQ: result = x == y; break;
+        case OPC_NEQ: result = x != y; break;
+        case OPC_LT: result = x < y; break;
+        case OPC_GT: result = x > y; break;
+        case OPC_LTE: result = x <= y; break;
+        case OPC_GTE: result = x >= y; break;
+        default: result = 0; break;
+    }
+    return make_int(result);
+}
+
+static int key_pressed(VM *vm, int key) {
+    for (int i = 0; i < vm->key_event_count; i++) {
+        KeyEvent *event = &vm->key_events[i];
+        if (event->key == key && vm->key_reads >= event->from &&
+            (event->to < 0 || vm->key_reads < event->to)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void print_value(Value value) {
+    switch (value.kind) {
+        case VAL_INT: printf("%d\n", value.as.i); break;
+        case VAL_FLOAT: printf("%f\n", value.as.f); break;
+        case VAL_STRING: printf("%s\n", value.as.s); break;
+    }
+}
+
+// Devuelve 0 si el programa terminó, 1 si se agotó el límite de pasos
+static int run(VM *vm, long max_steps) {
+    int pc = 0;
+
+    while (pc < vm->code_len) {
+        const Instr *instr = &vm->code[pc];
+        int next = pc + 1;
+
+        if (instr->op == OPC_HALT) break;
+        if (max_steps >= 0 && vm->executed >= max_steps) return 1;
+
+        vm->op_counts[instr->op]++;
+        vm->cycles += opcode_cycles[instr->op];
+        if (instr->op != OPC_LABEL) vm->executed++;
+
+        switch (instr->op) {
+            case OPC_VAR:
+                vm->vars[instr->args[0].index].declared = 1;
+                break;
+            case OPC_ASSIGN:
+                write_operand(vm, instr, 1, read_operand(vm, instr, 0));
+                break;
+            case OPC_ADD: case OPC_SUB: case OPC_MUL: case OPC_DIV: case OPC_MOD:
+                write_operand(vm, instr, 2, arithmetic(instr,
+                              read_operand(vm, instr, 0), read_operand(vm, instr, 1)));
+                break;
+            case OPC_EQ: case OPC_NEQ: case OPC_LT: case OPC_GT: case OPC_LTE: case OPC_GTE:
+                write_operand(vm, instr, 2, compare(instr,
+                              read_operand(vm, instr, 0), read_operand(vm, instr, 1)));
+                break;
+            case OPC_AND:
+                write_operand(vm, instr, 2, make_int(is_true(read_operand(vm, instr, 0)) &&
+                                                      is_true(read_operand(vm, instr, 1))));
+                break;
+            case OPC_OR:
+                write_operand(vm, instr, 2, make_int(is_true(read_operand(vm, instr, 0)) ||
+                                                      is_true(read_operand(vm, instr, 1))));
+                break;
+            case OPC_LABEL:
+                vm->labels[instr->label].hits++;
+                break;
+            case OPC_GOTO:
+                next = instr->args[0].index;
+                break;
+            case OPC_IFFALSE:
+                if (!is_true(read_operand(vm, instr, 0))) next = instr->args[1].index;
+                break;
+            case OPC_GOSUB:
+                if (vm->call_depth == CALL_STACK_MAX) fatal("desbordamiento de la pila de llamadas", instr->line);
+                vm->call_stack[vm->call_depth++] = next;
+                next = instr->args[0].index;
+                break;
+            case OPC_RETURN:
+                if (vm->call_depth == 0) return 0;
+                next = vm->call_stack[--vm->call_depth];
+                break;
+            case OPC_PARAM:
+                if (vm->param_depth == PARAM_STACK_MAX) fatal("desbordamiento de la pila de parámetros", instr->line);
+                vm->param_stack[vm->param_depth++] = read_operand(vm, instr, 0);
+                break;
+            case OPC_PARAM_GET:
+                if (vm->param_depth == 0) fatal("PARAM_GET sin parámetros en la pila", instr->line);
+                write_operand(vm, instr, 0, vm->param_stack[--vm->param_depth]);
+                break;
+            case OPC_PIXEL: {
+                int x = as_int(instr, read_operand(vm, instr, 0));
+                int y = as_int(instr, read_operand(vm, instr, 1));
+                int color = as_int(instr, read_operand(vm, instr, 2));
+                if (x >= 0 && x < FB_SIZE && y >= 0 && y < FB_SIZE) {
+                    vm->framebuffer[y][x] = color;
+                } else {
+                    vm->pixels_out_of_range++;
+                }
+                break;
+            }
+            case OPC_KEY: {
+                int key = as_int(instr, read_operand(vm, instr, 0));
+                write_operand(vm, instr, 1, make_int(key_pressed(vm, key)));
+                vm->key_reads++;
+                break;
+            }
+            case OPC_INPUT: {
+                Value value = make_int(0);
+                if (vm->next_input < vm->input_count) value = vm->inputs[vm->next_input++];
+                write_operand(vm, instr, 0, value);
+                break;
+            }
+            case OPC_PRINT:
+                print_value(read_operand(vm, instr, 0));
+                break;
+            default:
+                break;
+        }
+
+        pc = next;
+    }
+    return 0;
+}
+
+// --- Salida ---
+
+static int compare_labels(const void *a, const void *b) {
+    const LabelInfo *x = (const LabelInfo*)a;
+    const LabelInfo *y = (const LabelInfo*)b;
+    if (x->hits != y->hits) return x->hits < y->hits ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+static void print_stats(VM *vm, FILE *out) {
+    fprintf(out, "--- Estadísticas de ejecución ---\n");
+    fprintf(out, "Instrucciones ejecutadas: %ld\n", vm->executed);
+    fprintf(out, "Ciclos estimados: %ld\n", vm->cycles);
+    fprintf(out, "Instrucciones en el programa: %d, variables: %d\n", vm->code_len, vm->var_count);
+    if (vm->pixels_out_of_range) {
+        fprintf(out, "Píxeles fuera de la pantalla: %ld\n", vm->pixels_out_of_range);
+    }
+
+    fprintf(out, "Por opcode:\n");
+    for (int op = 0; op < OPC_COUNT; op++) {
+        if (vm->op_counts[op] && op != OPC_LABEL) {
+            fprintf(out, "  %-10s %12ld\n", opcode_names[op], vm->op_counts[op]);
+        }
+    }
+
+    fprintf(out, "Por etiqueta:\n");
+    LabelInfo *sorted = (LabelInfo*)xrealloc(NULL, (vm->label_count + 1) * sizeof(LabelInfo));
+    memcpy(sorted, vm->labels, vm->label_count * sizeof(LabelInfo));
+    qsort(sorted, vm->label_count, sizeof(LabelInfo), compare_labels);
+    for (int i = 0; i < vm->label_count; i++) {
+        if (sorted[i].hits) fprintf(out, "  %-20s %12ld\n", sorted[i].name, sorted[i].hits);
+    }
+    free(sorted);
+}
+
+// Framebuffer en formato PGM de texto (P2)
+static void dump_framebuffer(VM *vm, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: No se puede crear el archivo %s\n", path);
+        exit(1);
+    }
+    int max_color = 1;
+    for (int y = 0; y < FB_SIZE; y++) {
+        for (int x = 0; x < FB_SIZE; x++) {
+            if (vm->framebuffer[y][x] > max_color) max_color = vm->framebuffer[y][x];
+        }
+    }
+    fprintf(file, "P2\n%d %d\n%d\n", FB_SIZE, FB_SIZE, max_color);
+    for (int y = 0; y < FB_SIZE; y++) {
+        for (int x = 0; x < FB_SIZE; x++) {
+            int color = vm->framebuffer[y][x];
+            fprintf(file, "%d%c", color < 0 ? 0 : color, x == FB_SIZE - 1 ? '\n' : ' ');
+        }
+    }
+    fclose(file);
+}
+
+// --- Guion de entrada ---
+
+// Formato: TECLA:DESDE[:HASTA], contado en lecturas KEY ejecutadas
+static void add_key_event(VM *vm, const char *spec) {
+    if (vm->key_event_count == MAX_KEY_EVENTS) fatal("demasiados eventos de teclado", 0);
+    KeyEvent *event = &vm->key_events[vm->key_event_count];
+    event->to = -1;
+    if (sscanf(spec, "%d:%ld:%ld", &event->key, &event->from, &event->to) < 2) {
+        fprintf(stderr, "Error: evento de teclado inválido '%s' (TECLA:DESDE[:HASTA])\n", spec);
+        exit(1);
+    }
+    vm->key_event_count++;
+}
+
+static void load_key_script(VM *vm, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: No se puede abrir el archivo %s\n", path);
+        exit(1);
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+        add_key_event(vm, p);
+    }
+    fclose(file);
+}
+
+static void add_input(VM *vm, const char *text) {
+    if (vm->input_count == MAX_INPUTS) fatal("demasiados valores de entrada", 0);
+    Value *value = &vm->inputs[vm->input_count++];
+    if (strchr(text, '.')) {
+        *value = make_float(atof(text));
+    } else {
+        *value = make_int(atoi(text));
+    }
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Uso: %s [opciones] <programa.asm|programa.bin>\n", program);
+    fprintf(stderr, "  --stats              Conteo de instrucciones y ciclos por opcode y etiqueta\n");
+    fprintf(stderr, "  --max-steps N        Detiene la ejecución tras N instrucciones\n");
+    fprintf(stderr, "  --key K:DESDE[:HASTA] Mantiene la tecla K presionada entre esas lecturas KEY\n");
+    fprintf(stderr, "  --keys ARCHIVO       Lee eventos de teclado (uno por línea)\n");
+    fprintf(stderr, "  --input V            Valor para la siguiente instrucción INPUT\n");
+    fprintf(stderr, "  --fb ARCHIVO         Guarda el framebuffer final en formato PGM\n");
+    fprintf(stderr, "  --disasm             Escribe el programa en texto FIS-25 y termina sin ejecutarlo\n");
+}
+
+int main(int argc, char **argv) {
+    static VM vm;
+    int show_stats = 0;
+    int disasm = 0;
+    long max_steps = -1;
+    const char *fb_path = NULL;
+    const char *program_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        int has_value = i + 1 < argc;
+        if (strcmp(arg, "--stats") == 0) {
+            show_stats = 1;
+        } else if (strcmp(arg, "--max-steps") == 0 && has_value) {
+            max_steps = atol(argv[++i]);
+        } else if (strcmp(arg, "--key") == 0 && has_value) {
+            add_key_event(&vm, argv[++i]);
+        } else if (strcmp(arg, "--keys") == 0 && has_value) {
+            load_key_script(&vm, argv[++i]);
+        } else if (strcmp(arg, "--input") == 0 && has_value) {
+            add_input(&vm, argv[++i]);
+        } else if (strcmp(arg, "--fb") == 0 && has_value) {
+            fb_path = argv[++i];
+        } else if (strcmp(arg, "--disasm") == 0) {
+            disasm = 1;
+        } else if (arg[0] != '-' && !program_path) {
+            program_path = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!program_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    load_program(&vm, program_path);
+    if (disasm) {
+        disassemble(&vm, stdout);
+        return 0;
+    }
+    mark_halts(&vm);
+    int truncated = run(&vm, max_steps);
+
+    if (truncated) {
+        fprintf(stderr, "Aviso: ejecución detenida tras %ld instrucciones\n", vm.executed);
+    }
+    if (fb_path) {
+        dump_framebuffer(&vm, fb_path);
+    }
+    if (show_stats) {
+        print_stats(&vm, stderr);
+    }
+
+    return truncated ? 2 : 0;
+}